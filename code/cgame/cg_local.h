@@ -809,6 +809,12 @@ typedef struct {
 	int			teamScores[2];
 	score_t		scores[MAX_CLIENTS];
 	clientList_t	readyPlayers;
+
+	// scoreboard as received, cg.scores is built from it
+	int			scoreVersion;		// of the last "dscores", 0 asks for a full update
+	int			scoreOrder[MAX_CLIENTS];
+	int			numScoreOrder;
+	int			scoreFields[MAX_CLIENTS][SCORE_NUM_FIELDS];
 #ifdef MISSIONPACK_HUD
 	char			spectatorList[MAX_STRING_CHARS];		// list of names
 	int				spectatorTime;							// last time offset
@@ -1735,6 +1741,7 @@ void CG_PlayerColorFromIndex( int val, vec3_t color );
 //
 // cg_predict.c
 //
+void CG_ClearTriggerGrid( void );
 void CG_BuildSolidList( void );
 int	CG_PointContents( const vec3_t point, int passEntityNum );
 void CG_Trace( trace_t *result, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, 
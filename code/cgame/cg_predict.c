@@ -41,6 +41,59 @@ static	int			cg_numSolidEntities;
 static	centity_t	*cg_solidEntities[MAX_ENTITIES_IN_SNAPSHOT+MAX_SPLITVIEW];
 static	int			cg_numTriggerEntities;
 static	centity_t	*cg_triggerEntities[MAX_ENTITIES_IN_SNAPSHOT];
+static	bgTriggerGrid_t	cg_triggerGrid;
+
+/*
+====================
+CG_ClearTriggerGrid
+====================
+*/
+void CG_ClearTriggerGrid( void ) {
+	BG_TriggerGridClear( &cg_triggerGrid );
+	cg_numTriggerEntities = 0;
+}
+
+/*
+====================
+CG_TriggerBounds
+
+Items get the player origins that can pick them up, moving
+triggers are checked by every query
+====================
+*/
+static void CG_TriggerBounds( const entityState_t *ent, vec3_t mins, vec3_t maxs ) {
+	if ( ent->pos.trType != TR_STATIONARY || ( ent->eType != ET_ITEM && !VectorCompare( ent->apos.trBase, vec3_origin ) ) ) {
+		VectorSet( mins, -MAX_MAP_SIZE, -MAX_MAP_SIZE, -MAX_MAP_SIZE );
+		VectorSet( maxs, MAX_MAP_SIZE, MAX_MAP_SIZE, MAX_MAP_SIZE );
+	} else if ( ent->eType == ET_ITEM ) {
+		BG_ItemTouchBounds( ent->pos.trBase, mins, maxs );
+	} else {
+		VectorAdd( ent->pos.trBase, ent->mins, mins );
+		VectorAdd( ent->pos.trBase, ent->maxs, maxs );
+	}
+}
+
+/*
+====================
+CG_LinkTrigger
+
+CG_TouchTriggerPrediction tests currentState, which can still be
+behind the snapshot the list is built from, so link both
+====================
+*/
+static void CG_LinkTrigger( centity_t *cent, const entityState_t *ent ) {
+	vec3_t		mins, maxs;
+	vec3_t		mins2, maxs2;
+
+	CG_TriggerBounds( ent, mins, maxs );
+	if ( cent->currentState.number == ent->number ) {
+		CG_TriggerBounds( &cent->currentState, mins2, maxs2 );
+		AddPointToBounds( mins2, mins, maxs );
+		AddPointToBounds( maxs2, mins, maxs );
+	}
+
+	BG_TriggerGridLink( &cg_triggerGrid, ent->number, mins, maxs );
+}
 
 /*
 ====================
@@ -58,6 +111,10 @@ void CG_BuildSolidList( void ) {
 	entityState_t	*ent;
 	playerState_t	*ps;
 
+	for ( i = 0 ; i < cg_numTriggerEntities ; i++ ) {
+		BG_TriggerGridUnlink( &cg_triggerGrid, cg_triggerEntities[i] - cg_entities );
+	}
+
 	cg_numSolidEntities = 0;
 	cg_numTriggerEntities = 0;
 
@@ -74,6 +131,7 @@ void CG_BuildSolidList( void ) {
 		if ( ent->eType == ET_ITEM || ent->eType == ET_PUSH_TRIGGER || ent->eType == ET_TELEPORT_TRIGGER ) {
 			cg_triggerEntities[cg_numTriggerEntities] = cent;
 			cg_numTriggerEntities++;
+			CG_LinkTrigger( cent, ent );
 			continue;
 		}
 
@@ -411,7 +469,9 @@ Predict push triggers and items
 =========================
 */
 static void CG_TouchTriggerPrediction( void ) {
-	int			i;
+	int			i, num;
+	int			touch[MAX_ENTITIES_IN_SNAPSHOT];
+	vec3_t		mins, maxs;
 	trace_t		trace;
 	entityState_t	*ent;
 	clipHandle_t cmodel;
@@ -429,8 +489,13 @@ static void CG_TouchTriggerPrediction( void ) {
 		return;
 	}
 
-	for ( i = 0 ; i < cg_numTriggerEntities ; i++ ) {
-		cent = cg_triggerEntities[ i ];
+	VectorAdd( cg.cur_lc->predictedPlayerState.origin, cg.cur_lc->predictedPlayerState.mins, mins );
+	VectorAdd( cg.cur_lc->predictedPlayerState.origin, cg.cur_lc->predictedPlayerState.maxs, maxs );
+
+	num = BG_TriggerGridQuery( &cg_triggerGrid, mins, maxs, touch, MAX_ENTITIES_IN_SNAPSHOT );
+
+	for ( i = 0 ; i < num ; i++ ) {
+		cent = &cg_entities[ touch[i] ];
 		ent = &cent->currentState;
 
 		if ( ent->eType == ET_ITEM && !spectator ) {
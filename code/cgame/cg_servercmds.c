@@ -68,12 +68,14 @@ static int CG_ValidOrder(const char *p) {
 
 /*
 =================
-CG_ParseScores
+CG_SetScores
 
+Builds cg.scores from the received scoreboard
 =================
 */
-static void CG_ParseScores( int start ) {
-	int		i, powerups;
+static void CG_SetScores( void ) {
+	int		i, playerNum;
+	int		*fields;
 #ifdef MISSIONPACK_HUD
 	int		j, selectedPlayerNum[MAX_SPLITVIEW];
 
@@ -87,39 +89,31 @@ static void CG_ParseScores( int start ) {
 	}
 #endif
 
-	cg.numScores = atoi( CG_Argv( 1 + start) );
-	if ( cg.numScores > MAX_CLIENTS ) {
-		cg.numScores = MAX_CLIENTS;
-	}
-
-	cg.teamScores[0] = atoi( CG_Argv( 2 + start) );
-	cg.teamScores[1] = atoi( CG_Argv( 3 + start) );
+	cg.numScores = cg.numScoreOrder;
 
 	memset( cg.scores, 0, sizeof( cg.scores ) );
 	for ( i = 0 ; i < cg.numScores ; i++ ) {
-		//
-		cg.scores[i].playerNum = atoi( CG_Argv( i * 14 + 4 + start) );
-		cg.scores[i].score = atoi( CG_Argv( i * 14 + 5 + start) );
-		cg.scores[i].ping = atoi( CG_Argv( i * 14 + 6 + start) );
-		cg.scores[i].time = atoi( CG_Argv( i * 14 + 7 + start) );
-		cg.scores[i].scoreFlags = atoi( CG_Argv( i * 14 + 8 + start) );
-		powerups = atoi( CG_Argv( i * 14 + 9 + start) );
-		cg.scores[i].accuracy = atoi(CG_Argv(i * 14 + 10 + start));
-		cg.scores[i].impressiveCount = atoi(CG_Argv(i * 14 + 11 + start));
-		cg.scores[i].excellentCount = atoi(CG_Argv(i * 14 + 12 + start));
-		cg.scores[i].guantletCount = atoi(CG_Argv(i * 14 + 13 + start));
-		cg.scores[i].defendCount = atoi(CG_Argv(i * 14 + 14 + start));
-		cg.scores[i].assistCount = atoi(CG_Argv(i * 14 + 15 + start));
-		cg.scores[i].perfect = atoi(CG_Argv(i * 14 + 16 + start));
-		cg.scores[i].captures = atoi(CG_Argv(i * 14 + 17 + start));
-
-		if ( cg.scores[i].playerNum < 0 || cg.scores[i].playerNum >= MAX_CLIENTS ) {
-			cg.scores[i].playerNum = 0;
-		}
-		cgs.playerinfo[ cg.scores[i].playerNum ].score = cg.scores[i].score;
-		cgs.playerinfo[ cg.scores[i].playerNum ].powerups = powerups;
-
-		cg.scores[i].team = cgs.playerinfo[cg.scores[i].playerNum].team;
+		playerNum = cg.scoreOrder[i];
+		fields = cg.scoreFields[playerNum];
+
+		cg.scores[i].playerNum = playerNum;
+		cg.scores[i].score = fields[SCORE_FIELD_SCORE];
+		cg.scores[i].ping = fields[SCORE_FIELD_PING];
+		cg.scores[i].time = fields[SCORE_FIELD_TIME];
+		cg.scores[i].scoreFlags = fields[SCORE_FIELD_FLAGS];
+		cg.scores[i].accuracy = fields[SCORE_FIELD_ACCURACY];
+		cg.scores[i].impressiveCount = fields[SCORE_FIELD_IMPRESSIVE];
+		cg.scores[i].excellentCount = fields[SCORE_FIELD_EXCELLENT];
+		cg.scores[i].guantletCount = fields[SCORE_FIELD_GAUNTLET];
+		cg.scores[i].defendCount = fields[SCORE_FIELD_DEFEND];
+		cg.scores[i].assistCount = fields[SCORE_FIELD_ASSIST];
+		cg.scores[i].perfect = fields[SCORE_FIELD_PERFECT];
+		cg.scores[i].captures = fields[SCORE_FIELD_CAPTURES];
+
+		cgs.playerinfo[ playerNum ].score = cg.scores[i].score;
+		cgs.playerinfo[ playerNum ].powerups = fields[SCORE_FIELD_POWERUPS];
+
+		cg.scores[i].team = cgs.playerinfo[playerNum].team;
 
 #ifdef MISSIONPACK_HUD
 		// restore score select, select own score if previous score player not present
@@ -135,6 +129,112 @@ static void CG_ParseScores( int start ) {
 	}
 }
 
+/*
+=================
+CG_ParsePlayerNum
+=================
+*/
+static int CG_ParsePlayerNum( int arg ) {
+	int		playerNum;
+
+	playerNum = atoi( CG_Argv( arg ) );
+	if ( playerNum < 0 || playerNum >= MAX_CLIENTS ) {
+		playerNum = 0;
+	}
+	return playerNum;
+}
+
+/*
+=================
+CG_ParseScores
+
+Full scoreboard from older servers and demos
+=================
+*/
+static void CG_ParseScores( int start ) {
+	int		i, j, playerNum;
+
+	cg.numScoreOrder = atoi( CG_Argv( 1 + start) );
+	if ( cg.numScoreOrder > MAX_CLIENTS ) {
+		cg.numScoreOrder = MAX_CLIENTS;
+	}
+
+	cg.teamScores[0] = atoi( CG_Argv( 2 + start) );
+	cg.teamScores[1] = atoi( CG_Argv( 3 + start) );
+
+	for ( i = 0 ; i < cg.numScoreOrder ; i++ ) {
+		playerNum = CG_ParsePlayerNum( i * 14 + 4 + start );
+		cg.scoreOrder[i] = playerNum;
+		for ( j = 0; j < SCORE_NUM_FIELDS; j++ ) {
+			cg.scoreFields[playerNum][j] = atoi( CG_Argv( i * 14 + 5 + j + start ) );
+		}
+	}
+
+	// the next request has to be for a full update again
+	cg.scoreVersion = 0;
+
+	CG_SetScores();
+}
+
+/*
+=================
+CG_ParseDeltaScores
+
+Applies the scoreboard changes since the version we have, see
+DeathmatchScoreboardMessage in the game for the format
+=================
+*/
+static void CG_ParseDeltaScores( int start ) {
+	int		base, numArgs;
+	int		arg, i, mask, playerNum;
+
+	base = atoi( CG_Argv( 1 + start ) );
+
+	// a delta against an older version than ours has all the changes
+	// since ours too, one against a newer or unknown version doesn't
+	if ( base && base > cg.scoreVersion ) {
+		if ( !cg.demoPlayback ) {
+			// based on a scoreboard we don't have (cgame restart), ask for all of it
+			cg.scoreVersion = 0;
+			cg.scoresRequestTime = cg.time;
+			trap_SendClientCommand( "score 0" );
+			return;
+		}
+		// demos can't ask, use what there is until the next full update
+	}
+
+	cg.scoreVersion = atoi( CG_Argv( 2 + start ) );
+	cg.teamScores[0] = atoi( CG_Argv( 3 + start ) );
+	cg.teamScores[1] = atoi( CG_Argv( 4 + start ) );
+
+	cg.numScoreOrder = atoi( CG_Argv( 5 + start ) );
+	if ( cg.numScoreOrder < 0 ) {
+		cg.numScoreOrder = 0;
+	} else if ( cg.numScoreOrder > MAX_CLIENTS ) {
+		cg.numScoreOrder = MAX_CLIENTS;
+	}
+
+	arg = 7 + start;
+	if ( atoi( CG_Argv( 6 + start ) ) ) {
+		for ( i = 0; i < cg.numScoreOrder; i++ ) {
+			cg.scoreOrder[i] = CG_ParsePlayerNum( arg++ );
+		}
+	}
+
+	numArgs = trap_Argc();
+	while ( arg + 1 < numArgs ) {
+		playerNum = CG_ParsePlayerNum( arg++ );
+		mask = atoi( CG_Argv( arg++ ) );
+		for ( i = 0; i < SCORE_NUM_FIELDS; i++ ) {
+			if ( mask & ( 1 << i ) ) {
+				cg.scoreFields[playerNum][i] = atoi( CG_Argv( arg++ ) );
+			}
+		}
+	}
+
+	CG_SetScores();
+}
+
 /*
 =================
 CG_ParseTeamInfo
@@ -1345,6 +1445,11 @@ static void CG_ServerCommand( void ) {
 	}
 #endif
 
+	if ( !strcmp( cmd, "dscores" ) ) {
+		CG_ParseDeltaScores(start);
+		return;
+	}
+
 	if ( !strcmp( cmd, "scores" ) ) {
 		CG_ParseScores(start);
 		return;
@@ -140,13 +140,42 @@ typedef struct bot_synonymlist_s
 	unsigned long int context;
 	float totalweight;
 	bot_synonym_t *firstsynonym;
+	bot_synonym_t *replacement;			//weighted replacement chosen for the current string
+	int replacementcount;				//string count the replacement was chosen for
 	struct bot_synonymlist_s *next;
 } bot_synonymlist_t;
 
+//synonym replacement modes
+#define SYNMODE_NORMAL				0		//replace with the first synonym of the list
+#define SYNMODE_WEIGHTED			1		//replace with a weighted random synonym
+#define SYNMODE_REPLY				2		//replace at the start of white space separated words
+
+//node of a synonym trie
+typedef struct bot_synonymnode_s
+{
+	int c;								//upper case character leading to this node
+	int firstchild;						//first child node
+	int sibling;						//next node with the same parent
+	bot_synonym_t *synonym;				//synonym ending at this node
+	bot_synonymlist_t *list;			//list the synonym is part of
+	int priority;						//order of the synonym in the synonym lists
+} bot_synonymnode_t;
+
+//synonyms of a context compiled into a trie
+typedef struct bot_synonymtable_s
+{
+	unsigned long int context;
+	int mode;
+	int numnodes;
+	bot_synonymnode_t *nodes;
+	struct bot_synonymtable_s *next;
+} bot_synonymtable_t;
+
 //fixed match string
 typedef struct bot_matchstring_s
 {
 	char *string;
+	int literal;						//match automaton state of the string
 	struct bot_matchstring_s *next;
 } bot_matchstring_t;
 
@@ -186,6 +215,29 @@ typedef struct bot_replychat_s
 	struct bot_replychat_s *next;
 } bot_replychat_t;
 
+//node of the match template string automaton
+typedef struct bot_matchnode_s
+{
+	int c;								//upper case character leading to this node
+	int firstchild;						//first child node
+	int sibling;						//next node with the same parent
+	int fail;							//longest proper suffix node
+	int output;							//longest proper suffix node that ends a literal
+	int literal;						//true if a literal ends at this node
+} bot_matchnode_t;
+
+//number of recently matched strings remembered
+#define MAX_MATCHCACHE				32
+
+//cached match result
+typedef struct bot_matchcache_s
+{
+	int hash;
+	unsigned long int context;
+	int found;
+	bot_match_t match;
+} bot_matchcache_t;
+
 //string list
 typedef struct bot_stringlist_s
 {
@@ -193,9 +245,6 @@ typedef struct bot_stringlist_s
 	struct bot_stringlist_s *next;
 } bot_stringlist_t;
 
-//may use up to MAX_CLIENTS * 2 console messages plus a few chat messages on map change
-#define MAX_CHATSTATE_MESSAGES ( MAX_CLIENTS * 3 )
-
 //chat state of a bot
 typedef struct bot_chatstate_s
 {
@@ -203,10 +252,9 @@ typedef struct bot_chatstate_s
 	int playernum;										//player number
 	char name[32];										//name of the bot
 	char chatmessage[MAX_MESSAGE_SIZE];
-	//the console messages visible to the bot
-	//index 0 is the oldest message
-	bot_consolemessage_t *consolemessages[MAX_CHATSTATE_MESSAGES];
-	//number of console messages stored in the state
+	//sequence number of the oldest console message that might still be unread
+	int consolemessagecursor;
+	//number of console messages queued for the state
 	int numconsolemessages;
 	//the bot chat lines
 	bot_chat_t *chat;
@@ -218,25 +266,55 @@ typedef struct {
 	char		chatname[MAX_QPATH];
 } bot_ichatdata_t;
 
-// enable for debuging console message heap / chatstate console message queues
+//number of synonym contexts a console message keeps normalized text for
+#define MAX_MESSAGE_CONTEXTS	2
+
+//console message shared by all the chat states it was queued for
+typedef struct bot_sharedmessage_s
+{
+	bot_consolemessage_t cm;							//the handle is the sequence number
+	int hash;											//hash of the message string
+	byte recipients[(MAX_CLIENTS+7)/8];					//chat states that haven't read the message
+	int numrecipients;
+	int unifiedoffset;									//offset of the chat text, -1 if not unified yet
+	char unified[MAX_MESSAGE_SIZE];						//message with unified white spaces
+	int numcontexts;
+	int nextcontext;
+	unsigned long int contexts[MAX_MESSAGE_CONTEXTS];
+	char normalized[MAX_MESSAGE_CONTEXTS][MAX_MESSAGE_SIZE];	//message with synonyms replaced
+} bot_sharedmessage_t;
+
+// enable for debuging the console message ring / chatstate console message queues
 //#define MESSAGE_DEBUG
 
 bot_ichatdata_t	*ichatdata[MAX_CLIENTS];
 
 bot_chatstate_t *botchatstates[MAX_CLIENTS+1];
-//console message heap
+//console message ring, as many messages as the old console message heap
+//held, old messages are overwritten when it wraps around
 #define MAX_MESSAGES	1024
-bot_consolemessage_t consolemessageheap[MAX_MESSAGES];
-bot_consolemessage_t *activeconsolemessages = NULL;
-bot_consolemessage_t *freeconsolemessages = NULL;
-int consolemessagehandle = 1;
-#ifdef MESSAGE_DEBUG
-int consolemessagescount = 0;
-#endif
+bot_sharedmessage_t consolemessagering[MAX_MESSAGES];
+//sequence number of the next console message
+int consolemessagesequence = 1;
+//unread messages lost to the ring wrapping around
+int consolemessagesdropped = 0;
+//sequence number of the last warning about dropped messages
+int consolemessagedropwarning = 0;
 //list with match strings
 bot_matchtemplate_t *matchtemplates = NULL;
+//match automaton over the literal strings of the match templates
+bot_matchnode_t *matchnodes = NULL;
+int nummatchnodes = 0;
+int *matchliteralseen = NULL;
+int matchsearchcount = 0;
+//recently matched strings
+bot_matchcache_t matchcache[MAX_MATCHCACHE];
+int matchcachenext = 0;
 //list with synonyms
 bot_synonymlist_t *synonyms = NULL;
+//synonym tables compiled per context
+bot_synonymtable_t *synonymtables = NULL;
+int synonymreplacecount = 0;
 //list with random strings
 bot_randomlist_t *randomstrings = NULL;
 //reply chats
@@ -263,112 +341,50 @@ bot_chatstate_t *BotChatStateFromHandle(int handle)
 	return botchatstates[handle];
 } //end of the function BotChatStateFromHandle
 //===========================================================================
-// initialize the heap with unused console messages
+// clear the console message ring
 //
 // Parameter:				-
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-void InitConsoleMessageHeap(void)
+void InitConsoleMessageRing(void)
 {
-	int i;
-
-	Com_Memset( &consolemessageheap, 0, sizeof ( consolemessageheap ) );
-
-	consolemessageheap[0].prev = NULL;
-	consolemessageheap[0].next = &consolemessageheap[1];
-	for (i = 1; i < MAX_MESSAGES-1; i++)
-	{
-		consolemessageheap[i].prev = &consolemessageheap[i - 1];
-		consolemessageheap[i].next = &consolemessageheap[i + 1];
-	} //end for
-	consolemessageheap[MAX_MESSAGES-1].prev = &consolemessageheap[MAX_MESSAGES-2];
-	consolemessageheap[MAX_MESSAGES-1].next = NULL;
-	//pointer to the free console messages
-	freeconsolemessages = consolemessageheap;
-
-	activeconsolemessages = NULL;
-	consolemessagehandle = 1;
-#ifdef MESSAGE_DEBUG
-	consolemessagescount = 0;
-#endif
-} //end of the function InitConsoleMessageHeap
+	Com_Memset( &consolemessagering, 0, sizeof ( consolemessagering ) );
+	consolemessagesequence = 1;
+	consolemessagesdropped = 0;
+	consolemessagedropwarning = 0;
+} //end of the function InitConsoleMessageRing
 //===========================================================================
-// allocate one console message from the heap
 //
 // Parameter:				-
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-bot_consolemessage_t *AllocConsoleMessage(int type, const char *message, float time)
+int BotConsoleMessageHash(const char *message)
 {
-	bot_consolemessage_t *m;
-
-	for (m = activeconsolemessages; m; m = m->next)
-	{
-		if (m->time == time && m->type == type && strcmp(m->message, message) == 0)
-		{
-			m->references++;
-			return m;
-		}
-	}
-
-	m = freeconsolemessages;
-	if (freeconsolemessages) freeconsolemessages = freeconsolemessages->next;
-	if (freeconsolemessages) freeconsolemessages->prev = NULL;
-
-	if (m)
-	{
-		consolemessagehandle++;
-		if (consolemessagehandle <= 0 || consolemessagehandle > 8192) {
-			consolemessagehandle = 1;
-		}
-		m->handle = consolemessagehandle;
-		m->time = time;
-		m->type = type;
-		Q_strncpyz(m->message, message, MAX_MESSAGE_SIZE);
-		m->references = 1;
-
-		if (activeconsolemessages) activeconsolemessages->prev = m;
-		m->prev = NULL;
-		m->next = activeconsolemessages;
-		activeconsolemessages = m;
-
-#ifdef MESSAGE_DEBUG
-		consolemessagescount++;
-#endif
-	}
+	int hash;
 
-	return m;
-} //end of the function AllocConsoleMessage
+	for (hash = 0; *message; message++) hash = hash * 31 + *message;
+	return hash;
+} //end of the function BotConsoleMessageHash
 //===========================================================================
-// deallocate one console message from the heap
+// returns the shared console message with the given sequence number or
+// NULL if it has been overwritten
 //
 // Parameter:				-
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-void FreeConsoleMessage(bot_consolemessage_t *message)
+bot_sharedmessage_t *BotSharedConsoleMessage(int sequence)
 {
-	message->references--;
-	if ( message->references > 0 )
-		return;
+	bot_sharedmessage_t *m;
 
-	if (message->prev)
-		message->prev->next = message->next;
-	if (message->next)
-		message->next->prev = message->prev;
-	if (message == activeconsolemessages)
-		activeconsolemessages = activeconsolemessages->next;
-
-	if (freeconsolemessages) freeconsolemessages->prev = message;
-	message->prev = NULL;
-	message->next = freeconsolemessages;
-	freeconsolemessages = message;
-#ifdef MESSAGE_DEBUG
-	consolemessagescount--;
-#endif
-} //end of the function FreeConsoleMessage
+	if (sequence <= 0 || sequence >= consolemessagesequence) return NULL;
+	if (consolemessagesequence - sequence > MAX_MESSAGES) return NULL;
+	m = &consolemessagering[sequence % MAX_MESSAGES];
+	if (m->cm.handle != sequence) return NULL;
+	return m;
+} //end of the function BotSharedConsoleMessage
 //===========================================================================
 //
 // Parameter:				-
@@ -378,30 +394,20 @@ void FreeConsoleMessage(bot_consolemessage_t *message)
 void BotRemoveConsoleMessage(int chatstate, int handle)
 {
 	bot_chatstate_t *cs;
-	int i;
+	bot_sharedmessage_t *m;
+	int bit;
 
 	cs = BotChatStateFromHandle(chatstate);
 	if (!cs) return;
 
-	for (i = 0; i < cs->numconsolemessages; i++)
-	{
-		if (cs->consolemessages[i]->handle == handle)
-		{
-			FreeConsoleMessage(cs->consolemessages[i]);
-
-			if (i+1 == cs->numconsolemessages)
-			{
-				cs->consolemessages[i] = NULL;
-			}
-			else
-			{
-				memmove( &cs->consolemessages[i], &cs->consolemessages[i+1], sizeof (cs->consolemessages[0]) * ( cs->numconsolemessages - ( i + 1 ) ) );
-			}
-
-			cs->numconsolemessages--;
-			break;
-		} //end if
-	} //end for
+	m = BotSharedConsoleMessage(handle);
+	if (!m) return;
+	bit = chatstate - 1;
+	if (!(m->recipients[bit >> 3] & (1 << (bit & 7)))) return;
+	m->recipients[bit >> 3] &= ~(1 << (bit & 7));
+	m->numrecipients--;
+	cs->numconsolemessages--;
+	if (cs->consolemessagecursor == handle) cs->consolemessagecursor++;
 } //end of the function BotRemoveConsoleMessage
 //===========================================================================
 //
@@ -411,65 +417,119 @@ void BotRemoveConsoleMessage(int chatstate, int handle)
 //===========================================================================
 void BotQueueConsoleMessage(int chatstate, int type, char *message)
 {
-	bot_consolemessage_t *m;
+	bot_sharedmessage_t *m;
 	bot_chatstate_t *cs;
+	int hash, bit, sequence, i;
+	float time;
 
 	cs = BotChatStateFromHandle(chatstate);
 	if (!cs) return;
 
-	if (cs->numconsolemessages >= MAX_CHATSTATE_MESSAGES)
-	{
-		BotAI_Print(PRT_ERROR, "max chatstate console messages reached\n");
+	bit = chatstate - 1;
+	time = trap_AAS_Time();
+	hash = BotConsoleMessageHash(message);
+	//other bots usually received the same message this frame
+	for (sequence = consolemessagesequence - 1; sequence >= cs->consolemessagecursor; sequence--)
+	{
+		m = BotSharedConsoleMessage(sequence);
+		if (!m || m->cm.time != time) break;
+		if (m->hash != hash || m->cm.type != type) continue;
+		if (m->recipients[bit >> 3] & (1 << (bit & 7))) continue;
+		if (strcmp(m->cm.message, message)) continue;
+		m->recipients[bit >> 3] |= (1 << (bit & 7));
+		m->numrecipients++;
+		cs->numconsolemessages++;
 		return;
-	}
+	} //end for
 
-	m = AllocConsoleMessage(type, message, trap_AAS_Time());
-#ifdef MESSAGE_DEBUG
-	BotAI_Print(PRT_MESSAGE, "BotQueueConsoleMessage( %d, %s, %s ), index %d, bot queue %d, heap total %d\n",
-		chatstate, type == CMS_CHAT ? "CMS_CHAT" : "CHAT_NORMAL", message, m ? (int)(m - consolemessageheap) : -1, cs->numconsolemessages, consolemessagescount );
-#endif
-	if (!m)
+	m = &consolemessagering[consolemessagesequence % MAX_MESSAGES];
+	//chat states that didn't read the overwritten message lose it
+	if (m->numrecipients)
 	{
-		BotAI_Print(PRT_ERROR, "empty console message heap\n");
-		return;
+		for (i = 0; i < MAX_CLIENTS; i++)
+		{
+			if (!(m->recipients[i >> 3] & (1 << (i & 7)))) continue;
+			if (botchatstates[i+1]) botchatstates[i+1]->numconsolemessages--;
+		} //end for
+		consolemessagesdropped += m->numrecipients;
+		//warn at most once per trip around the ring
+		if (!consolemessagedropwarning || consolemessagesequence - consolemessagedropwarning >= MAX_MESSAGES)
+		{
+			BotAI_Print(PRT_WARNING, "console message ring full, %d unread bot messages dropped\n", consolemessagesdropped);
+			consolemessagedropwarning = consolemessagesequence;
+		} //end if
 	} //end if
-	cs->consolemessages[cs->numconsolemessages] = m;
+	Com_Memset(m->recipients, 0, sizeof(m->recipients));
+	m->cm.handle = consolemessagesequence++;
+	m->cm.time = time;
+	m->cm.type = type;
+	Q_strncpyz(m->cm.message, message, sizeof(m->cm.message));
+	m->hash = BotConsoleMessageHash(m->cm.message);
+	m->unifiedoffset = -1;
+	m->numcontexts = 0;
+	m->nextcontext = 0;
+	m->recipients[bit >> 3] |= (1 << (bit & 7));
+	m->numrecipients = 1;
 	cs->numconsolemessages++;
+#ifdef MESSAGE_DEBUG
+	BotAI_Print(PRT_MESSAGE, "BotQueueConsoleMessage( %d, %s, %s ), sequence %d, bot queue %d\n",
+		chatstate, type == CMS_CHAT ? "CMS_CHAT" : "CHAT_NORMAL", message, m->cm.handle, cs->numconsolemessages );
+#endif
 } //end of the function BotQueueConsoleMessage
 //===========================================================================
+// returns the next console message of the state without copying it
 //
 // Parameter:				-
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-int BotNextConsoleMessage(int chatstate, bot_consolemessage_t *cm)
+bot_consolemessage_t *BotPeekConsoleMessage(int chatstate)
 {
 	bot_chatstate_t *cs;
-	bot_consolemessage_t *firstmsg;
+	bot_sharedmessage_t *m;
+	int sequence, bit;
 
 	cs = BotChatStateFromHandle(chatstate);
-	if (!cs) return 0;
-	if (cs->numconsolemessages > 0)
-	{
-		firstmsg = cs->consolemessages[0];
-		cm->handle = firstmsg->handle;
-		cm->time = firstmsg->time;
-		cm->type = firstmsg->type;
-		Q_strncpyz(cm->message, firstmsg->message,
-			   sizeof(cm->message));
-		
-		/* We omit setting the two pointers in cm because pointer
-		 * size in the VM differs between the size in the engine on
-		 * 64 bit machines, which would lead to a buffer overflow if
-		 * this functions is called from the VM. The pointers are
-		 * of no interest to functions calling
-		 * BotNextConsoleMessage anyways.
-		 */
-		
-		return cm->handle;
+	if (!cs) return NULL;
+	if (cs->numconsolemessages <= 0) return NULL;
+
+	bit = chatstate - 1;
+	sequence = cs->consolemessagecursor;
+	if (consolemessagesequence - sequence > MAX_MESSAGES)
+	{
+		sequence = consolemessagesequence - MAX_MESSAGES;
 	} //end if
-	return 0;
-} //end of the function BotConsoleMessage
+	for (; sequence < consolemessagesequence; sequence++)
+	{
+		m = &consolemessagering[sequence % MAX_MESSAGES];
+		if (m->recipients[bit >> 3] & (1 << (bit & 7)))
+		{
+			cs->consolemessagecursor = sequence;
+			return &m->cm;
+		} //end if
+	} //end for
+	cs->consolemessagecursor = consolemessagesequence;
+	cs->numconsolemessages = 0;
+	return NULL;
+} //end of the function BotPeekConsoleMessage
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int BotNextConsoleMessage(int chatstate, bot_consolemessage_t *cm)
+{
+	bot_consolemessage_t *firstmsg;
+
+	firstmsg = BotPeekConsoleMessage(chatstate);
+	if (!firstmsg) return 0;
+	cm->handle = firstmsg->handle;
+	cm->time = firstmsg->time;
+	cm->type = firstmsg->type;
+	Q_strncpyz(cm->message, firstmsg->message, sizeof(cm->message));
+	return cm->handle;
+} //end of the function BotNextConsoleMessage
 //===========================================================================
 //
 // Parameter:				-
@@ -626,39 +686,6 @@ char *StringContainsWord(char *str1, char *str2, int casesensitive)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-void StringReplaceWords(char *string, char *synonym, char *replacement)
-{
-	char *str, *str2;
-
-	//find the synonym in the string
-	str = StringContainsWord(string, synonym, qfalse);
-	//if the synonym occurred in the string
-	while(str)
-	{
-		//if the synonym isn't part of the replacement which is already in the string
-		//useful for abbreviations
-		str2 = StringContainsWord(string, replacement, qfalse);
-		while(str2)
-		{
-			if (str2 <= str && str < str2 + strlen(replacement)) break;
-			str2 = StringContainsWord(str2+1, replacement, qfalse);
-		} //end while
-		if (!str2)
-		{
-			memmove(str + strlen(replacement), str+strlen(synonym), strlen(str+strlen(synonym))+1);
-			//append the synonum replacement
-			Com_Memcpy(str, replacement, strlen(replacement));
-		} //end if
-		//find the next synonym in the string
-		str = StringContainsWord(str+strlen(replacement), synonym, qfalse);
-	} //end if
-} //end of the function StringReplaceWords
-//===========================================================================
-//
-// Parameter:				-
-// Returns:					-
-// Changes Globals:		-
-//===========================================================================
 #if 0
 void BotDumpSynonymList(bot_synonymlist_t *synlist)
 {
@@ -850,105 +877,298 @@ bot_synonymlist_t *BotLoadSynonyms(char *filename)
 	return synlist;
 } //end of the function BotLoadSynonyms
 //===========================================================================
-// replace all the synonyms in the string
 //
 // Parameter:				-
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-void BotReplaceSynonyms(char *string, unsigned long int context)
+void BotFreeSynonymTables(void)
 {
-	bot_synonymlist_t *syn;
-	bot_synonym_t *synonym;
+	bot_synonymtable_t *table, *nexttable;
 
-	for (syn = synonyms; syn; syn = syn->next)
+	for (table = synonymtables; table; table = nexttable)
 	{
-		if (!(syn->context & context)) continue;
-		for (synonym = syn->firstsynonym->next; synonym; synonym = synonym->next)
-		{
-			StringReplaceWords(string, synonym->string, syn->firstsynonym->string);
-		} //end for
+		nexttable = table->next;
+		FreeMemory(table->nodes);
+		FreeMemory(table);
 	} //end for
-} //end of the function BotReplaceSynonyms
+	synonymtables = NULL;
+} //end of the function BotFreeSynonymTables
 //===========================================================================
+// returns the trie with all the synonyms that can be replaced in the
+// given context, the trie is built the first time it's used
 //
 // Parameter:				-
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-void BotReplaceWeightedSynonyms(char *string, unsigned long int context)
+bot_synonymtable_t *BotSynonymTable(unsigned long int context, int mode)
 {
+	bot_synonymtable_t *table;
 	bot_synonymlist_t *syn;
-	bot_synonym_t *synonym, *replacement;
-	float weight, curweight;
+	bot_synonym_t *synonym;
+	int size, priority, node, child, c;
+	char *ptr;
 
+	for (table = synonymtables; table; table = table->next)
+	{
+		if (table->context == context && table->mode == mode) return table;
+	} //end for
+	//count the maximum number of nodes
+	size = 1;
 	for (syn = synonyms; syn; syn = syn->next)
 	{
 		if (!(syn->context & context)) continue;
-		//choose a weighted random replacement synonym
-		weight = random() * syn->totalweight;
-		if (!weight) continue;
-		curweight = 0;
-		for (replacement = syn->firstsynonym; replacement; replacement = replacement->next)
+		for (synonym = syn->firstsynonym; synonym; synonym = synonym->next)
 		{
-			curweight += replacement->weight;
-			if (weight < curweight) break;
+			size += strlen(synonym->string);
 		} //end for
-		if (!replacement) continue;
-		//replace all synonyms with the replacement
-		for (synonym = syn->firstsynonym; synonym; synonym = synonym->next)
+	} //end for
+	table = (bot_synonymtable_t *) GetClearedMemory(sizeof(bot_synonymtable_t));
+	table->nodes = (bot_synonymnode_t *) GetClearedMemory(size * sizeof(bot_synonymnode_t));
+	Com_Memset(table->nodes, 0, size * sizeof(bot_synonymnode_t));
+	table->context = context;
+	table->mode = mode;
+	table->numnodes = 1;
+	//add the synonyms in the order they are replaced in
+	priority = 0;
+	for (syn = synonyms; syn; syn = syn->next)
+	{
+		if (!(syn->context & context)) continue;
+		//the first synonym is only replaced with weighted synonyms
+		synonym = syn->firstsynonym;
+		if (mode != SYNMODE_WEIGHTED) synonym = synonym->next;
+		for (; synonym; synonym = synonym->next)
 		{
-			if (synonym == replacement) continue;
-			StringReplaceWords(string, synonym->string, replacement->string);
+			node = 0;
+			for (ptr = synonym->string; *ptr; ptr++)
+			{
+				c = toupper(*ptr);
+				for (child = table->nodes[node].firstchild; child; child = table->nodes[child].sibling)
+				{
+					if (table->nodes[child].c == c) break;
+				} //end for
+				if (!child)
+				{
+					child = table->numnodes++;
+					table->nodes[child].c = c;
+					table->nodes[child].sibling = table->nodes[node].firstchild;
+					table->nodes[node].firstchild = child;
+				} //end if
+				node = child;
+			} //end for
+			priority++;
+			//the same synonym earlier in the lists is used first
+			if (table->nodes[node].synonym) continue;
+			table->nodes[node].synonym = synonym;
+			table->nodes[node].list = syn;
+			table->nodes[node].priority = priority;
 		} //end for
 	} //end for
-} //end of the function BotReplaceWeightedSynonyms
+	table->next = synonymtables;
+	synonymtables = table;
+	return table;
+} //end of the function BotSynonymTable
 //===========================================================================
 //
 // Parameter:				-
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-void BotReplaceReplySynonyms(char *string, unsigned long int context)
+int IsSynonymWordSeparator(char c)
+{
+	return (c == ' ' || c == '.' || c == ',' || c == '!');
+} //end of the function IsSynonymWordSeparator
+//===========================================================================
+// returns true if a synonym can start at the given position
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int IsSynonymWordStart(char *string, int pos, int mode)
+{
+	if (mode == SYNMODE_REPLY)
+	{
+		return (string[pos] > ' ' && (pos == 0 || string[pos-1] <= ' '));
+	} //end if
+	return (pos == 0 || IsSynonymWordSeparator(string[pos-1]));
+} //end of the function IsSynonymWordStart
+//===========================================================================
+// returns true if the word is at the given position in the string
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int SynonymWordAt(char *string, int pos, char *word)
+{
+	int i;
+
+	for (i = 0; word[i]; i++)
+	{
+		if (toupper(string[pos+i]) != toupper(word[i])) return qfalse;
+	} //end for
+	return (!string[pos+i] || IsSynonymWordSeparator(string[pos+i]));
+} //end of the function SynonymWordAt
+//===========================================================================
+// returns true if the synonym at the given position is part of the
+// replacement which is already in the string, useful for abbreviations
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int SynonymInReplacement(char *string, int pos, char *replacement, int mode)
+{
+	int start;
+
+	//reply synonyms are only checked against the replacement at the same word
+	if (mode == SYNMODE_REPLY) return SynonymWordAt(string, pos, replacement);
+	start = pos - strlen(replacement) + 1;
+	if (start < 0) start = 0;
+	for (; pos >= start; pos--)
+	{
+		if (!IsSynonymWordStart(string, pos, mode)) continue;
+		if (SynonymWordAt(string, pos, replacement)) return qtrue;
+	} //end for
+	return qfalse;
+} //end of the function SynonymInReplacement
+//===========================================================================
+// returns the replacement for the synonym or NULL if it shouldn't be replaced
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+bot_synonym_t *BotSynonymReplacement(bot_synonymnode_t *node, int mode)
 {
-	char *str1, *str2, *replacement;
 	bot_synonymlist_t *syn;
-	bot_synonym_t *synonym;
+	bot_synonym_t *replacement;
+	float weight, curweight;
 
-	for (str1 = string; *str1; )
+	syn = node->list;
+	if (mode != SYNMODE_WEIGHTED) return syn->firstsynonym;
+	//choose a weighted random replacement synonym once per string
+	if (syn->replacementcount != synonymreplacecount)
 	{
-		//go to the start of the next word
-		while(*str1 && *str1 <= ' ') str1++;
-		if (!*str1) break;
-		//
-		for (syn = synonyms; syn; syn = syn->next)
+		syn->replacementcount = synonymreplacecount;
+		syn->replacement = NULL;
+		weight = random() * syn->totalweight;
+		if (weight)
 		{
-			if (!(syn->context & context)) continue;
-			for (synonym = syn->firstsynonym->next; synonym; synonym = synonym->next)
+			curweight = 0;
+			for (replacement = syn->firstsynonym; replacement; replacement = replacement->next)
 			{
-				//if the synonym is not at the front of the string continue
-				str2 = StringContainsWord(str1, synonym->string, qfalse);
-				if (!str2 || str2 != str1) continue;
-				//
-				replacement = syn->firstsynonym->string;
-				//if the replacement IS in front of the string continue
-				str2 = StringContainsWord(str1, replacement, qfalse);
-				if (str2 && str2 == str1) continue;
-				//
-				memmove(str1 + strlen(replacement), str1+strlen(synonym->string),
-							strlen(str1+strlen(synonym->string)) + 1);
-				//append the synonum replacement
-				Com_Memcpy(str1, replacement, strlen(replacement));
-				//
-				break;
+				curweight += replacement->weight;
+				if (weight < curweight) break;
 			} //end for
-			//if a synonym has been replaced
-			if (synonym) break;
-		} //end for
-		//skip over this word
-		while(*str1 && *str1 > ' ') str1++;
-		if (!*str1) break;
+			syn->replacement = replacement;
+		} //end if
+	} //end if
+	if (syn->replacement == node->synonym) return NULL;
+	return syn->replacement;
+} //end of the function BotSynonymReplacement
+//===========================================================================
+// replaces all the synonyms of the context in a single pass over the string
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotReplaceSynonymWords(char *string, int size, unsigned long int context, int mode)
+{
+	char out[MAX_MESSAGE_SIZE];
+	int pos, len, outlen, node, child, c, bestlen;
+	bot_synonymtable_t *table;
+	bot_synonymnode_t *n, *best;
+	bot_synonym_t *replacement, *bestreplacement;
+
+	if (!synonyms) return;
+	if (size > MAX_MESSAGE_SIZE) size = MAX_MESSAGE_SIZE;
+	table = BotSynonymTable(context, mode);
+	if (!table->nodes[0].firstchild) return;
+	synonymreplacecount++;
+	//
+	outlen = 0;
+	pos = 0;
+	while(string[pos] && outlen < size - 1)
+	{
+		best = NULL;
+		bestreplacement = NULL;
+		bestlen = 0;
+		if (IsSynonymWordStart(string, pos, mode))
+		{
+			//find the first listed synonym at this position
+			node = 0;
+			for (len = 0; string[pos+len]; len++)
+			{
+				c = toupper(string[pos+len]);
+				for (child = table->nodes[node].firstchild; child; child = table->nodes[child].sibling)
+				{
+					if (table->nodes[child].c == c) break;
+				} //end for
+				if (!child) break;
+				node = child;
+				n = &table->nodes[node];
+				if (!n->synonym) continue;
+				if (best && best->priority < n->priority) continue;
+				//the synonym has to be a whole word
+				if (string[pos+len+1] && !IsSynonymWordSeparator(string[pos+len+1])) continue;
+				replacement = BotSynonymReplacement(n, mode);
+				if (!replacement) continue;
+				if (SynonymInReplacement(string, pos, replacement->string, mode)) continue;
+				best = n;
+				bestreplacement = replacement;
+				bestlen = len + 1;
+			} //end for
+		} //end if
+		if (best)
+		{
+			len = strlen(bestreplacement->string);
+			if (outlen + len > size - 1) len = size - 1 - outlen;
+			Com_Memcpy(&out[outlen], bestreplacement->string, len);
+			outlen += len;
+			pos += bestlen;
+		} //end if
+		else
+		{
+			out[outlen++] = string[pos++];
+		} //end else
 	} //end while
+	out[outlen] = '\0';
+	Q_strncpyz(string, out, size);
+} //end of the function BotReplaceSynonymWords
+//===========================================================================
+// replace all the synonyms in the string
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotReplaceSynonyms(char *string, unsigned long int context)
+{
+	BotReplaceSynonymWords(string, MAX_MESSAGE_SIZE, context, SYNMODE_NORMAL);
+} //end of the function BotReplaceSynonyms
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotReplaceWeightedSynonyms(char *string, unsigned long int context)
+{
+	BotReplaceSynonymWords(string, MAX_MESSAGE_SIZE, context, SYNMODE_WEIGHTED);
+} //end of the function BotReplaceWeightedSynonyms
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotReplaceReplySynonyms(char *string, unsigned long int context)
+{
+	BotReplaceSynonymWords(string, MAX_MESSAGE_SIZE, context, SYNMODE_REPLY);
 } //end of the function BotReplaceReplySynonyms
 //===========================================================================
 //
@@ -1462,6 +1682,194 @@ bot_matchtemplate_t *BotLoadMatchTemplates(char *matchfile)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
+void BotFreeMatchAutomaton(void)
+{
+	if (matchnodes) FreeMemory(matchnodes);
+	matchnodes = NULL;
+	if (matchliteralseen) FreeMemory(matchliteralseen);
+	matchliteralseen = NULL;
+	nummatchnodes = 0;
+	matchsearchcount = 0;
+	//cached results refer to the old templates
+	Com_Memset(matchcache, 0, sizeof(matchcache));
+	matchcachenext = 0;
+} //end of the function BotFreeMatchAutomaton
+//===========================================================================
+// add a literal match string to the automaton trie
+//
+// Parameter:				-
+// Returns:					the node the literal ends at
+// Changes Globals:		-
+//===========================================================================
+int BotAddMatchLiteral(char *string)
+{
+	int node, child, c;
+
+	node = 0;
+	for (; *string; string++)
+	{
+		c = toupper(*string);
+		for (child = matchnodes[node].firstchild; child; child = matchnodes[child].sibling)
+		{
+			if (matchnodes[child].c == c) break;
+		} //end for
+		if (!child)
+		{
+			child = nummatchnodes++;
+			matchnodes[child].c = c;
+			matchnodes[child].sibling = matchnodes[node].firstchild;
+			matchnodes[node].firstchild = child;
+		} //end if
+		node = child;
+	} //end for
+	matchnodes[node].literal = qtrue;
+	return node;
+} //end of the function BotAddMatchLiteral
+//===========================================================================
+// builds an Aho-Corasick automaton over all the literal strings in the
+// match templates so a message only has to be scanned once to find out
+// which templates can possibly match
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotCompileMatchTemplates(bot_matchtemplate_t *matches)
+{
+	int size, node, child, fail, next, head, tail, *queue;
+	bot_matchtemplate_t *mt;
+	bot_matchpiece_t *mp;
+	bot_matchstring_t *ms;
+
+	BotFreeMatchAutomaton();
+	//count the maximum number of nodes
+	size = 1;
+	for (mt = matches; mt; mt = mt->next)
+	{
+		for (mp = mt->first; mp; mp = mp->next)
+		{
+			if (mp->type != MT_STRING) continue;
+			for (ms = mp->firststring; ms; ms = ms->next)
+			{
+				size += strlen(ms->string);
+			} //end for
+		} //end for
+	} //end for
+	matchnodes = (bot_matchnode_t *) GetClearedMemory(size * sizeof(bot_matchnode_t));
+	matchliteralseen = (int *) GetClearedMemory(size * sizeof(int));
+	Com_Memset(matchnodes, 0, size * sizeof(bot_matchnode_t));
+	Com_Memset(matchliteralseen, 0, size * sizeof(int));
+	nummatchnodes = 1;
+	//build the trie
+	for (mt = matches; mt; mt = mt->next)
+	{
+		for (mp = mt->first; mp; mp = mp->next)
+		{
+			if (mp->type != MT_STRING) continue;
+			for (ms = mp->firststring; ms; ms = ms->next)
+			{
+				if (!strlen(ms->string)) ms->literal = 0;
+				else ms->literal = BotAddMatchLiteral(ms->string);
+			} //end for
+		} //end for
+	} //end for
+	//set the fail and output links breadth first
+	queue = (int *) GetClearedMemory(nummatchnodes * sizeof(int));
+	head = tail = 0;
+	for (child = matchnodes[0].firstchild; child; child = matchnodes[child].sibling)
+	{
+		matchnodes[child].fail = 0;
+		matchnodes[child].output = 0;
+		queue[tail++] = child;
+	} //end for
+	while(head < tail)
+	{
+		node = queue[head++];
+		for (child = matchnodes[node].firstchild; child; child = matchnodes[child].sibling)
+		{
+			fail = matchnodes[node].fail;
+			while(1)
+			{
+				for (next = matchnodes[fail].firstchild; next; next = matchnodes[next].sibling)
+				{
+					if (matchnodes[next].c == matchnodes[child].c) break;
+				} //end for
+				if (next || !fail) break;
+				fail = matchnodes[fail].fail;
+			} //end while
+			matchnodes[child].fail = next;
+			if (matchnodes[next].literal) matchnodes[child].output = next;
+			else matchnodes[child].output = matchnodes[next].output;
+			queue[tail++] = child;
+		} //end for
+	} //end while
+	FreeMemory(queue);
+} //end of the function BotCompileMatchTemplates
+//===========================================================================
+// marks all the match template literals that occur in the string
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotSearchMatchLiterals(char *str)
+{
+	int node, child, c, out;
+
+	matchsearchcount++;
+	node = 0;
+	for (; *str; str++)
+	{
+		c = toupper(*str);
+		while(1)
+		{
+			for (child = matchnodes[node].firstchild; child; child = matchnodes[child].sibling)
+			{
+				if (matchnodes[child].c == c) break;
+			} //end for
+			if (child || !node) break;
+			node = matchnodes[node].fail;
+		} //end while
+		node = child;
+		if (matchnodes[node].literal) out = node;
+		else out = matchnodes[node].output;
+		for (; out && matchliteralseen[out] != matchsearchcount; out = matchnodes[out].output)
+		{
+			matchliteralseen[out] = matchsearchcount;
+		} //end for
+	} //end for
+} //end of the function BotSearchMatchLiterals
+//===========================================================================
+// returns false if the template can't match the last searched string
+// because one of its string pieces doesn't occur in it
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int BotMatchTemplatePossible(bot_matchtemplate_t *mt)
+{
+	bot_matchpiece_t *mp;
+	bot_matchstring_t *ms;
+
+	for (mp = mt->first; mp; mp = mp->next)
+	{
+		if (mp->type != MT_STRING) continue;
+		for (ms = mp->firststring; ms; ms = ms->next)
+		{
+			if (!ms->literal) break;
+			if (matchliteralseen[ms->literal] == matchsearchcount) break;
+		} //end for
+		if (!ms) return qfalse;
+	} //end for
+	return qtrue;
+} //end of the function BotMatchTemplatePossible
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
 int StringsMatch(bot_matchpiece_t *pieces, bot_match_t *match)
 {
 	int lastvariable, index;
@@ -1541,8 +1949,9 @@ int StringsMatch(bot_matchpiece_t *pieces, bot_match_t *match)
 //===========================================================================
 int BotFindMatch(char *str, bot_match_t *match, unsigned long int context)
 {
-	int i;
+	int i, hash, found;
 	bot_matchtemplate_t *ms;
+	bot_matchcache_t *mc;
 
 	strncpy(match->string, str, MAX_MESSAGE_SIZE);
 	//remove any trailing enters
@@ -1551,10 +1960,32 @@ int BotFindMatch(char *str, bot_match_t *match, unsigned long int context)
 	{
 		match->string[strlen(match->string)-1] = '\0';
 	} //end while
+	//all bots see the same console messages so check if this string
+	//has been matched recently
+	hash = 0;
+	for (i = 0; match->string[i]; i++) hash = hash * 31 + match->string[i];
+	for (i = 0; i < MAX_MATCHCACHE; i++)
+	{
+		mc = &matchcache[i];
+		if (!mc->context) continue;
+		if (mc->hash != hash || mc->context != context) continue;
+		if (strcmp(mc->match.string, match->string)) continue;
+		Com_Memcpy(match->variables, mc->match.variables, sizeof(match->variables));
+		if (mc->found)
+		{
+			match->type = mc->match.type;
+			match->subtype = mc->match.subtype;
+		} //end if
+		return mc->found;
+	} //end for
+	//find all the template strings in the string in one pass
+	if (matchnodes) BotSearchMatchLiterals(match->string);
 	//compare the string with all the match strings
+	found = qfalse;
 	for (ms = matchtemplates; ms; ms = ms->next)
 	{
 		if (!(ms->context & context)) continue;
+		if (matchnodes && !BotMatchTemplatePossible(ms)) continue;
 		//reset the match variable offsets
 		for (i = 0; i < MAX_MATCHVARIABLES; i++) match->variables[i].offset = -1;
 		//
@@ -1562,10 +1993,22 @@ int BotFindMatch(char *str, bot_match_t *match, unsigned long int context)
 		{
 			match->type = ms->type;
 			match->subtype = ms->subtype;
-			return qtrue;
+			found = qtrue;
+			break;
 		} //end if
 	} //end for
-	return qfalse;
+	if (!found)
+	{
+		for (i = 0; i < MAX_MATCHVARIABLES; i++) match->variables[i].offset = -1;
+	} //end if
+	//remember the result
+	mc = &matchcache[matchcachenext];
+	matchcachenext = (matchcachenext + 1) % MAX_MATCHCACHE;
+	mc->hash = hash;
+	mc->context = context;
+	mc->found = found;
+	Com_Memcpy(&mc->match, match, sizeof(bot_match_t));
+	return found;
 } //end of the function BotFindMatch
 //===========================================================================
 //
@@ -1636,6 +2079,52 @@ void BotMatchVariable(bot_match_t *match, int variable, char *buf, int size)
 	} //end else
 } //end of the function BotMatchVariable
 //===========================================================================
+// returns the console message with unified white spaces and the synonyms
+// of the given context replaced, the text is shared by all chat states
+// and only normalized once per context
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+char *BotNormalizedConsoleMessage(int handle, unsigned long int context)
+{
+	bot_sharedmessage_t *m;
+	bot_match_t match;
+	int i;
+
+	m = BotSharedConsoleMessage(handle);
+	if (!m) return NULL;
+	if (m->unifiedoffset < 0)
+	{
+		Q_strncpyz(m->unified, m->cm.message, sizeof(m->unified));
+		m->unifiedoffset = 0;
+		//if it is a chat message then don't unify white spaces and don't
+		//replace synonyms in the netname
+		if (m->cm.type == CMS_CHAT)
+		{
+			if (BotFindMatch(m->unified, &match, MTCONTEXT_REPLYCHAT) &&
+					match.variables[MESSAGE].offset >= 0)
+			{
+				m->unifiedoffset = match.variables[MESSAGE].offset;
+			} //end if
+		} //end if
+		UnifyWhiteSpaces(m->unified + m->unifiedoffset);
+	} //end if
+	for (i = 0; i < m->numcontexts; i++)
+	{
+		if (m->contexts[i] == context) return m->normalized[i];
+	} //end for
+	i = m->nextcontext;
+	m->nextcontext = (m->nextcontext + 1) % MAX_MESSAGE_CONTEXTS;
+	if (m->numcontexts < MAX_MESSAGE_CONTEXTS) m->numcontexts++;
+	m->contexts[i] = context;
+	Q_strncpyz(m->normalized[i], m->unified, sizeof(m->normalized[i]));
+	BotReplaceSynonymWords(m->normalized[i] + m->unifiedoffset,
+			sizeof(m->normalized[i]) - m->unifiedoffset, context, SYNMODE_NORMAL);
+	return m->normalized[i];
+} //end of the function BotNormalizedConsoleMessage
+//===========================================================================
 //
 // Parameter:				-
 // Returns:					-
@@ -3050,6 +3539,7 @@ int BotAllocChatState(void)
 		if (!botchatstates[i])
 		{
 			botchatstates[i] = GetClearedMemory(sizeof(bot_chatstate_t));
+			botchatstates[i]->consolemessagecursor = consolemessagesequence;
 			return i;
 		} //end if
 	} //end for
@@ -3063,8 +3553,7 @@ int BotAllocChatState(void)
 //========================================================================
 void BotFreeChatState(int handle)
 {
-	bot_consolemessage_t m;
-	int h;
+	bot_consolemessage_t *m;
 
 	if (handle <= 0 || handle > MAX_CLIENTS)
 	{
@@ -3081,10 +3570,10 @@ void BotFreeChatState(int handle)
 		BotFreeChatFile(handle);
 	} //end if
 	//free all the console messages left in the chat state
-	for (h = BotNextConsoleMessage(handle, &m); h; h = BotNextConsoleMessage(handle, &m))
+	for (m = BotPeekConsoleMessage(handle); m; m = BotPeekConsoleMessage(handle))
 	{
 		//remove the console message
-		BotRemoveConsoleMessage(handle, h);
+		BotRemoveConsoleMessage(handle, m->handle);
 	} //end for
 	FreeMemory(botchatstates[handle]);
 	botchatstates[handle] = NULL;
@@ -3104,13 +3593,14 @@ int BotSetupChatAI(void)
 	synonyms = BotLoadSynonyms("syn.c");
 	randomstrings = BotLoadRandomStrings("rnd.c");
 	matchtemplates = BotLoadMatchTemplates("match.c");
+	BotCompileMatchTemplates(matchtemplates);
 	//
 	if (!bot_nochat.integer)
 	{
 		replychats = BotLoadReplyChat("rchat.c");
 	} //end if
 
-	InitConsoleMessageHeap();
+	InitConsoleMessageRing();
 
 #ifdef DEBUG
 	BotAI_Print(PRT_MESSAGE, "setup chat AI %d msec\n", botimport.MilliSeconds() - starttime);
@@ -3145,15 +3635,15 @@ void BotShutdownChatAI(void)
 			ichatdata[i] = NULL;
 		} //end if
 	} //end for
-	Com_Memset( &consolemessageheap, 0, sizeof ( consolemessageheap ) );
-	activeconsolemessages = NULL;
-	freeconsolemessages = NULL;
+	InitConsoleMessageRing();
 	if (matchtemplates) BotFreeMatchTemplates(matchtemplates);
 	matchtemplates = NULL;
+	BotFreeMatchAutomaton();
 	if (randomstrings) FreeMemory(randomstrings);
 	randomstrings = NULL;
 	if (synonyms) FreeMemory(synonyms);
 	synonyms = NULL;
+	BotFreeSynonymTables();
 	if (replychats) BotFreeReplyChat(replychats);
 	replychats = NULL;
 } //end of the function BotShutdownChatAI
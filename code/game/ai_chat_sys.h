@@ -60,8 +60,6 @@ typedef struct bot_consolemessage_s
 	float time;									//message time
 	int type;									//message type
 	char message[MAX_MESSAGE_SIZE];				//message
-	struct bot_consolemessage_s *prev, *next;	//prev and next in list
-	int references;								//references to this message
 } bot_consolemessage_t;
 
 //match variable
@@ -93,8 +91,12 @@ void BotQueueConsoleMessage(int chatstate, int type, char *message);
 void BotRemoveConsoleMessage(int chatstate, int handle);
 //returns the next console message from the state
 int BotNextConsoleMessage(int chatstate, bot_consolemessage_t *cm);
+//returns the next console message from the state without copying it
+bot_consolemessage_t *BotPeekConsoleMessage(int chatstate);
 //returns the number of console messages currently stored in the state
 int BotNumConsoleMessages(int chatstate);
+//returns the console message with unified white spaces and context related synonyms replaced
+char *BotNormalizedConsoleMessage(int handle, unsigned long int context);
 //selects a chat message of the given type
 void BotInitialChat(int chatstate, char *type, int mcontext, char *var0, char *var1, char *var2, char *var3, char *var4, char *var5, char *var6, char *var7);
 //returns the number of initial chat messages of the given type
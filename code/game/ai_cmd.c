@@ -1561,14 +1561,14 @@ void BotMatch_WhereAreYou(bot_state_t *bs, bot_match_t *match) {
 			) {
 #ifdef MISSIONPACK
 			if (gametype == GT_OBELISK || gametype == GT_HARVESTER) {
-				redtt = trap_AAS_AreaTravelTimeToGoalArea(bs->areanum, bs->origin, redobelisk.areanum, TFL_DEFAULT);
-				bluett = trap_AAS_AreaTravelTimeToGoalArea(bs->areanum, bs->origin, blueobelisk.areanum, TFL_DEFAULT);
+				redtt = BotPlayerTravelTimeToGoal(bs->playernum, &redobelisk);
+				bluett = BotPlayerTravelTimeToGoal(bs->playernum, &blueobelisk);
 			}
 			else
 #endif
 			{
-				redtt = trap_AAS_AreaTravelTimeToGoalArea(bs->areanum, bs->origin, ctf_redflag.areanum, TFL_DEFAULT);
-				bluett = trap_AAS_AreaTravelTimeToGoalArea(bs->areanum, bs->origin, ctf_blueflag.areanum, TFL_DEFAULT);
+				redtt = BotPlayerTravelTimeToGoal(bs->playernum, &ctf_redflag);
+				bluett = BotPlayerTravelTimeToGoal(bs->playernum, &ctf_blueflag);
 			}
 
 			// unpatched q3 used 'ctflocation', some games still use it
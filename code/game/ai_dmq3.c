@@ -2979,7 +2979,7 @@ float BotEntityVisible(int viewer, vec3_t eye, vec3_t viewangles, float fov, int
 			contents_mask ^= (CONTENTS_LAVA|CONTENTS_SLIME|CONTENTS_WATER);
 		}
 		//trace from start to end
-		BotAI_Trace(&trace, start, NULL, NULL, end, passent, contents_mask);
+		G_TraceCached(TRACE_BOT_VISIBLE, &trace, start, NULL, NULL, end, passent, contents_mask);
 		//if water was hit
 		waterfactor = 1.0;
 #if 0 // FIXME?: bsp_trace_t::contents was always 0 in quake3, now it's actually set
@@ -2988,7 +2988,7 @@ float BotEntityVisible(int viewer, vec3_t eye, vec3_t viewangles, float fov, int
 			if (1) {
 				//trace through the water
 				contents_mask &= ~(CONTENTS_LAVA|CONTENTS_SLIME|CONTENTS_WATER);
-				BotAI_Trace(&trace, trace.endpos, NULL, NULL, end, passent, contents_mask);
+				G_TraceCached(TRACE_BOT_VISIBLE, &trace, trace.endpos, NULL, NULL, end, passent, contents_mask);
 				waterfactor = 0.5;
 			}
 		}
@@ -3004,13 +3004,13 @@ float BotEntityVisible(int viewer, vec3_t eye, vec3_t viewangles, float fov, int
 			}
 			else if (infog) {
 				VectorCopy(trace.endpos, start);
-				BotAI_Trace(&trace, start, NULL, NULL, eye, viewer, CONTENTS_FOG);
+				G_TraceCached(TRACE_BOT_VISIBLE, &trace, start, NULL, NULL, eye, viewer, CONTENTS_FOG);
 				VectorSubtract(eye, trace.endpos, dir);
 				squaredfogdist = VectorLengthSquared(dir);
 			}
 			else if (otherinfog) {
 				VectorCopy(trace.endpos, end);
-				BotAI_Trace(&trace, eye, NULL, NULL, end, viewer, CONTENTS_FOG);
+				G_TraceCached(TRACE_BOT_VISIBLE, &trace, eye, NULL, NULL, end, viewer, CONTENTS_FOG);
 				VectorSubtract(end, trace.endpos, dir);
 				squaredfogdist = VectorLengthSquared(dir);
 			}
@@ -4956,39 +4956,33 @@ void BotCheckConsoleMessages(bot_state_t *bs) {
 	char botname[MAX_NETNAME], message[MAX_MESSAGE_SIZE], netname[MAX_NETNAME], *ptr;
 	float chat_reply;
 	int context, handle;
-	bot_consolemessage_t m;
+	bot_consolemessage_t *m;
 	bot_match_t match;
 
 	//the name of this bot
 	PlayerName(bs->playernum, botname, sizeof(botname));
 	//
-	while((handle = BotNextConsoleMessage(bs->cs, &m)) != 0) {
+	while((m = BotPeekConsoleMessage(bs->cs)) != NULL) {
+		handle = m->handle;
 		//if the chat state is flooded with messages the bot will read them quickly
 		if (BotNumConsoleMessages(bs->cs) < 10) {
 			//if it is a chat message the bot needs some time to read it
-			if (m.type == CMS_CHAT && m.time > FloatTime() - (1 + random())) break;
+			if (m->type == CMS_CHAT && m->time > FloatTime() - (1 + random())) break;
 		}
-		//
-		ptr = m.message;
-		//if it is a chat message then don't unify white spaces and don't
-		//replace synonyms in the netname
-		if (m.type == CMS_CHAT) {
-			//
-			if (BotFindMatch(m.message, &match, MTCONTEXT_REPLYCHAT)) {
-				ptr = m.message + match.variables[MESSAGE].offset;
-			}
-		}
-		//unify the white spaces in the message
-		UnifyWhiteSpaces(ptr);
-		//replace synonyms in the right context
+		//unify the white spaces and replace synonyms in the right context,
+		//the normalized message is shared with all other bots
 		context = BotSynonymContext(bs);
-		BotReplaceSynonyms(ptr, context);
+		ptr = BotNormalizedConsoleMessage(handle, context);
+		if (!ptr) {
+			BotRemoveConsoleMessage(bs->cs, handle);
+			continue;
+		}
 		//if there's no match
-		if (!BotMatchMessage(bs, m.message)) {
+		if (!BotMatchMessage(bs, ptr)) {
 			//if it is a chat message
-			if (m.type == CMS_CHAT && !bot_nochat.integer) {
+			if (m->type == CMS_CHAT && !bot_nochat.integer) {
 				//
-				if (!BotFindMatch(m.message, &match, MTCONTEXT_REPLYCHAT)) {
+				if (!BotFindMatch(ptr, &match, MTCONTEXT_REPLYCHAT)) {
 					BotRemoveConsoleMessage(bs->cs, handle);
 					continue;
 				}
@@ -5731,20 +5725,13 @@ BotSetEntityNumForGoal
 */
 void BotSetEntityNumForGoal(bot_goal_t *goal, char *classname) {
 	gentity_t *ent;
-	int i;
 	vec3_t dir;
 
-	ent = &g_entities[0];
-	for (i = 0; i < level.num_entities; i++, ent++) {
-		if ( !ent->inuse ) {
-			continue;
-		}
-		if ( Q_stricmp(ent->classname, classname) != 0 ) {
-			continue;
-		}
+	ent = NULL;
+	while ((ent = G_Find(ent, FOFS(classname), classname)) != NULL) {
 		VectorSubtract(goal->origin, ent->s.origin, dir);
 		if (VectorLengthSquared(dir) < Square(10)) {
-			goal->entitynum = i;
+			goal->entitynum = ent - g_entities;
 			return;
 		}
 	}
@@ -5831,6 +5818,7 @@ void BotSetupDeathmatchAI(void) {
 	trap_Cvar_Register(&bot_droppedweight, "bot_droppedweight", "1000", 0);
 	trap_Cvar_Register(&g_spSkill, "g_spSkill", "2", 0);
 	//
+	BotClearKeyGoals();
 	if (gametype == GT_CTF) {
 		if (BotGetLevelItemGoal(-1, "Red Flag", &ctf_redflag) < 0)
 			BotAI_Print(PRT_WARNING, "CTF without Red Flag\n");
@@ -5866,6 +5854,19 @@ void BotSetupDeathmatchAI(void) {
 		BotSetEntityNumForGoalWithActivator(&neutralobelisk, "team_neutralobelisk");
 	}
 #endif
+	//travel times to the bases are shared by all bots
+#ifdef MISSIONPACK
+	if (gametype == GT_OBELISK || gametype == GT_HARVESTER) {
+		BotRegisterKeyGoal(&redobelisk);
+		BotRegisterKeyGoal(&blueobelisk);
+	}
+	else if (gametype == GT_CTF || gametype == GT_1FCTF) {
+#else
+	if (gametype == GT_CTF) {
+#endif
+		BotRegisterKeyGoal(&ctf_redflag);
+		BotRegisterKeyGoal(&ctf_blueflag);
+	}
 
 	max_bspmodelindex = 0;
 	for (ent = trap_AAS_NextBSPEntity(0); ent; ent = trap_AAS_NextBSPEntity(ent)) {
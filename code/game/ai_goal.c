@@ -82,6 +82,12 @@ Suite 120, Rockville, Maryland 20850 USA.
 #define IFL_NOTSINGLE			4		//not in single player
 #define IFL_NOTBOT				8		//bot should never go for this
 #define IFL_ROAM				16		//bot roam goal
+//level item grid
+#define ITEMGRID_CELLSIZE		512
+#define ITEMGRID_HASHSIZE		256
+//units per hundredth of a second covered by walking through an area, twice
+//the walk speed because area travel times are truncated to whole hundredths
+#define NBG_WALKSPEED			(2 * 100.0f / 33)
 
 //camp spots "info_camp"
 typedef struct campspot_s
@@ -108,6 +114,10 @@ typedef struct levelitem_s
 	int entitynum;						//entity number
 	float timeout;						//item is removed after this time
 	struct levelitem_s *prev, *next;
+	int cell;							//hash of the grid cell the item is in
+	struct levelitem_s *cellprev, *cellnext;	//level items in the same grid cell
+	struct levelitem_s *infoprev, *infonext;	//level items with the same item info
+	struct levelitem_s *timeoutprev, *timeoutnext;	//level items that time out
 } levelitem_t;
 
 typedef struct iteminfo_s
@@ -159,6 +169,19 @@ levelitem_t *levelitemheap = NULL;
 levelitem_t *freelevelitems = NULL;
 levelitem_t *levelitems = NULL;
 int numlevelitems = 0;
+//level items per grid cell, item info, entity and those that time out
+levelitem_t *levelitemgrid[ITEMGRID_HASHSIZE];
+levelitem_t *iteminfolevelitems[MAX_ITEMS];
+levelitem_t *entitylevelitems[MAX_GENTITIES];
+levelitem_t *timeoutlevelitems = NULL;
+//fastest straight line speed over any route, negative if there's no bound
+float levelitemmaxspeed = -1;
+//largest distance between a level item and a point in its goal area
+float levelitemmaxslack = 0;
+//item entities that changed and need to be checked by BotUpdateEntityItems
+int pendingitementities[MAX_GENTITIES];
+int numpendingitementities = 0;
+byte itementitypending[MAX_GENTITIES];
 //camp spots
 campspot_t *campspots = NULL;
 
@@ -380,12 +403,104 @@ void FreeLevelItem(levelitem_t *li)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
+int LevelItemGridHash(int x, int y)
+{
+	return ((x * 73856093) ^ (y * 19349663)) & (ITEMGRID_HASHSIZE - 1);
+} //end of the function LevelItemGridHash
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void LinkLevelItemToGrid(levelitem_t *li)
+{
+	aas_areainfo_t areainfo;
+	vec3_t corner;
+	float slack;
+	int i;
+
+	//a route to the item ends where it enters the goal area
+	if (li->goalareanum > 0 && trap_AAS_AreaInfo(li->goalareanum, &areainfo))
+	{
+		for (i = 0; i < 3; i++)
+		{
+			if (li->origin[i] - areainfo.mins[i] > areainfo.maxs[i] - li->origin[i])
+				corner[i] = li->origin[i] - areainfo.mins[i];
+			else
+				corner[i] = areainfo.maxs[i] - li->origin[i];
+		} //end for
+		slack = VectorLength(corner);
+		if (slack > levelitemmaxslack) levelitemmaxslack = slack;
+	} //end if
+	//
+	li->cell = LevelItemGridHash((int) floor(li->origin[0] / ITEMGRID_CELLSIZE),
+									(int) floor(li->origin[1] / ITEMGRID_CELLSIZE));
+	if (levelitemgrid[li->cell]) levelitemgrid[li->cell]->cellprev = li;
+	li->cellprev = NULL;
+	li->cellnext = levelitemgrid[li->cell];
+	levelitemgrid[li->cell] = li;
+} //end of the function LinkLevelItemToGrid
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void UnlinkLevelItemFromGrid(levelitem_t *li)
+{
+	if (li->cellprev) li->cellprev->cellnext = li->cellnext;
+	else levelitemgrid[li->cell] = li->cellnext;
+	if (li->cellnext) li->cellnext->cellprev = li->cellprev;
+} //end of the function UnlinkLevelItemFromGrid
+//===========================================================================
+// the origin of the level item changed
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void MoveLevelItem(levelitem_t *li, vec3_t origin)
+{
+	itemconfig_t *ic = itemconfig;
+
+	UnlinkLevelItemFromGrid(li);
+	VectorCopy(origin, li->origin);
+	//also update the goal area number
+	li->goalareanum = trap_AAS_BestReachableArea(li->origin,
+					ic->iteminfo[li->iteminfo].mins, ic->iteminfo[li->iteminfo].maxs,
+					li->goalorigin);
+	LinkLevelItemToGrid(li);
+} //end of the function MoveLevelItem
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
 void AddLevelItemToList(levelitem_t *li)
 {
 	if (levelitems) levelitems->prev = li;
 	li->prev = NULL;
 	li->next = levelitems;
 	levelitems = li;
+	//
+	LinkLevelItemToGrid(li);
+	//
+	if (iteminfolevelitems[li->iteminfo]) iteminfolevelitems[li->iteminfo]->infoprev = li;
+	li->infoprev = NULL;
+	li->infonext = iteminfolevelitems[li->iteminfo];
+	iteminfolevelitems[li->iteminfo] = li;
+	//
+	if (li->timeout)
+	{
+		if (timeoutlevelitems) timeoutlevelitems->timeoutprev = li;
+		li->timeoutprev = NULL;
+		li->timeoutnext = timeoutlevelitems;
+		timeoutlevelitems = li;
+	} //end if
+	//
+	if (li->entitynum) entitylevelitems[li->entitynum] = li;
 } //end of the function AddLevelItemToList
 //===========================================================================
 //
@@ -398,8 +513,125 @@ void RemoveLevelItemFromList(levelitem_t *li)
 	if (li->prev) li->prev->next = li->next;
 	else levelitems = li->next;
 	if (li->next) li->next->prev = li->prev;
+	//
+	UnlinkLevelItemFromGrid(li);
+	//
+	if (li->infoprev) li->infoprev->infonext = li->infonext;
+	else iteminfolevelitems[li->iteminfo] = li->infonext;
+	if (li->infonext) li->infonext->infoprev = li->infoprev;
+	//
+	if (li->timeout)
+	{
+		if (li->timeoutprev) li->timeoutprev->timeoutnext = li->timeoutnext;
+		else timeoutlevelitems = li->timeoutnext;
+		if (li->timeoutnext) li->timeoutnext->timeoutprev = li->timeoutprev;
+	} //end if
+	//
+	if (li->entitynum && entitylevelitems[li->entitynum] == li)
+	{
+		entitylevelitems[li->entitynum] = NULL;
+	} //end if
 } //end of the function RemoveLevelItemFromList
 //===========================================================================
+// calculates an upper bound for the straight line speed of the bots, the
+// travel time of every route is the sum of area and reachability travel
+// times, so no route is faster than the fastest of these
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotInitLevelItemMaxSpeed(void)
+{
+	aas_reachability_t reach;
+	vec3_t dir;
+	float speed;
+	int reachnum;
+
+	levelitemmaxspeed = NBG_WALKSPEED;
+	//reachability zero is never used
+	for (reachnum = 1; ; reachnum++)
+	{
+		trap_AAS_ReachabilityFromNum(reachnum, &reach);
+		if (!reach.areanum) break;
+		VectorSubtract(reach.end, reach.start, dir);
+		//teleporters and the like can cover any distance
+		if (reach.traveltime <= 0)
+		{
+			levelitemmaxspeed = -1;
+			return;
+		} //end if
+		speed = VectorLength(dir) / reach.traveltime;
+		if (speed > levelitemmaxspeed) levelitemmaxspeed = speed;
+	} //end for
+} //end of the function BotInitLevelItemMaxSpeed
+//===========================================================================
+// stores the level items within the radius around the origin in the
+// list, returns the number of level items stored
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int BotNearbyLevelItems(vec3_t origin, float radius, levelitem_t **list, int maxitems)
+{
+	int x, y, minx, miny, maxx, maxy, cell, numitems, numcells;
+	byte visitedcells[ITEMGRID_HASHSIZE];
+	levelitem_t *li;
+	vec3_t dir;
+
+	numitems = 0;
+	//a negative or huge radius covers all items
+	if (radius < 0 || radius > ITEMGRID_CELLSIZE * ITEMGRID_HASHSIZE) radius = ITEMGRID_CELLSIZE * ITEMGRID_HASHSIZE;
+	minx = (int) floor((origin[0] - radius) / ITEMGRID_CELLSIZE);
+	maxx = (int) floor((origin[0] + radius) / ITEMGRID_CELLSIZE);
+	miny = (int) floor((origin[1] - radius) / ITEMGRID_CELLSIZE);
+	maxy = (int) floor((origin[1] + radius) / ITEMGRID_CELLSIZE);
+	numcells = (maxx - minx + 1) * (maxy - miny + 1);
+	//if the radius covers more cells than there are buckets go through all items
+	if (numcells <= 0 || numcells > ITEMGRID_HASHSIZE)
+	{
+		for (li = levelitems; li && numitems < maxitems; li = li->next)
+		{
+			list[numitems++] = li;
+		} //end for
+		return numitems;
+	} //end if
+	Com_Memset(visitedcells, 0, sizeof(visitedcells));
+	for (x = minx; x <= maxx; x++)
+	{
+		for (y = miny; y <= maxy; y++)
+		{
+			cell = LevelItemGridHash(x, y);
+			//different cells can end up in the same bucket
+			if (visitedcells[cell]) continue;
+			visitedcells[cell] = qtrue;
+			for (li = levelitemgrid[cell]; li; li = li->cellnext)
+			{
+				VectorSubtract(li->origin, origin, dir);
+				if (VectorLengthSquared(dir) > radius * radius) continue;
+				if (numitems >= maxitems) return numitems;
+				list[numitems++] = li;
+			} //end for
+		} //end for
+	} //end for
+	return numitems;
+} //end of the function BotNearbyLevelItems
+//===========================================================================
+// the item entity needs to be checked by BotUpdateEntityItems
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotMarkItemEntity(int entnum)
+{
+	if (entnum <= 0 || entnum >= MAX_GENTITIES) return;
+	if (itementitypending[entnum]) return;
+	itementitypending[entnum] = qtrue;
+	pendingitementities[numpendingitementities++] = entnum;
+} //end of the function BotMarkItemEntity
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -474,9 +706,9 @@ void BotUnlinkSolidItems(qboolean unlink) {
 		if ( ent->s.eType == ET_GENERAL && ent->activator && ent->activator->s.eType == ET_TEAM
 			&& ( !Q_stricmp( ent->activator->classname, "team_blueobelisk" ) || !Q_stricmp( ent->activator->classname, "team_redobelisk" ) ) ) {
 			if ( unlink ) {
-				trap_UnlinkEntity( ent );
+				G_UnlinkEntity( ent );
 			} else {
-				trap_LinkEntity( ent );
+				G_LinkEntity( ent );
 			}
 		}
 	}
@@ -505,12 +737,26 @@ void BotInitLevelItems(void)
 	InitLevelItemHeap();
 	levelitems = NULL;
 	numlevelitems = 0;
+	Com_Memset(levelitemgrid, 0, sizeof(levelitemgrid));
+	Com_Memset(iteminfolevelitems, 0, sizeof(iteminfolevelitems));
+	Com_Memset(entitylevelitems, 0, sizeof(entitylevelitems));
+	timeoutlevelitems = NULL;
+	//check all the item entities once
+	Com_Memset(itementitypending, 0, sizeof(itementitypending));
+	numpendingitementities = 0;
+	for (ent = 0; ent < level.num_entities; ent++)
+	{
+		if (g_entities[ent].inuse && g_entities[ent].s.eType == ET_ITEM) BotMarkItemEntity(ent);
+	} //end for
 	//
 	ic = itemconfig;
 	if (!ic) return;
 
 	//if there's no AAS file loaded
 	if (!trap_AAS_Loaded()) return;
+	//bound the distance bots can travel in a given time
+	BotInitLevelItemMaxSpeed();
+	levelitemmaxslack = 0;
 
 #ifdef MISSIONPACK
 	//unlink solid items
@@ -558,7 +804,7 @@ void BotInitLevelItems(void)
 			{
 				VectorCopy(origin, end);
 				end[2] -= 32;
-				trap_Trace(&trace, origin, ic->iteminfo[i].mins, ic->iteminfo[i].maxs, end, -1, CONTENTS_SOLID|CONTENTS_PLAYERCLIP);
+				G_Trace(TRACE_BOT_GOAL, &trace, origin, ic->iteminfo[i].mins, ic->iteminfo[i].maxs, end, -1, CONTENTS_SOLID|CONTENTS_PLAYERCLIP);
 				//if the item not near the ground
 				if (trace.fraction >= 1)
 				{
@@ -969,94 +1215,72 @@ void BotFindEntityForLevelItem(levelitem_t *li)
 			{
 				//found an entity for this level item
 				li->entitynum = ent;
+				entitylevelitems[ent] = li;
 			} //end if
 		} //end if
 	} //end for
 } //end of the function BotFindEntityForLevelItem
 #endif
 //===========================================================================
+// links the item entity to a level item, returns qtrue if the entity is
+// still moving and should be checked again later
 //
 // Parameter:			-
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-void BotUpdateEntityItems(void)
+int BotUpdateEntityItem(int ent)
 {
-	int ent, i, modelindex;
+	int i, modelindex;
 	vec3_t dir;
-	levelitem_t *li, *nextli;
+	levelitem_t *li;
 	aas_entityinfo_t entinfo;
 	itemconfig_t *ic;
 
-	//timeout current entity items if necessary
-	for (li = levelitems; li; li = nextli)
-	{
-		nextli = li->next;
-		//if it is an item that will time out
-		if (li->timeout)
-		{
-			//timeout the item
-			if (li->timeout < trap_AAS_Time())
-			{
-				RemoveLevelItemFromList(li);
-				FreeLevelItem(li);
-			} //end if
-		} //end if
-	} //end for
-	//find new entity items
 	ic = itemconfig;
-	if (!itemconfig) return;
+	if (ent >= level.num_entities) return qfalse;
+	if (!g_entities[ent].botvalid) return qfalse;
+	if (g_entities[ent].s.eType != ET_ITEM) return qfalse;
+	//get the model index of the entity
+	modelindex = g_entities[ent].s.modelindex;
 	//
-	for (ent = BotNextEntity(0); ent; ent = BotNextEntity(ent))
+	if (!modelindex) return qfalse;
+	//get info about the entity
+	BotEntityInfo(ent, &entinfo);
+	//FIXME: don't do this
+	//skip all floating items for now
+	//if (entinfo.groundent != ENTITYNUM_WORLD) continue;
+	//if the entity is still moving
+	if (entinfo.origin[0] != entinfo.lastvisorigin[0] ||
+			entinfo.origin[1] != entinfo.lastvisorigin[1] ||
+			entinfo.origin[2] != entinfo.lastvisorigin[2]) return qtrue;
+	//check if the entity is already stored as a level item
+	li = entitylevelitems[ent];
+	if (li)
 	{
-		if (g_entities[ent].s.eType != ET_ITEM) continue;
-		//get the model index of the entity
-		modelindex = g_entities[ent].s.modelindex;
-		//
-		if (!modelindex) continue;
-		//get info about the entity
-		BotEntityInfo(ent, &entinfo);
-		//FIXME: don't do this
-		//skip all floating items for now
-		//if (entinfo.groundent != ENTITYNUM_WORLD) continue;
-		//if the entity is still moving
-		if (entinfo.origin[0] != entinfo.lastvisorigin[0] ||
-				entinfo.origin[1] != entinfo.lastvisorigin[1] ||
-				entinfo.origin[2] != entinfo.lastvisorigin[2]) continue;
-		//check if the entity is already stored as a level item
-		for (li = levelitems; li; li = li->next)
+		//the entity is re-used if the models are different
+		if (ic->iteminfo[li->iteminfo].modelindex != modelindex)
+		{
+			//remove this level item
+			RemoveLevelItemFromList(li);
+			FreeLevelItem(li);
+		} //end if
+		else
 		{
-			//if the level item is linked to an entity
-			if (li->entitynum && li->entitynum == ent)
+			if (entinfo.origin[0] != li->origin[0] ||
+				entinfo.origin[1] != li->origin[1] ||
+				entinfo.origin[2] != li->origin[2])
 			{
-				//the entity is re-used if the models are different
-				if (ic->iteminfo[li->iteminfo].modelindex != modelindex)
-				{
-					//remove this level item
-					RemoveLevelItemFromList(li);
-					FreeLevelItem(li);
-					li = NULL;
-					break;
-				} //end if
-				else
-				{
-					if (entinfo.origin[0] != li->origin[0] ||
-						entinfo.origin[1] != li->origin[1] ||
-						entinfo.origin[2] != li->origin[2])
-					{
-						VectorCopy(entinfo.origin, li->origin);
-						//also update the goal area number
-						li->goalareanum = trap_AAS_BestReachableArea(li->origin,
-										ic->iteminfo[li->iteminfo].mins, ic->iteminfo[li->iteminfo].maxs,
-										li->goalorigin);
-					} //end if
-					break;
-				} //end else
+				MoveLevelItem(li, entinfo.origin);
 			} //end if
-		} //end for
-		if (li) continue;
-		//try to link the entity to a level item
-		for (li = levelitems; li; li = li->next)
+			return qfalse;
+		} //end else
+	} //end if
+	//try to link the entity to a level item with the same model
+	for (i = 0; i < ic->numiteminfo; i++)
+	{
+		if (ic->iteminfo[i].modelindex != modelindex) continue;
+		for (li = iteminfolevelitems[i]; li; li = li->infonext)
 		{
 			//if this level item is already linked
 			if (li->entitynum) continue;
@@ -1070,80 +1294,105 @@ void BotUpdateEntityItems(void)
 			else {
 				if (li->flags & IFL_NOTFREE) continue;
 			}
-			//if the model of the level item and the entity are the same
-			if (ic->iteminfo[li->iteminfo].modelindex == modelindex)
+			//check if the entity is very close
+			VectorSubtract(li->origin, entinfo.origin, dir);
+			if (VectorLength(dir) < 30)
 			{
-				//check if the entity is very close
-				VectorSubtract(li->origin, entinfo.origin, dir);
-				if (VectorLength(dir) < 30)
+				//found an entity for this level item
+				li->entitynum = ent;
+				entitylevelitems[ent] = li;
+				//if the origin is different
+				if (entinfo.origin[0] != li->origin[0] ||
+					entinfo.origin[1] != li->origin[1] ||
+					entinfo.origin[2] != li->origin[2])
 				{
-					//found an entity for this level item
-					li->entitynum = ent;
-					//if the origin is different
-					if (entinfo.origin[0] != li->origin[0] ||
-						entinfo.origin[1] != li->origin[1] ||
-						entinfo.origin[2] != li->origin[2])
-					{
-						//update the level item origin
-						VectorCopy(entinfo.origin, li->origin);
-						//also update the goal area number
-						li->goalareanum = trap_AAS_BestReachableArea(li->origin,
-										ic->iteminfo[li->iteminfo].mins, ic->iteminfo[li->iteminfo].maxs,
-										li->goalorigin);
-					} //end if
-					//BotAI_Print(PRT_DEVELOPER, "linked item %s to an entity\n", ic->iteminfo[li->iteminfo].classname);
-					break;
+					//update the level item origin
+					MoveLevelItem(li, entinfo.origin);
 				} //end if
-			} //end else
-		} //end for
-		if (li) continue;
-		//check if the model is from a known item
-		for (i = 0; i < ic->numiteminfo; i++)
-		{
-			if (ic->iteminfo[i].modelindex == modelindex)
-			{
-				break;
+				//BotAI_Print(PRT_DEVELOPER, "linked item %s to an entity\n", ic->iteminfo[li->iteminfo].classname);
+				return qfalse;
 			} //end if
 		} //end for
-		//if the model is not from a known item
-		if (i >= ic->numiteminfo) continue;
-		//allocate a new level item
-		li = AllocLevelItem();
-		//
-		if (!li) continue;
-		//entity number of the level item
-		li->entitynum = ent;
-		//number for the level item
-		li->number = numlevelitems + ent;
-		//set the item info index for the level item
-		li->iteminfo = i;
-		//origin of the item
-		VectorCopy(entinfo.origin, li->origin);
-		//get the item goal area and goal origin
-		li->goalareanum = trap_AAS_BestReachableArea(li->origin,
-									ic->iteminfo[i].mins, ic->iteminfo[i].maxs,
-									li->goalorigin);
-		//never go for items dropped into jumppads
-		if (trap_AAS_AreaJumpPad(li->goalareanum))
+	} //end for
+	//check if the model is from a known item
+	for (i = 0; i < ic->numiteminfo; i++)
+	{
+		if (ic->iteminfo[i].modelindex == modelindex)
+		{
+			break;
+		} //end if
+	} //end for
+	//if the model is not from a known item
+	if (i >= ic->numiteminfo) return qfalse;
+	//allocate a new level item
+	li = AllocLevelItem();
+	//
+	if (!li) return qfalse;
+	//entity number of the level item
+	li->entitynum = ent;
+	//number for the level item
+	li->number = numlevelitems + ent;
+	//set the item info index for the level item
+	li->iteminfo = i;
+	//origin of the item
+	VectorCopy(entinfo.origin, li->origin);
+	//get the item goal area and goal origin
+	li->goalareanum = trap_AAS_BestReachableArea(li->origin,
+								ic->iteminfo[i].mins, ic->iteminfo[i].maxs,
+								li->goalorigin);
+	//never go for items dropped into jumppads
+	if (trap_AAS_AreaJumpPad(li->goalareanum))
+	{
+		FreeLevelItem(li);
+		return qfalse;
+	} //end if
+	//time this item out after 30 seconds
+	//dropped items disappear after 30 seconds
+	li->timeout = trap_AAS_Time() + 30;
+	//add the level item to the list
+	AddLevelItemToList(li);
+	//BotAI_Print(PRT_MESSAGE, "found new level item %s\n", ic->iteminfo[i].classname);
+	return qfalse;
+} //end of the function BotUpdateEntityItem
+//===========================================================================
+// only the item entities that appeared or moved since the last update
+// are checked, see BotMarkItemEntity
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void BotUpdateEntityItems(void)
+{
+	int i, ent;
+	levelitem_t *li, *nextli;
+
+	//timeout current entity items if necessary
+	for (li = timeoutlevelitems; li; li = nextli)
+	{
+		nextli = li->timeoutnext;
+		//timeout the item
+		if (li->timeout < trap_AAS_Time())
 		{
+			RemoveLevelItemFromList(li);
 			FreeLevelItem(li);
-			continue;
 		} //end if
-		//time this item out after 30 seconds
-		//dropped items disappear after 30 seconds
-		li->timeout = trap_AAS_Time() + 30;
-		//add the level item to the list
-		AddLevelItemToList(li);
-		//BotAI_Print(PRT_MESSAGE, "found new level item %s\n", ic->iteminfo[i].classname);
 	} //end for
-	/*
-	for (li = levelitems; li; li = li->next)
+	//find new entity items
+	if (!itemconfig) return;
+	//
+	for (i = 0; i < numpendingitementities; )
 	{
-		if (!li->entitynum)
+		ent = pendingitementities[i];
+		//keep moving items until they come to rest
+		if (BotUpdateEntityItem(ent))
 		{
-			BotFindEntityForLevelItem(li);
+			i++;
+			continue;
 		} //end if
-	} //end for*/
+		itementitypending[ent] = qfalse;
+		pendingitementities[i] = pendingitementities[--numpendingitementities];
+	} //end for
 } //end of the function BotUpdateEntityItems
 //===========================================================================
 //
@@ -1421,11 +1670,11 @@ int BotChooseLTGItem(int goalstate, vec3_t origin, int *inventory, int travelfla
 int BotChooseNBGItem(int goalstate, vec3_t origin, int *inventory, int travelflags,
 														bot_goal_t *ltg, float maxtime)
 {
-	int areanum, t, weightnum, ltg_time;
-	float weight, bestweight, avoidtime;
+	int areanum, t, weightnum, ltg_time, i, numnearbyitems;
+	float weight, bestweight, avoidtime, radius;
 	iteminfo_t *iteminfo;
 	itemconfig_t *ic;
-	levelitem_t *li, *bestitem;
+	levelitem_t *li, *bestitem, *nearbyitems[MAX_ITEMS];
 	bot_goal_t goal;
 	bot_goalstate_t *gs;
 
@@ -1458,9 +1707,15 @@ int BotChooseNBGItem(int goalstate, vec3_t origin, int *inventory, int travelfla
 	bestweight = 0;
 	bestitem = NULL;
 	Com_Memset(&goal, 0, sizeof(bot_goal_t));
-	//go through the items in the level
-	for (li = levelitems; li; li = li->next)
+	//only the items that could be reached within the max time, the radius
+	//is an upper bound so no item reachable in time is skipped
+	if (levelitemmaxspeed < 0) radius = -1;
+	else radius = maxtime * levelitemmaxspeed + levelitemmaxslack;
+	numnearbyitems = BotNearbyLevelItems(origin, radius, nearbyitems, MAX_ITEMS);
+	//go through the nearby items
+	for (i = 0; i < numnearbyitems; i++)
 	{
+		li = nearbyitems[i];
 		if (g_gametype.integer == GT_SINGLE_PLAYER) {
 			if (li->flags & IFL_NOTSINGLE)
 				continue;
@@ -1616,7 +1871,7 @@ int BotItemGoalInVisButNotVisible(int viewer, vec3_t eye, vec3_t viewangles, bot
 	VectorScale(middle, 0.5, middle);
 	VectorAdd(goal->origin, middle, middle);
 	//
-	trap_Trace(&trace, eye, NULL, NULL, middle, viewer, CONTENTS_SOLID);
+	G_Trace(TRACE_BOT_GOAL, &trace, eye, NULL, NULL, middle, viewer, CONTENTS_SOLID);
 	//if the goal middle point is visible
 	if (trace.fraction >= 1)
 	{
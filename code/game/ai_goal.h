@@ -123,6 +123,8 @@ void BotSetAvoidGoalTime(int goalstate, int number, float avoidtime);
 void BotInitLevelItems(void);
 //regularly update dynamic entity items (dropped weapons, flags etc.)
 void BotUpdateEntityItems(void);
+//marks an item entity to be checked by the next BotUpdateEntityItems
+void BotMarkItemEntity(int entnum);
 //interbreed the goal fuzzy logic
 void BotInterbreedGoalFuzzyLogic(int parent1, int parent2, int child);
 //save the goal fuzzy logic to disk
@@ -161,7 +161,7 @@ BotAI_Trace
 ==================
 */
 void BotAI_Trace(bsp_trace_t *bsptrace, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, int passent, int contentmask) {
-	trap_Trace(bsptrace, start, mins, maxs, end, passent, contentmask);
+	G_Trace(TRACE_BOTAI, bsptrace, start, mins, maxs, end, passent, contentmask);
 }
 
 /*
@@ -1917,7 +1917,7 @@ BotAIStartFrame
 ==================
 */
 int BotAIStartFrame(int time) {
-	int i;
+	int i, wasvalid;
 	gentity_t	*ent;
 	bot_entitystate_t state;
 	int elapsed_time, thinktime;
@@ -2010,8 +2010,10 @@ int BotAIStartFrame(int time) {
 		if (!trap_AAS_Initialized()) return qfalse;
 
 		//update entities in the botlib
+		G_ProfileBegin(PROF_BOTLIB_UPDATE);
 		for (i = 0; i < MAX_GENTITIES; i++) {
 			ent = &g_entities[i];
+			wasvalid = ent->botvalid;
 			ent->botvalid = qfalse;
 			if (!ent->inuse) {
 				trap_BotLibUpdateEntity(i, NULL);
@@ -2088,11 +2090,18 @@ int BotAIStartFrame(int time) {
 				VectorCopy( ent->s.maxs, ent->lastMaxs );
 				state.relink = qtrue;
 			}
+			//items that appeared or moved are checked by the goal AI
+			if (ent->s.eType == ET_ITEM && (!wasvalid || state.relink)) {
+				BotMarkItemEntity(i);
+			}
 			//
 			trap_BotLibUpdateEntity(i, &state);
 		}
+		G_ProfileEnd(PROF_BOTLIB_UPDATE);
 
+		G_ProfileBegin(PROF_BOTAI_REGULAR_UPDATE);
 		BotAIRegularUpdate();
+		G_ProfileEnd(PROF_BOTAI_REGULAR_UPDATE);
 	}
 
 	floattime = trap_AAS_Time();
@@ -2111,7 +2120,9 @@ int BotAIStartFrame(int time) {
 			if (!trap_AAS_Initialized()) return qfalse;
 
 			if (g_entities[i].player->pers.connected == CON_CONNECTED) {
+				G_ProfileBegin(PROF_BOTAI);
 				BotAI(i, (float) thinktime / 1000);
+				G_ProfileEnd(PROF_BOTAI);
 			}
 		}
 	}
@@ -76,6 +76,21 @@ typedef struct bot_ctftaskpreference_s
 
 bot_ctftaskpreference_t ctftaskpreferences[MAX_CLIENTS];
 
+//travel times from the players to the key goals (flags, obelisks),
+//updated at most once per botlib frame and shared by all bots
+#define MAX_KEYGOALS		4
+
+typedef struct bot_keygoaltraveltimes_s
+{
+	float		time;					//botlib time the travel times were calculated
+	int			areanum;				//area the player was in
+	int			traveltimes[MAX_KEYGOALS];
+} bot_keygoaltraveltimes_t;
+
+bot_goal_t *keygoals[MAX_KEYGOALS];
+int numkeygoals;
+bot_keygoaltraveltimes_t keygoaltraveltimes[MAX_CLIENTS];
+
 
 /*
 ==================
@@ -112,6 +127,79 @@ int BotNumTeamMates(bot_state_t *bs) {
 	return numplayers;
 }
 
+/*
+==================
+BotClearKeyGoals
+==================
+*/
+void BotClearKeyGoals(void) {
+	int i;
+
+	numkeygoals = 0;
+	for (i = 0; i < MAX_CLIENTS; i++) {
+		keygoaltraveltimes[i].time = -1;
+	}
+}
+
+/*
+==================
+BotRegisterKeyGoal
+
+Travel times from all players to the goal are shared by the bots.
+The goal is referenced, not copied.
+==================
+*/
+void BotRegisterKeyGoal(bot_goal_t *goal) {
+	int i;
+
+	if (!goal->areanum) return;
+	for (i = 0; i < numkeygoals; i++) {
+		if (keygoals[i] == goal) return;
+	}
+	if (numkeygoals >= MAX_KEYGOALS) {
+		BotAI_Print(PRT_WARNING, "more than %d key goals\n", MAX_KEYGOALS);
+		return;
+	}
+	keygoals[numkeygoals++] = goal;
+	//recalculate the travel times
+	for (i = 0; i < MAX_CLIENTS; i++) {
+		keygoaltraveltimes[i].time = -1;
+	}
+}
+
+/*
+==================
+BotUpdateKeyGoalTravelTimes
+==================
+*/
+bot_keygoaltraveltimes_t *BotUpdateKeyGoalTravelTimes(int playernum) {
+	playerState_t ps;
+	bot_keygoaltraveltimes_t *kt;
+	float time;
+	int i;
+
+	kt = &keygoaltraveltimes[playernum];
+	time = trap_AAS_Time();
+	//already up to date for this botlib frame
+	if (kt->time == time) return kt;
+	kt->time = time;
+
+	if (BotAI_GetPlayerState(playernum, &ps)) {
+		kt->areanum = BotPointAreaNum(ps.origin);
+	} else {
+		kt->areanum = 0;
+	}
+
+	for (i = 0; i < numkeygoals; i++) {
+		if (!kt->areanum) {
+			kt->traveltimes[i] = 1;
+			continue;
+		}
+		kt->traveltimes[i] = trap_AAS_AreaTravelTimeToGoalArea(kt->areanum, ps.origin, keygoals[i]->areanum, TFL_DEFAULT);
+	}
+	return kt;
+}
+
 /*
 ==================
 BotPlayerTravelTimeToGoal
@@ -119,7 +207,14 @@ BotPlayerTravelTimeToGoal
 */
 int BotPlayerTravelTimeToGoal(int playernum, bot_goal_t *goal) {
 	playerState_t ps;
-	int areanum;
+	int i, areanum;
+
+	//use the shared travel times for key goals
+	for (i = 0; i < numkeygoals; i++) {
+		if (keygoals[i] == goal) {
+			return BotUpdateKeyGoalTravelTimes(playernum)->traveltimes[i];
+		}
+	}
 
 	if (BotAI_GetPlayerState(playernum, &ps)) {
 		areanum = BotPointAreaNum(ps.origin);
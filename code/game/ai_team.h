@@ -39,6 +39,9 @@ Suite 120, Rockville, Maryland 20850 USA.
  *****************************************************************************/
 
 void BotTeamAI(bot_state_t *bs);
+void BotClearKeyGoals(void);
+void BotRegisterKeyGoal(bot_goal_t *goal);
+int BotPlayerTravelTimeToGoal(int playernum, bot_goal_t *goal);
 int BotGetTeamMateTaskPreference(bot_state_t *bs, int teammate);
 void BotSetTeamMateTaskPreference(bot_state_t *bs, int teammate, int preference);
 void BotVoiceChat(bot_state_t *bs, int toPlayer, char *voicechat);
@@ -1240,6 +1240,17 @@ qboolean	BG_PlayerTouchesItem( playerState_t *ps, entityState_t *item, int atTim
 	return qtrue;
 }
 
+/*
+============
+BG_ItemTouchBounds
+
+The player origins that BG_PlayerTouchesItem accepts for an item at origin
+============
+*/
+void BG_ItemTouchBounds( const vec3_t origin, vec3_t mins, vec3_t maxs ) {
+	VectorSet( mins, origin[0] - 50, origin[1] - 36, origin[2] - 36 );
+	VectorSet( maxs, origin[0] + 44, origin[1] + 36, origin[2] + 36 );
+}
 
 
 /*
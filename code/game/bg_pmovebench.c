@@ -0,0 +1,417 @@
+/*
+===========================================================================
+Copyright (C) 1999-2010 id Software LLC, a ZeniMax Media company.
+
+This file is part of Spearmint Source Code.
+
+Spearmint Source Code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 3 of the License,
+or (at your option) any later version.
+
+Spearmint Source Code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Spearmint Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, Spearmint Source Code is also subject to certain additional terms.
+You should have received a copy of these additional terms immediately following
+the terms and conditions of the GNU General Public License.  If not, please
+request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional
+terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+Suite 120, Rockville, Maryland 20850 USA.
+===========================================================================
+*/
+//
+// bg_pmovebench.c -- stub world and command streams for Pmove benchmarks
+//
+// A small world made of box brushes with its own trace and point contents,
+// so Pmove results don't depend on a loaded map or on the entities in it.
+// Nothing here calls the engine, so the same code runs in the game and in
+// the native pmovebench tool, which replays recorded command streams and
+// checks the playerState after every move.
+
+#include "../qcommon/q_shared.h"
+#include "bg_public.h"
+
+#define MAX_BENCH_BRUSHES		32
+
+// same as the collision code
+#define	BENCH_CLIP_EPSILON		0.125f
+
+typedef struct {
+	vec3_t		mins, maxs;
+	int			contents;
+} benchBrush_t;
+
+static benchBrush_t	benchBrushes[MAX_BENCH_BRUSHES];
+static int			numBenchBrushes;
+
+/*
+===============================================================================
+
+STUB WORLD
+
+===============================================================================
+*/
+
+/*
+================
+BG_BenchAddBrush
+================
+*/
+static void BG_BenchAddBrush( float x0, float y0, float z0, float x1, float y1, float z1, int contents ) {
+	benchBrush_t	*brush;
+
+	if ( numBenchBrushes >= MAX_BENCH_BRUSHES ) {
+		return;
+	}
+	brush = &benchBrushes[numBenchBrushes++];
+	VectorSet( brush->mins, x0, y0, z0 );
+	VectorSet( brush->maxs, x1, y1, z1 );
+	brush->contents = contents;
+}
+
+/*
+================
+BG_BenchBuildWorld
+
+A walled room with stairs, a ledge, a low ceiling to crouch under,
+pillars and a pool
+================
+*/
+void BG_BenchBuildWorld( void ) {
+	int		i;
+
+	numBenchBrushes = 0;
+
+	// floor and walls
+	BG_BenchAddBrush( -1024, -1024, -64, 1024, 1024, 0, CONTENTS_SOLID );
+	BG_BenchAddBrush( -1088, -1024, -64, -1024, 1024, 512, CONTENTS_SOLID );
+	BG_BenchAddBrush( 1024, -1024, -64, 1088, 1024, 512, CONTENTS_SOLID );
+	BG_BenchAddBrush( -1024, -1088, -64, 1024, -1024, 512, CONTENTS_SOLID );
+	BG_BenchAddBrush( -1024, 1024, -64, 1024, 1088, 512, CONTENTS_SOLID );
+
+	// stairs up to a ledge
+	for ( i = 0; i < 8; i++ ) {
+		BG_BenchAddBrush( 256 + i * 24, -256, 0, 1024, 256, ( i + 1 ) * 16, CONTENTS_SOLID );
+	}
+
+	// low ceiling, only crouching fits under it
+	BG_BenchAddBrush( -512, 512, 40, -128, 1024, 64, CONTENTS_SOLID );
+
+	// pillars
+	BG_BenchAddBrush( -320, -320, 0, -256, -256, 512, CONTENTS_SOLID );
+	BG_BenchAddBrush( -320, 256, 0, -256, 320, 512, CONTENTS_SOLID );
+	BG_BenchAddBrush( 128, -640, 0, 192, -576, 512, CONTENTS_SOLID );
+
+	// pool
+	BG_BenchAddBrush( -960, -960, 0, -576, -576, 96, CONTENTS_WATER );
+}
+
+/*
+================
+BG_BenchClipToBrush
+
+Same plane tests as the collision code, with the brush grown by the box
+================
+*/
+static void BG_BenchClipToBrush( trace_t *trace, const benchBrush_t *brush, const vec3_t start,
+								const vec3_t mins, const vec3_t maxs, const vec3_t end ) {
+	float		enterFrac, leaveFrac;
+	float		d1, d2, f;
+	qboolean	startout, getout;
+	int			i, side, clipAxis, clipSide;
+
+	enterFrac = -1.0f;
+	leaveFrac = 1.0f;
+	startout = getout = qfalse;
+	clipAxis = clipSide = -1;
+
+	for ( i = 0; i < 3; i++ ) {
+		for ( side = 0; side < 2; side++ ) {
+			if ( side ) {
+				d1 = start[i] + mins[i] - brush->maxs[i];
+				d2 = end[i] + mins[i] - brush->maxs[i];
+			} else {
+				d1 = brush->mins[i] - ( start[i] + maxs[i] );
+				d2 = brush->mins[i] - ( end[i] + maxs[i] );
+			}
+
+			if ( d2 > 0 ) {
+				getout = qtrue;
+			}
+			if ( d1 > 0 ) {
+				startout = qtrue;
+			}
+
+			// completely in front of the face, no intersection
+			if ( d1 > 0 && ( d2 >= BENCH_CLIP_EPSILON || d2 >= d1 ) ) {
+				return;
+			}
+			if ( d1 <= 0 && d2 <= 0 ) {
+				continue;
+			}
+
+			if ( d1 > d2 ) {
+				f = ( d1 - BENCH_CLIP_EPSILON ) / ( d1 - d2 );
+				if ( f < 0 ) {
+					f = 0;
+				}
+				if ( f > enterFrac ) {
+					enterFrac = f;
+					clipAxis = i;
+					clipSide = side;
+				}
+			} else {
+				f = ( d1 + BENCH_CLIP_EPSILON ) / ( d1 - d2 );
+				if ( f > 1 ) {
+					f = 1;
+				}
+				if ( f < leaveFrac ) {
+					leaveFrac = f;
+				}
+			}
+		}
+	}
+
+	if ( !startout ) {
+		trace->startsolid = qtrue;
+		if ( !getout ) {
+			trace->allsolid = qtrue;
+			trace->fraction = 0;
+		}
+		trace->contents = brush->contents;
+		trace->entityNum = ENTITYNUM_WORLD;
+		return;
+	}
+
+	if ( enterFrac < leaveFrac && enterFrac > -1 && enterFrac < trace->fraction && clipAxis >= 0 ) {
+		trace->fraction = enterFrac;
+		VectorClear( trace->plane.normal );
+		if ( clipSide ) {
+			trace->plane.normal[clipAxis] = 1;
+			trace->plane.dist = brush->maxs[clipAxis];
+		} else {
+			trace->plane.normal[clipAxis] = -1;
+			trace->plane.dist = -brush->mins[clipAxis];
+		}
+		trace->plane.type = clipAxis;
+		trace->plane.signbits = clipSide ? 0 : ( 1 << clipAxis );
+		trace->contents = brush->contents;
+		trace->entityNum = ENTITYNUM_WORLD;
+	}
+}
+
+/*
+================
+BG_BenchTrace
+
+Capsules are traced as boxes
+================
+*/
+static void BG_BenchTrace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask ) {
+	int		i;
+
+	memset( results, 0, sizeof( *results ) );
+	results->fraction = 1.0f;
+	results->entityNum = ENTITYNUM_NONE;
+
+	for ( i = 0; i < numBenchBrushes; i++ ) {
+		if ( !( benchBrushes[i].contents & contentmask ) ) {
+			continue;
+		}
+		BG_BenchClipToBrush( results, &benchBrushes[i], start, mins, maxs, end );
+		if ( results->allsolid ) {
+			break;
+		}
+	}
+
+	for ( i = 0; i < 3; i++ ) {
+		results->endpos[i] = start[i] + results->fraction * ( end[i] - start[i] );
+	}
+}
+
+/*
+================
+BG_BenchPointContents
+================
+*/
+static int BG_BenchPointContents( const vec3_t point, int passEntityNum ) {
+	benchBrush_t	*brush;
+	int				i, contents;
+
+	contents = 0;
+	for ( i = 0, brush = benchBrushes; i < numBenchBrushes; i++, brush++ ) {
+		if ( point[0] < brush->mins[0] || point[0] > brush->maxs[0]
+			|| point[1] < brush->mins[1] || point[1] > brush->maxs[1]
+			|| point[2] < brush->mins[2] || point[2] > brush->maxs[2] ) {
+			continue;
+		}
+		contents |= brush->contents;
+	}
+	return contents;
+}
+
+/*
+===============================================================================
+
+COMMAND STREAMS
+
+===============================================================================
+*/
+
+/*
+================
+BG_BenchRandom
+
+Not rand(), so a seed gives the same stream on every platform
+================
+*/
+static int BG_BenchRandom( unsigned int *seed ) {
+	*seed = *seed * 1103515245u + 12345u;
+	return (int)( ( *seed >> 16 ) & 0x7fff );
+}
+
+/*
+================
+BG_BenchGenerateCmds
+
+Runs, strafes, jumps, crouches and turns for a random number of moves
+each, with frame times between 8 and 33 msec
+================
+*/
+void BG_BenchGenerateCmds( usercmd_t *cmds, int numMoves, unsigned int seed ) {
+	static const signed char	moves[3] = { -127, 0, 127 };
+	usercmd_t	cmd;
+	int			i, hold, yawSpeed;
+
+	memset( &cmd, 0, sizeof( cmd ) );
+	hold = yawSpeed = 0;
+
+	for ( i = 0; i < numMoves; i++ ) {
+		if ( --hold <= 0 ) {
+			hold = 10 + BG_BenchRandom( &seed ) % 50;
+			cmd.forwardmove = moves[BG_BenchRandom( &seed ) % 3];
+			cmd.rightmove = moves[BG_BenchRandom( &seed ) % 3];
+			cmd.upmove = moves[BG_BenchRandom( &seed ) % 3];
+			cmd.buttons = ( BG_BenchRandom( &seed ) % 4 == 0 ) ? BUTTON_ATTACK : 0;
+			yawSpeed = BG_BenchRandom( &seed ) % 1024 - 512;
+			cmd.angles[PITCH] = ANGLE2SHORT( BG_BenchRandom( &seed ) % 60 - 30 );
+		}
+		cmd.serverTime += 8 + BG_BenchRandom( &seed ) % 26;
+		cmd.angles[YAW] = ( cmd.angles[YAW] + yawSpeed ) & 0xffff;
+		cmds[i] = cmd;
+	}
+}
+
+
+/*
+===============================================================================
+
+RUNNING
+
+===============================================================================
+*/
+
+/*
+================
+BG_BenchChecksum
+================
+*/
+int BG_BenchChecksum( const playerState_t *ps ) {
+	const unsigned char	*p;
+	unsigned			hash;
+	int					i;
+
+	// FNV-1a
+	hash = 2166136261u;
+	p = (const unsigned char *)ps;
+	for ( i = 0; i < sizeof( *ps ); i++ ) {
+		hash = ( hash ^ p[i] ) * 16777619u;
+	}
+	return (int)hash;
+}
+
+/*
+================
+BG_BenchInitPmove
+
+Sets up a player standing in the stub world, ready for commands from
+serverTime on
+================
+*/
+void BG_BenchInitPmove( pmove_t *pm, playerState_t *ps, int serverTime ) {
+	memset( ps, 0, sizeof( *ps ) );
+	ps->commandTime = serverTime - 8;
+	ps->pm_type = PM_NORMAL;
+	ps->groundEntityNum = ENTITYNUM_NONE;
+	ps->playerNum = 0;
+	ps->gravity = 800;
+	ps->speed = 320;
+	ps->viewheight = DEFAULT_VIEWHEIGHT;
+	ps->stats[STAT_HEALTH] = ps->stats[STAT_MAX_HEALTH] = 100;
+	ps->stats[STAT_WEAPONS] = ( 1 << WP_MACHINEGUN );
+	ps->ammo[WP_MACHINEGUN] = 999;
+	ps->weapon = WP_MACHINEGUN;
+	ps->weaponstate = WEAPON_READY;
+	ps->collisionType = CT_AABB;
+	ps->contents = CONTENTS_BODY;
+	VectorSet( ps->mins, -15, -15, -24 );
+	VectorSet( ps->maxs, 15, 15, 32 );
+	VectorSet( ps->origin, 0, 0, 25 );
+
+	memset( pm, 0, sizeof( *pm ) );
+	pm->ps = ps;
+	pm->tracemask = MASK_PLAYERSOLID;
+	pm->trace = BG_BenchTrace;
+	pm->pointcontents = BG_BenchPointContents;
+}
+
+/*
+================
+BG_BenchRun
+
+Runs all commands from the same start, stores the checksum of the whole
+playerState after every move if wanted
+================
+*/
+void BG_BenchRun( const usercmd_t *cmds, int numCmds, int *checksums ) {
+	playerState_t	ps;
+	pmove_t			pm;
+	int				i;
+
+	BG_BenchInitPmove( &pm, &ps, numCmds ? cmds[0].serverTime : 0 );
+
+	for ( i = 0; i < numCmds; i++ ) {
+		pm.cmd = cmds[i];
+		Pmove( &pm );
+
+		if ( checksums ) {
+			checksums[i] = BG_BenchChecksum( &ps );
+		}
+	}
+}
+
+/*
+================
+BG_BenchCheckHeader
+
+Returns qfalse if a file of fileLength bytes with this header isn't a
+benchmark file
+================
+*/
+qboolean BG_BenchCheckHeader( const benchFileHeader_t *header, int fileLength ) {
+	if ( header->ident != BENCH_FILE_ID || header->version != BENCH_FILE_VERSION ) {
+		return qfalse;
+	}
+	if ( header->numMoves < 0 || header->numMoves > MAX_BENCH_MOVES ) {
+		return qfalse;
+	}
+	return fileLength == sizeof( *header ) + header->numMoves * ( sizeof( usercmd_t ) + sizeof( int ) );
+}
@@ -96,6 +96,25 @@ Suite 120, Rockville, Maryland 20850 USA.
 
 #define	SCORE_NOT_PRESENT	-9999	// for the CS_SCORES[12] when only one player is present
 
+// scoreboard row fields, in the order they are sent by "scores" and "dscores"
+typedef enum {
+	SCORE_FIELD_SCORE,
+	SCORE_FIELD_PING,
+	SCORE_FIELD_TIME,
+	SCORE_FIELD_FLAGS,
+	SCORE_FIELD_POWERUPS,
+	SCORE_FIELD_ACCURACY,
+	SCORE_FIELD_IMPRESSIVE,
+	SCORE_FIELD_EXCELLENT,
+	SCORE_FIELD_GAUNTLET,
+	SCORE_FIELD_DEFEND,
+	SCORE_FIELD_ASSIST,
+	SCORE_FIELD_PERFECT,
+	SCORE_FIELD_CAPTURES,
+
+	SCORE_NUM_FIELDS
+} scoreField_t;
+
 #define	VOTE_TIME			30000	// 30 seconds before vote times out
 
 #define	MINS_Z				-24
@@ -1119,6 +1138,7 @@ void	BG_PlayerStateToEntityState( playerState_t *ps, entityState_t *s, qboolean
 void	BG_PlayerStateToEntityStateExtraPolate( playerState_t *ps, entityState_t *s, int time, qboolean snap );
 
 qboolean	BG_PlayerTouchesItem( playerState_t *ps, entityState_t *item, int atTime );
+void		BG_ItemTouchBounds( const vec3_t origin, vec3_t mins, vec3_t maxs );
 
 int		BG_ComposeUserCmdValue( int weapon );
 void	BG_DecomposeUserCmdValue( int value, int *weapon );
@@ -1248,6 +1268,61 @@ int BG_GetTracemapGroundFloor( void );
 int BG_GetTracemapGroundCeil( void );
 void etpro_FinalizeTracemapClamp( int *x, int *y );
 
+//
+// bg_triggergrid.c
+//
+#define TRIGGER_GRID_CELL_SIZE		256
+#define TRIGGER_GRID_BUCKETS		1024	// must be a power of two
+#define MAX_TRIGGER_GRID_LINKS		4096
+
+typedef struct {
+	int			entityNum;
+	int			bucket;			// -1 for the list of large boxes
+	int			prev, next;		// in the bucket, 0 ends the chain
+	int			nextOfEntity;
+} bgTriggerLink_t;
+
+typedef struct {
+	int				buckets[TRIGGER_GRID_BUCKETS];
+	int				large;
+	bgTriggerLink_t	links[MAX_TRIGGER_GRID_LINKS + MAX_GENTITIES];	// pool, then one large list link per entity
+	int				freeLinks;
+	int				entityLinks[MAX_GENTITIES];
+	vec3_t			absmin[MAX_GENTITIES];
+	vec3_t			absmax[MAX_GENTITIES];
+	int				queryCount;
+	int				queried[MAX_GENTITIES];
+} bgTriggerGrid_t;
+
+void BG_TriggerGridClear( bgTriggerGrid_t *grid );
+void BG_TriggerGridLink( bgTriggerGrid_t *grid, int entityNum, const vec3_t absmin, const vec3_t absmax );
+void BG_TriggerGridUnlink( bgTriggerGrid_t *grid, int entityNum );
+int BG_TriggerGridQuery( bgTriggerGrid_t *grid, const vec3_t mins, const vec3_t maxs, int *list, int maxcount );
+
+//
+// bg_pmovebench.c
+//
+#define MAX_BENCH_MOVES			16384
+#define DEFAULT_BENCH_MOVES		10000
+
+#define BENCH_FILE_ID			( ('1'<<24)+('B'<<16)+('M'<<8)+'P' )
+#define BENCH_FILE_VERSION		1
+
+// followed by numMoves usercmd_t and then the playerState checksum after each
+typedef struct {
+	int			ident;
+	int			version;
+	int			numMoves;
+	int			playerStateSize;	// checksums are only comparable for the same playerState_t
+} benchFileHeader_t;
+
+void BG_BenchBuildWorld( void );
+void BG_BenchGenerateCmds( usercmd_t *cmds, int numMoves, unsigned int seed );
+int BG_BenchChecksum( const playerState_t *ps );
+void BG_BenchInitPmove( pmove_t *pm, playerState_t *ps, int serverTime );
+void BG_BenchRun( const usercmd_t *cmds, int numCmds, int *checksums );
+qboolean BG_BenchCheckHeader( const benchFileHeader_t *header, int fileLength );
+
 void PC_SourceWarning(int handle, char *format, ...) __attribute__ ((format (printf, 2, 3)));
 void PC_SourceError(int handle, char *format, ...) __attribute__ ((format (printf, 2, 3)));
 int PC_CheckTokenString(int handle, char *string);
@@ -0,0 +1,258 @@
+/*
+===========================================================================
+Copyright (C) 1999-2010 id Software LLC, a ZeniMax Media company.
+
+This file is part of Spearmint Source Code.
+
+Spearmint Source Code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 3 of the License,
+or (at your option) any later version.
+
+Spearmint Source Code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Spearmint Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, Spearmint Source Code is also subject to certain additional terms.
+You should have received a copy of these additional terms immediately following
+the terms and conditions of the GNU General Public License.  If not, please
+request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional
+terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+Suite 120, Rockville, Maryland 20850 USA.
+===========================================================================
+*/
+//
+// bg_triggergrid.c -- trigger broadphase shared by game and cgame
+//
+// Trigger boxes are hashed into columns of TRIGGER_GRID_CELL_SIZE units on
+// the x/y plane, so a player touch check only has to look at the triggers
+// in the few columns around the player instead of every entity in range.
+// Boxes covering more than TRIGGER_GRID_MAX_CELLS columns, and any that
+// don't fit in the link pool, go in a list that every query checks. Each
+// entity has its own link for that list outside the pool, so linking
+// never fails.
+
+#include "../qcommon/q_shared.h"
+#include "bg_public.h"
+
+#define TRIGGER_GRID_MAX_CELLS		16
+
+/*
+================
+BG_TriggerGridCell
+================
+*/
+static int BG_TriggerGridCell( float v ) {
+	if ( v < -MAX_MAP_SIZE ) {
+		v = -MAX_MAP_SIZE;
+	} else if ( v > MAX_MAP_SIZE - 1 ) {
+		v = MAX_MAP_SIZE - 1;
+	}
+	return (int)( v + MAX_MAP_SIZE ) / TRIGGER_GRID_CELL_SIZE;
+}
+
+/*
+================
+BG_TriggerGridBucket
+================
+*/
+static int BG_TriggerGridBucket( int x, int y ) {
+	return ( x * 73 + y * 4099 ) & ( TRIGGER_GRID_BUCKETS - 1 );
+}
+
+/*
+================
+BG_TriggerGridClear
+================
+*/
+void BG_TriggerGridClear( bgTriggerGrid_t *grid ) {
+	int		i;
+
+	memset( grid, 0, sizeof( *grid ) );
+
+	// link 0 is the end of every chain
+	for ( i = 1; i < MAX_TRIGGER_GRID_LINKS - 1; i++ ) {
+		grid->links[i].next = i + 1;
+	}
+	grid->freeLinks = 1;
+}
+
+/*
+================
+BG_TriggerGridAddLink
+================
+*/
+static qboolean BG_TriggerGridAddLink( bgTriggerGrid_t *grid, int entityNum, int bucket ) {
+	bgTriggerLink_t	*link;
+	int				*head;
+	int				l;
+
+	if ( bucket < 0 ) {
+		// the entity's reserved link
+		l = MAX_TRIGGER_GRID_LINKS + entityNum;
+		link = &grid->links[l];
+		head = &grid->large;
+	} else {
+		l = grid->freeLinks;
+		if ( !l ) {
+			return qfalse;
+		}
+		link = &grid->links[l];
+		grid->freeLinks = link->next;
+		head = &grid->buckets[bucket];
+	}
+
+	link->entityNum = entityNum;
+	link->bucket = bucket;
+	link->prev = 0;
+	link->next = *head;
+	if ( *head ) {
+		grid->links[*head].prev = l;
+	}
+	*head = l;
+
+	link->nextOfEntity = grid->entityLinks[entityNum];
+	grid->entityLinks[entityNum] = l;
+	return qtrue;
+}
+
+/*
+================
+BG_TriggerGridUnlink
+================
+*/
+void BG_TriggerGridUnlink( bgTriggerGrid_t *grid, int entityNum ) {
+	bgTriggerLink_t	*link;
+	int				l, next;
+
+	for ( l = grid->entityLinks[entityNum]; l; l = next ) {
+		link = &grid->links[l];
+		next = link->nextOfEntity;
+
+		if ( link->prev ) {
+			grid->links[link->prev].next = link->next;
+		} else if ( link->bucket < 0 ) {
+			grid->large = link->next;
+		} else {
+			grid->buckets[link->bucket] = link->next;
+		}
+		if ( link->next ) {
+			grid->links[link->next].prev = link->prev;
+		}
+
+		if ( l < MAX_TRIGGER_GRID_LINKS ) {
+			link->next = grid->freeLinks;
+			grid->freeLinks = l;
+		}
+	}
+	grid->entityLinks[entityNum] = 0;
+}
+
+/*
+================
+BG_TriggerGridLink
+
+Links or relinks an entity with the box it currently covers
+================
+*/
+void BG_TriggerGridLink( bgTriggerGrid_t *grid, int entityNum, const vec3_t absmin, const vec3_t absmax ) {
+	int		x0, y0, x1, y1, x, y;
+
+	BG_TriggerGridUnlink( grid, entityNum );
+
+	VectorCopy( absmin, grid->absmin[entityNum] );
+	VectorCopy( absmax, grid->absmax[entityNum] );
+
+	x0 = BG_TriggerGridCell( absmin[0] );
+	y0 = BG_TriggerGridCell( absmin[1] );
+	x1 = BG_TriggerGridCell( absmax[0] );
+	y1 = BG_TriggerGridCell( absmax[1] );
+
+	if ( ( x1 - x0 + 1 ) * ( y1 - y0 + 1 ) <= TRIGGER_GRID_MAX_CELLS ) {
+		for ( y = y0; y <= y1; y++ ) {
+			for ( x = x0; x <= x1; x++ ) {
+				if ( !BG_TriggerGridAddLink( grid, entityNum, BG_TriggerGridBucket( x, y ) ) ) {
+					// out of links, check it on every query instead, which
+					// uses the entity's own link and can't fail
+					BG_TriggerGridUnlink( grid, entityNum );
+					BG_TriggerGridAddLink( grid, entityNum, -1 );
+					return;
+				}
+			}
+		}
+		return;
+	}
+
+	BG_TriggerGridAddLink( grid, entityNum, -1 );
+}
+
+/*
+================
+BG_TriggerGridCheckChain
+================
+*/
+static int BG_TriggerGridCheckChain( bgTriggerGrid_t *grid, int l, const vec3_t mins, const vec3_t maxs,
+										int *list, int num, int maxcount ) {
+	bgTriggerLink_t	*link;
+	int				e;
+
+	for ( ; l && num < maxcount; l = link->next ) {
+		link = &grid->links[l];
+		e = link->entityNum;
+
+		// already seen through another column
+		if ( grid->queried[e] == grid->queryCount ) {
+			continue;
+		}
+		grid->queried[e] = grid->queryCount;
+
+		if ( grid->absmin[e][0] > maxs[0] || grid->absmax[e][0] < mins[0]
+			|| grid->absmin[e][1] > maxs[1] || grid->absmax[e][1] < mins[1]
+			|| grid->absmin[e][2] > maxs[2] || grid->absmax[e][2] < mins[2] ) {
+			continue;
+		}
+
+		list[num++] = e;
+	}
+
+	return num;
+}
+
+/*
+================
+BG_TriggerGridQuery
+
+Fills list with the entities whose linked box touches mins/maxs
+================
+*/
+int BG_TriggerGridQuery( bgTriggerGrid_t *grid, const vec3_t mins, const vec3_t maxs, int *list, int maxcount ) {
+	int		x0, y0, x1, y1, x, y;
+	int		num;
+
+	grid->queryCount++;
+	if ( grid->queryCount <= 0 ) {
+		memset( grid->queried, 0, sizeof( grid->queried ) );
+		grid->queryCount = 1;
+	}
+
+	x0 = BG_TriggerGridCell( mins[0] );
+	y0 = BG_TriggerGridCell( mins[1] );
+	x1 = BG_TriggerGridCell( maxs[0] );
+	y1 = BG_TriggerGridCell( maxs[1] );
+
+	num = BG_TriggerGridCheckChain( grid, grid->large, mins, maxs, list, 0, maxcount );
+
+	for ( y = y0; y <= y1; y++ ) {
+		for ( x = x0; x <= x1; x++ ) {
+			num = BG_TriggerGridCheckChain( grid, grid->buckets[BG_TriggerGridBucket( x, y )], mins, maxs, list, num, maxcount );
+		}
+	}
+
+	return num;
+}
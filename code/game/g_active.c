@@ -229,6 +229,7 @@ void PlayerImpacts( gentity_t *ent, pmove_t *pm ) {
 		}
 
 		other->touch( other, ent, &trace );
+		G_WakeEntity( other );
 	}
 
 }
@@ -261,7 +262,7 @@ void	G_TouchTriggers( gentity_t *ent ) {
 	VectorSubtract( ent->player->ps.origin, range, mins );
 	VectorAdd( ent->player->ps.origin, range, maxs );
 
-	num = trap_EntitiesInBox( mins, maxs, touch, MAX_GENTITIES );
+	num = G_TriggersInBox( mins, maxs, touch, MAX_GENTITIES );
 
 	// can't use ent->absmin, because that has a one unit pad
 	VectorAdd( ent->player->ps.origin, ent->s.mins, mins );
@@ -303,6 +304,7 @@ void	G_TouchTriggers( gentity_t *ent ) {
 
 		if ( hit->touch ) {
 			hit->touch (hit, ent, &trace);
+			G_WakeEntity( hit );
 		}
 
 		if ( ( ent->r.svFlags & SVF_BOT ) && ( ent->touch ) ) {
@@ -346,9 +348,9 @@ void SpectatorThink( gentity_t *ent, usercmd_t *ucmd ) {
 		pm.cmd = *ucmd;
 		pm.tracemask = MASK_PLAYERSOLID & ~CONTENTS_BODY;	// spectators can fly through bodies
 		if (player->ps.collisionType == CT_CAPSULE) {
-			pm.trace = trap_TraceCapsule;
+			pm.trace = G_PmoveTraceCapsule;
 		} else {
-			pm.trace = trap_Trace;
+			pm.trace = G_PmoveTrace;
 		}
 		pm.pointcontents = trap_PointContents;
 
@@ -358,7 +360,7 @@ void SpectatorThink( gentity_t *ent, usercmd_t *ucmd ) {
 		VectorCopy( player->ps.origin, ent->s.origin );
 
 		G_TouchTriggers( ent );
-		trap_UnlinkEntity( ent );
+		G_UnlinkEntity( ent );
 	}
 
 	player->oldbuttons = player->buttons;
@@ -873,7 +875,7 @@ void PlayerThink_real( gentity_t *ent ) {
 			// expand
 			VectorCopy (mins, ent->s.mins);
 			VectorCopy (maxs, ent->s.maxs);
-			trap_LinkEntity(ent);
+			G_LinkEntity(ent);
 			// check if this would get anyone stuck in this player
 			if ( !StuckInOtherPlayer(ent) ) {
 				// set flag so the expanded size will be set in PM_CheckDuck
@@ -882,7 +884,7 @@ void PlayerThink_real( gentity_t *ent ) {
 			// set back
 			VectorCopy (oldmins, ent->s.mins);
 			VectorCopy (oldmaxs, ent->s.maxs);
-			trap_LinkEntity(ent);
+			G_LinkEntity(ent);
 		}
 	}
 #endif
@@ -899,9 +901,9 @@ void PlayerThink_real( gentity_t *ent ) {
 		pm.tracemask = MASK_PLAYERSOLID;
 	}
 	if (player->ps.collisionType == CT_CAPSULE) {
-		pm.trace = trap_TraceCapsule;
+		pm.trace = G_PmoveTraceCapsule;
 	} else {
-		pm.trace = trap_Trace;
+		pm.trace = G_PmoveTrace;
 	}
 	pm.pointcontents = trap_PointContents;
 	pm.debugLevel = g_debugMove.integer;
@@ -929,7 +931,9 @@ void PlayerThink_real( gentity_t *ent ) {
 	}
 #endif
 
+	G_ProfileBegin( PROF_PMOVE );
 	Pmove (&pm);
+	G_ProfileEnd( PROF_PMOVE );
 
 	// save results of pmove
 	if ( ent->player->ps.eventSequence != oldEventSequence ) {
@@ -957,7 +961,7 @@ void PlayerThink_real( gentity_t *ent ) {
 	PlayerEvents( ent, oldEventSequence );
 
 	// link entity now, after any personal teleporters have been used
-	trap_LinkEntity (ent);
+	G_LinkEntity (ent);
 	if ( !ent->player->noclip ) {
 		G_TouchTriggers( ent );
 	}
@@ -1022,7 +1026,9 @@ void PlayerThink( int playerNum ) {
 	ent->player->lastCmdTime = level.time;
 
 	if ( !(ent->r.svFlags & SVF_BOT) && !g_synchronousClients.integer ) {
+		G_ProfileBegin( PROF_PLAYER_THINK );
 		PlayerThink_real( ent );
+		G_ProfileEnd( PROF_PLAYER_THINK );
 	}
 }
 
@@ -1032,7 +1038,9 @@ void G_RunPlayer( gentity_t *ent ) {
 		return;
 	}
 	ent->player->pers.cmd.serverTime = level.time;
+	G_ProfileBegin( PROF_PLAYER_THINK );
 	PlayerThink_real( ent );
+	G_ProfileEnd( PROF_PLAYER_THINK );
 }
 
 
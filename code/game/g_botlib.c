@@ -100,6 +100,15 @@ static void *BotImport_HunkAlloc( int size ) {
 	return trap_HeapMalloc( size );
 }
 
+/*
+==================
+BotImport_Trace
+==================
+*/
+static void BotImport_Trace( bsp_trace_t *bsptrace, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, int passent, int contentmask ) {
+	G_Trace( TRACE_BOTLIB, bsptrace, start, mins, maxs, end, passent, contentmask );
+}
+
 /*
 ==================
 G_BotInitBotLib
@@ -110,7 +119,7 @@ void G_BotInitBotLib(void) {
 
 	botlib_import.MilliSeconds = trap_Milliseconds;
 	botlib_import.Print = BotAI_Print;
-	botlib_import.Trace = BotAI_Trace;
+	botlib_import.Trace = BotImport_Trace;
 	botlib_import.EntityTrace = BotAI_EntityTrace;
 	botlib_import.PointContents = BotAI_PointContents;
 	botlib_import.inPVS = BotAI_InPVS;
@@ -423,7 +432,12 @@ unsigned short int trap_AAS_AreaTravelTime(int areanum, vec3_t start, vec3_t end
 }
 
 int trap_AAS_AreaTravelTimeToGoalArea(int areanum, vec3_t origin, int goalareanum, int travelflags) {
-	return botlib_export->aas.AAS_AreaTravelTimeToGoalArea( areanum, origin, goalareanum, travelflags );
+	int traveltime;
+
+	G_ProfileBegin( PROF_BOT_ROUTING );
+	traveltime = botlib_export->aas.AAS_AreaTravelTimeToGoalArea( areanum, origin, goalareanum, travelflags );
+	G_ProfileEnd( PROF_BOT_ROUTING );
+	return traveltime;
 }
 
 int trap_AAS_PredictRoute(void /*struct aas_predictroute_s*/ *route, int areanum, vec3_t origin,
@@ -29,6 +29,8 @@ Suite 120, Rockville, Maryland 20850 USA.
 */
 //
 #include "g_local.h"
+#include "../botlib/botlib.h"
+#include "../botlib/be_aas.h"
 
 // g_client.c -- client functions that don't happen every frame
 
@@ -80,32 +82,268 @@ void SP_info_player_intermission( gentity_t *ent ) {
 =======================================================================
 */
 
+/*
+The spawn points of each class are collected once per map, in the order
+G_Find returns them. Telefrag checks test the spots against the boxes of
+the linked players instead of doing a trap_EntitiesInBox per spot.
+*/
+#define	SPAWN_UNREACHABLE	999999
+
+typedef struct {
+	qboolean	valid;
+	int			numSpots;
+	gentity_t	*spots[MAX_SPAWN_POINTS];
+	qboolean	areasValid;
+	int			areas[MAX_SPAWN_POINTS];	// AAS areas, 0 if not in one
+} spawnPointList_t;
+
+static const char *spawnPointClassnames[SPAWN_POINTS_NUM] = {
+	"info_player_deathmatch",
+	"team_CTF_redplayer",
+	"team_CTF_blueplayer",
+	"team_CTF_redspawn",
+	"team_CTF_bluespawn"
+};
+
+static spawnPointList_t	spawnPointLists[SPAWN_POINTS_NUM];
+
 /*
 ================
-SpotWouldTelefrag
+G_InitSpawnPoints
+================
+*/
+void G_InitSpawnPoints( void ) {
+	memset( spawnPointLists, 0, sizeof( spawnPointLists ) );
+}
 
+/*
+================
+G_GetSpawnPointList
 ================
 */
-qboolean SpotWouldTelefrag( gentity_t *spot ) {
+static spawnPointList_t *G_GetSpawnPointList( spawnPointType_t type ) {
+	spawnPointList_t	*list;
+	gentity_t			*spot;
+
+	list = &spawnPointLists[type];
+
+	// the entities are still being spawned
+	if ( level.spawning ) {
+		list->valid = qfalse;
+	}
+
+	if ( !list->valid ) {
+		list->numSpots = 0;
+		list->areasValid = qfalse;
+		spot = NULL;
+		while ( ( spot = G_Find( spot, FOFS(classname), spawnPointClassnames[type] ) ) != NULL
+				&& list->numSpots < MAX_SPAWN_POINTS ) {
+			list->spots[list->numSpots++] = spot;
+		}
+		list->valid = !level.spawning;
+	}
+
+	return list;
+}
+
+/*
+================
+G_SpawnPointList
+
+Returns the number of spawn points of the type and sets *spots to them
+================
+*/
+int G_SpawnPointList( spawnPointType_t type, gentity_t ***spots ) {
+	spawnPointList_t	*list;
+
+	list = G_GetSpawnPointList( type );
+	*spots = list->spots;
+	return list->numSpots;
+}
+
+/*
+================
+G_PlayerBoxes
+
+Gets the boxes of the linked players, as trap_EntitiesInBox would see them
+================
+*/
+static int G_PlayerBoxes( vec3_t mins[MAX_CLIENTS], vec3_t maxs[MAX_CLIENTS] ) {
+	gentity_t	*ent;
 	int			i, num;
-	int			touch[MAX_GENTITIES];
-	gentity_t	*hit;
+
+	num = 0;
+	for ( i = 0, ent = g_entities; i < level.maxplayers; i++, ent++ ) {
+		if ( !ent->player || !ent->r.linked ) {
+			continue;
+		}
+		VectorCopy( ent->r.absmin, mins[num] );
+		VectorCopy( ent->r.absmax, maxs[num] );
+		num++;
+	}
+	return num;
+}
+
+/*
+================
+G_SpotsOccupied
+
+Sets occupied[i] for every spot a player would be telefragged at
+================
+*/
+void G_SpotsOccupied( gentity_t **spots, int numSpots, qboolean *occupied ) {
+	vec3_t		playerBoxMins[MAX_CLIENTS], playerBoxMaxs[MAX_CLIENTS];
 	vec3_t		mins, maxs;
+	int			i, j, numPlayers;
+
+	numPlayers = G_PlayerBoxes( playerBoxMins, playerBoxMaxs );
+
+	for ( i = 0; i < numSpots; i++ ) {
+		VectorAdd( spots[i]->s.origin, playerMins, mins );
+		VectorAdd( spots[i]->s.origin, playerMaxs, maxs );
+
+		occupied[i] = qfalse;
+		for ( j = 0; j < numPlayers; j++ ) {
+			if ( playerBoxMins[j][0] > maxs[0] || playerBoxMaxs[j][0] < mins[0]
+				|| playerBoxMins[j][1] > maxs[1] || playerBoxMaxs[j][1] < mins[1]
+				|| playerBoxMins[j][2] > maxs[2] || playerBoxMaxs[j][2] < mins[2] ) {
+				continue;
+			}
+			occupied[i] = qtrue;
+			break;
+		}
+	}
+}
+
+/*
+================
+SpotWouldTelefrag
+
+================
+*/
+qboolean SpotWouldTelefrag( gentity_t *spot ) {
+	qboolean	occupied;
+
+	G_SpotsOccupied( &spot, 1, &occupied );
+	return occupied;
+}
+
+/*
+================
+G_SpotAllowed
+
+FL_NO_BOTS and FL_NO_HUMANS
+================
+*/
+static qboolean G_SpotAllowed( gentity_t *spot, qboolean isbot ) {
+	if ( ( spot->flags & FL_NO_BOTS ) && isbot ) {
+		return qfalse;
+	}
+	if ( ( spot->flags & FL_NO_HUMANS ) && !isbot ) {
+		return qfalse;
+	}
+	return qtrue;
+}
 
-	VectorAdd( spot->s.origin, playerMins, mins );
-	VectorAdd( spot->s.origin, playerMaxs, maxs );
-	num = trap_EntitiesInBox( mins, maxs, touch, MAX_GENTITIES );
+/*
+================
+G_SpawnTravelTimes
+
+With g_spawnTravelTime, measures how far the spots are from avoidPoint
+by AAS travel time instead of straight distance. The spot areas are
+looked up once per map. Returns qfalse if there's no AAS or any of the
+points isn't in an area.
+================
+*/
+static qboolean G_SpawnTravelTimes( spawnPointList_t *list, vec3_t avoidPoint, const int *indexes, int num, float *dist ) {
+	int		i, area, avoidArea, t;
+
+	if ( !g_spawnTravelTime.integer || !trap_AAS_Initialized() ) {
+		return qfalse;
+	}
+
+	if ( !list->areasValid ) {
+		for ( i = 0; i < list->numSpots; i++ ) {
+			list->areas[i] = trap_AAS_PointAreaNum( list->spots[i]->s.origin );
+		}
+		list->areasValid = qtrue;
+	}
 
-	for (i=0 ; i<num ; i++) {
-		hit = &g_entities[touch[i]];
-		//if ( hit->player && hit->player->ps.stats[STAT_HEALTH] > 0 ) {
-		if ( hit->player) {
-			return qtrue;
+	avoidArea = trap_AAS_PointAreaNum( avoidPoint );
+	if ( !avoidArea ) {
+		return qfalse;
+	}
+
+	for ( i = 0; i < num; i++ ) {
+		area = list->areas[indexes[i]];
+		if ( !area ) {
+			return qfalse;
+		}
+		t = trap_AAS_AreaTravelTimeToGoalArea( avoidArea, avoidPoint, area, TFL_DEFAULT );
+		if ( !t && area != avoidArea ) {
+			// can't get there from the avoid point at all
+			t = SPAWN_UNREACHABLE;
 		}
+		dist[i] = t;
+	}
+
+	return qtrue;
+}
+
+/*
+================
+G_SpotFurther
 
+Spots at the same distance keep their list order
+================
+*/
+static qboolean G_SpotFurther( const float *dist, const int *indexes, int a, int b ) {
+	if ( dist[a] != dist[b] ) {
+		return dist[a] > dist[b];
 	}
+	return indexes[a] < indexes[b];
+}
+
+/*
+================
+G_SelectFurthest
+
+Puts the spot with the given rank, ordered by decreasing distance,
+at order[rank]
+================
+*/
+static void G_SelectFurthest( const float *dist, const int *indexes, int *order, int num, int rank ) {
+	int		left, right, i, store, pivot, tmp;
+
+	left = 0;
+	right = num - 1;
+	while ( left < right ) {
+		// middle element as pivot, moved to the end
+		pivot = order[( left + right ) / 2];
+		order[( left + right ) / 2] = order[right];
+		order[right] = pivot;
+
+		store = left;
+		for ( i = left; i < right; i++ ) {
+			if ( G_SpotFurther( dist, indexes, order[i], pivot ) ) {
+				tmp = order[i];
+				order[i] = order[store];
+				order[store] = tmp;
+				store++;
+			}
+		}
+		order[right] = order[store];
+		order[store] = pivot;
 
-	return qfalse;
+		if ( store == rank ) {
+			return;
+		}
+		if ( rank < store ) {
+			right = store - 1;
+		} else {
+			left = store + 1;
+		}
+	}
 }
 
 /*
@@ -115,24 +353,23 @@ SelectNearestDeathmatchSpawnPoint
 Find the spot that we DON'T want to use
 ================
 */
-#define	MAX_SPAWN_POINTS	128
 gentity_t *SelectNearestDeathmatchSpawnPoint( vec3_t from ) {
-	gentity_t	*spot;
+	gentity_t	**spots;
 	vec3_t		delta;
 	float		dist, nearestDist;
 	gentity_t	*nearestSpot;
+	int			i, numSpots;
 
 	nearestDist = 999999;
 	nearestSpot = NULL;
-	spot = NULL;
-
-	while ((spot = G_Find (spot, FOFS(classname), "info_player_deathmatch")) != NULL) {
 
-		VectorSubtract( spot->s.origin, from, delta );
+	numSpots = G_SpawnPointList( SPAWN_POINTS_DEATHMATCH, &spots );
+	for ( i = 0; i < numSpots; i++ ) {
+		VectorSubtract( spots[i]->s.origin, from, delta );
 		dist = VectorLength( delta );
 		if ( dist < nearestDist ) {
 			nearestDist = dist;
-			nearestSpot = spot;
+			nearestSpot = spots[i];
 		}
 	}
 
@@ -147,38 +384,31 @@ SelectRandomDeathmatchSpawnPoint
 go to a random point that doesn't telefrag
 ================
 */
-#define	MAX_SPAWN_POINTS	128
 gentity_t *SelectRandomDeathmatchSpawnPoint(qboolean isbot) {
-	gentity_t	*spot;
+	gentity_t	**spots;
+	qboolean	occupied[MAX_SPAWN_POINTS];
 	int			count;
 	int			selection;
-	gentity_t	*spots[MAX_SPAWN_POINTS];
-
-	count = 0;
-	spot = NULL;
+	int			i, numSpots;
+	gentity_t	*free[MAX_SPAWN_POINTS];
 
-	while((spot = G_Find (spot, FOFS(classname), "info_player_deathmatch")) != NULL && count < MAX_SPAWN_POINTS)
-	{
-		if(SpotWouldTelefrag(spot))
-			continue;
+	numSpots = G_SpawnPointList( SPAWN_POINTS_DEATHMATCH, &spots );
+	G_SpotsOccupied( spots, numSpots, occupied );
 
-		if(((spot->flags & FL_NO_BOTS) && isbot) ||
-		   ((spot->flags & FL_NO_HUMANS) && !isbot))
-		{
-			// spot is not for this human/bot player
+	count = 0;
+	for ( i = 0; i < numSpots; i++ ) {
+		if ( occupied[i] || !G_SpotAllowed( spots[i], isbot ) ) {
 			continue;
 		}
-
-		spots[count] = spot;
-		count++;
+		free[count++] = spots[i];
 	}
 
 	if ( !count ) {	// no spots that won't telefrag
-		return G_Find( NULL, FOFS(classname), "info_player_deathmatch");
+		return numSpots ? spots[0] : NULL;
 	}
 
 	selection = rand() % count;
-	return spots[ selection ];
+	return free[ selection ];
 }
 
 /*
@@ -189,81 +419,57 @@ Chooses a player start, deathmatch start, etc
 ============
 */
 gentity_t *SelectRandomFurthestSpawnPoint ( vec3_t avoidPoint, vec3_t origin, vec3_t angles, qboolean isbot ) {
+	spawnPointList_t	*list;
 	gentity_t	*spot;
 	vec3_t		delta;
-	float		dist;
-	float		list_dist[MAX_SPAWN_POINTS];
-	gentity_t	*list_spot[MAX_SPAWN_POINTS];
-	int			numSpots, rnd, i, j;
+	qboolean	occupied[MAX_SPAWN_POINTS];
+	float		dist[MAX_SPAWN_POINTS];
+	int			indexes[MAX_SPAWN_POINTS];
+	int			order[MAX_SPAWN_POINTS];
+	int			numSpots, rnd, i;
 
-	numSpots = 0;
-	spot = NULL;
-
-	while((spot = G_Find (spot, FOFS(classname), "info_player_deathmatch")) != NULL)
-	{
-		if(SpotWouldTelefrag(spot))
-			continue;
+	list = G_GetSpawnPointList( SPAWN_POINTS_DEATHMATCH );
+	G_SpotsOccupied( list->spots, list->numSpots, occupied );
 
-		if(((spot->flags & FL_NO_BOTS) && isbot) ||
-		   ((spot->flags & FL_NO_HUMANS) && !isbot))
-		{
-			// spot is not for this human/bot player
+	numSpots = 0;
+	for ( i = 0; i < list->numSpots; i++ ) {
+		if ( occupied[i] || !G_SpotAllowed( list->spots[i], isbot ) ) {
 			continue;
 		}
-
-		VectorSubtract( spot->s.origin, avoidPoint, delta );
-		dist = VectorLength( delta );
-
-		for (i = 0; i < numSpots; i++)
-		{
-			if(dist > list_dist[i])
-			{
-				if (numSpots >= MAX_SPAWN_POINTS)
-					numSpots = MAX_SPAWN_POINTS - 1;
-					
-				for(j = numSpots; j > i; j--)
-				{
-					list_dist[j] = list_dist[j-1];
-					list_spot[j] = list_spot[j-1];
-				}
-				
-				list_dist[i] = dist;
-				list_spot[i] = spot;
-				
-				numSpots++;
-				break;
-			}
-		}
-		
-		if(i >= numSpots && numSpots < MAX_SPAWN_POINTS)
-		{
-			list_dist[numSpots] = dist;
-			list_spot[numSpots] = spot;
-			numSpots++;
-		}
+		indexes[numSpots] = i;
+		order[numSpots] = numSpots;
+		numSpots++;
 	}
 	
 	if(!numSpots)
 	{
-		spot = G_Find(NULL, FOFS(classname), "info_player_deathmatch");
-
-		if (!spot)
+		if ( !list->numSpots )
 			G_Error( "Couldn't find a spawn point" );
 
+		spot = list->spots[0];
 		VectorCopy (spot->s.origin, origin);
 		origin[2] += 9;
 		VectorCopy (spot->s.angles, angles);
 		return spot;
 	}
 
+	if ( !G_SpawnTravelTimes( list, avoidPoint, indexes, numSpots, dist ) ) {
+		for ( i = 0; i < numSpots; i++ ) {
+			VectorSubtract( list->spots[indexes[i]]->s.origin, avoidPoint, delta );
+			dist[i] = VectorLength( delta );
+		}
+	}
+
 	// select a random spot from the spawn points furthest away
 	rnd = random() * (numSpots / 2);
+	G_SelectFurthest( dist, indexes, order, numSpots, rnd );
+	spot = list->spots[indexes[order[rnd]]];
 
-	VectorCopy (list_spot[rnd]->s.origin, origin);
+	VectorCopy (spot->s.origin, origin);
 	origin[2] += 9;
-	VectorCopy (list_spot[rnd]->s.angles, angles);
+	VectorCopy (spot->s.angles, angles);
 
-	return list_spot[rnd];
+	return spot;
 }
 
 /*
@@ -314,20 +520,24 @@ use normal spawn selection.
 ============
 */
 gentity_t *SelectInitialSpawnPoint( vec3_t origin, vec3_t angles, qboolean isbot ) {
+	gentity_t	**spots;
 	gentity_t	*spot;
+	int			i, numSpots;
 
 	spot = NULL;
 	
-	while ((spot = G_Find (spot, FOFS(classname), "info_player_deathmatch")) != NULL)
+	numSpots = G_SpawnPointList( SPAWN_POINTS_DEATHMATCH, &spots );
+	for ( i = 0; i < numSpots; i++ )
 	{
-		if(((spot->flags & FL_NO_BOTS) && isbot) ||
-		   ((spot->flags & FL_NO_HUMANS) && !isbot))
+		if ( !G_SpotAllowed( spots[i], isbot ) )
 		{
 			continue;
 		}
 		
-		if((spot->spawnflags & 0x01))
+		if((spots[i]->spawnflags & 0x01)) {
+			spot = spots[i];
 			break;
+		}
 	}
 
 	if (!spot || SpotWouldTelefrag(spot))
@@ -389,7 +599,7 @@ The body ques are never actually freed, they are just unlinked
 =============
 */
 void BodyQueFree( gentity_t *ent ) {
-	trap_UnlinkEntity( ent );
+	G_UnlinkEntity( ent );
 	ent->physicsObject = qfalse;
 }
 
@@ -409,7 +619,7 @@ void CopyToBodyQue( gentity_t *ent ) {
 	gentity_t		*body;
 	int			contents;
 
-	trap_UnlinkEntity (ent);
+	G_UnlinkEntity (ent);
 
 	// if player is in a nodrop area, don't leave the body
 	contents = trap_PointContents( ent->s.origin, -1 );
@@ -496,6 +706,7 @@ void CopyToBodyQue( gentity_t *ent ) {
 
 	body->nextthink = level.time + BODY_SINK_DELAY + BODY_SINK_TIME;
 	body->think = BodyQueFree;
+	G_WakeEntity( body );
 
 	body->die = body_die;
 
@@ -511,7 +722,7 @@ void CopyToBodyQue( gentity_t *ent ) {
 
 
 	VectorCopy ( body->s.pos.trBase, body->r.currentOrigin );
-	trap_LinkEntity (body);
+	G_LinkEntity (body);
 }
 
 //======================================================================
@@ -839,7 +1050,10 @@ void PlayerUserinfoChanged( int playerNum ) {
 	trap_SetConfigstring( CS_PLAYERS+playerNum, s );
 
 	// this is not the userinfo, more like the configstring actually
-	G_LogPrintf( "PlayerUserinfoChanged: %i %s\n", playerNum, s );
+	G_LogEventBegin( "PlayerUserinfoChanged" );
+	G_LogEventInt( "player", playerNum );
+	G_LogEventString( "info", s );
+	G_LogEventEnd( "PlayerUserinfoChanged: %i %s\n", playerNum, s );
 }
 
 
@@ -950,7 +1164,9 @@ char *PlayerConnect( int playerNum, qboolean firstTime, qboolean isBot, int conn
 	G_ReadSessionData( player );
 
 	// get and distribute relevant parameters
-	G_LogPrintf( "PlayerConnect: %i\n", playerNum );
+	G_LogEventBegin( "PlayerConnect" );
+	G_LogEventInt( "player", playerNum );
+	G_LogEventEnd( "PlayerConnect: %i\n", playerNum );
 	PlayerUserinfoChanged( playerNum );
 
 	// don't do the "xxx connected" messages if they were caried over from previous level
@@ -993,7 +1209,7 @@ void PlayerBegin( int playerNum ) {
 	player = level.players + playerNum;
 
 	if ( ent->r.linked ) {
-		trap_UnlinkEntity( ent );
+		G_UnlinkEntity( ent );
 	}
 	G_InitGentity( ent );
 	ent->touch = 0;
@@ -1037,7 +1253,9 @@ void PlayerBegin( int playerNum ) {
 		}
 	}
 	player->pers.initialSpawn = qfalse;
-	G_LogPrintf( "PlayerBegin: %i\n", playerNum );
+	G_LogEventBegin( "PlayerBegin" );
+	G_LogEventInt( "player", playerNum );
+	G_LogEventEnd( "PlayerBegin: %i\n", playerNum );
 
 	// count current players and rank for scoreboard
 	CalculateRanks();
@@ -1232,7 +1450,7 @@ void PlayerSpawn(gentity_t *ent) {
 			tent = G_TempEntity(ent->player->ps.origin, EV_PLAYER_TELEPORT_IN);
 			tent->s.playerNum = ent->s.playerNum;
 
-			trap_LinkEntity (ent);
+			G_LinkEntity (ent);
 		}
 	} else {
 		// move players to intermission
@@ -1321,7 +1539,9 @@ qboolean PlayerDisconnect( int playerNum, qboolean force ) {
 
 	}
 
-	G_LogPrintf( "PlayerDisconnect: %i\n", playerNum );
+	G_LogEventBegin( "PlayerDisconnect" );
+	G_LogEventInt( "player", playerNum );
+	G_LogEventEnd( "PlayerDisconnect: %i\n", playerNum );
 
 	// if we are playing in tourney mode and losing, give a win to the other player
 	if ( (g_gametype.integer == GT_TOURNAMENT )
@@ -1341,7 +1561,7 @@ qboolean PlayerDisconnect( int playerNum, qboolean force ) {
 		level.intermissiontime = 0;
 	}
 
-	trap_UnlinkEntity (ent);
+	G_UnlinkEntity (ent);
 	ent->s.modelindex = 0;
 	ent->inuse = qfalse;
 	ent->classname = "disconnected";
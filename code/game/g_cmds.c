@@ -37,72 +37,229 @@ Suite 120, Rockville, Maryland 20850 USA.
 #include "../../ui/menudef.h"			// for the voice chats
 #endif
 
+/*
+==================
+Scoreboard
+
+The scoreboard is sent as "dscores" deltas. Every field of every row
+remembers the version it last changed in, so a client that has version
+"base" only needs the fields changed after it. Base 0 asks for a full
+update. Format:
+
+dscores <base> <version> <redScore> <blueScore> <numScores> <orderFollows>
+	[<playerNum> ... numScores times if orderFollows]
+	[<playerNum> <fieldMask> <changed fields ...>] ...
+
+If the rows don't fit in one command, the rest follow in more commands
+with base and version both set to the new version.
+==================
+*/
+
+static int	scoreFields[MAX_CLIENTS][SCORE_NUM_FIELDS];
+static int	scoreFieldVersions[MAX_CLIENTS][SCORE_NUM_FIELDS];
+static int	scoreOrder[MAX_CLIENTS];
+static int	numScoreOrder;
+static int	scoreOrderVersion;
+static int	scoreVersion;
+static int	scoreFirstVersion;		// deltas from older versions aren't possible
+
+#define SCORE_FULL_UPDATE_TIME	30000
+
+/*
+==================
+G_InitScoreboard
+==================
+*/
+void G_InitScoreboard( void ) {
+	memset( scoreFields, 0, sizeof( scoreFields ) );
+	memset( scoreFieldVersions, 0, sizeof( scoreFieldVersions ) );
+	numScoreOrder = 0;
+
+	// versions only grow within a level and never overlap the versions
+	// of a level that ran before, so clients can't confuse them
+	scoreFirstVersion = level.startTime + 1;
+	scoreVersion = scoreFirstVersion;
+	scoreOrderVersion = scoreFirstVersion;
+}
+
+/*
+==================
+G_UpdateScoreboard
+
+Stamps the changed fields with a new version
+==================
+*/
+static void G_UpdateScoreboard( void ) {
+	int			fields[SCORE_NUM_FIELDS];
+	int			newVersion;
+	qboolean	changed, listed;
+	int			i, j, playerNum;
+	gplayer_t	*cl;
+
+	newVersion = scoreVersion + 1;
+	changed = qfalse;
+
+	if ( numScoreOrder != level.numConnectedPlayers ) {
+		changed = qtrue;
+		scoreOrderVersion = newVersion;
+	}
+
+	for ( i = 0; i < level.numConnectedPlayers; i++ ) {
+		playerNum = level.sortedPlayers[i];
+		cl = &level.players[playerNum];
+
+		if ( cl->pers.connected == CON_CONNECTING ) {
+			fields[SCORE_FIELD_PING] = -1;
+		} else {
+			fields[SCORE_FIELD_PING] = cl->ps.ping < 999 ? cl->ps.ping : 999;
+		}
+
+		if ( cl->accuracy_shots ) {
+			fields[SCORE_FIELD_ACCURACY] = cl->accuracy_hits * 100 / cl->accuracy_shots;
+		} else {
+			fields[SCORE_FIELD_ACCURACY] = 0;
+		}
+
+		fields[SCORE_FIELD_SCORE] = cl->ps.persistant[PERS_SCORE];
+		fields[SCORE_FIELD_TIME] = (level.time - cl->pers.enterTime)/60000;
+		fields[SCORE_FIELD_FLAGS] = 0;
+		fields[SCORE_FIELD_POWERUPS] = g_entities[playerNum].s.powerups;
+		fields[SCORE_FIELD_IMPRESSIVE] = cl->ps.persistant[PERS_IMPRESSIVE_COUNT];
+		fields[SCORE_FIELD_EXCELLENT] = cl->ps.persistant[PERS_EXCELLENT_COUNT];
+		fields[SCORE_FIELD_GAUNTLET] = cl->ps.persistant[PERS_GAUNTLET_FRAG_COUNT];
+		fields[SCORE_FIELD_DEFEND] = cl->ps.persistant[PERS_DEFEND_COUNT];
+		fields[SCORE_FIELD_ASSIST] = cl->ps.persistant[PERS_ASSIST_COUNT];
+		fields[SCORE_FIELD_PERFECT] = ( cl->ps.persistant[PERS_RANK] == 0 && cl->ps.persistant[PERS_KILLED] == 0 ) ? 1 : 0;
+		fields[SCORE_FIELD_CAPTURES] = cl->ps.persistant[PERS_CAPTURES];
+
+		// a player that wasn't on the scoreboard may not be known to the
+		// clients at all, so send all of the fields
+		listed = qfalse;
+		for ( j = 0; j < numScoreOrder; j++ ) {
+			if ( scoreOrder[j] == playerNum ) {
+				listed = qtrue;
+				break;
+			}
+		}
+
+		for ( j = 0; j < SCORE_NUM_FIELDS; j++ ) {
+			if ( !listed || scoreFields[playerNum][j] != fields[j] ) {
+				scoreFields[playerNum][j] = fields[j];
+				scoreFieldVersions[playerNum][j] = newVersion;
+				changed = qtrue;
+			}
+		}
+
+		if ( i >= numScoreOrder || scoreOrder[i] != playerNum ) {
+			scoreOrderVersion = newVersion;
+			changed = qtrue;
+		}
+	}
+
+	if ( scoreOrderVersion == newVersion ) {
+		memcpy( scoreOrder, level.sortedPlayers, level.numConnectedPlayers * sizeof( scoreOrder[0] ) );
+		numScoreOrder = level.numConnectedPlayers;
+	}
+
+	if ( changed ) {
+		scoreVersion = newVersion;
+	}
+}
+
 /*
 ==================
 DeathmatchScoreboardMessage
 
+Sends the scoreboard changes since the version the player has
 ==================
 */
 void DeathmatchScoreboardMessage( gentity_t *ent ) {
-	char		entry[1024];
+	char		header[MAX_STRING_CHARS];
+	char		entry[256];
 	char		string[1000];
 	int			stringlength;
-	int			i, j;
-	gplayer_t	*cl;
-	int			numSorted, scoreFlags, accuracy, perfect;
+	int			base, mask;
+	int			i, j, playerNum;
 
 	// don't send scores to bots (bots don't parse them)
 	if ( ent->r.svFlags & SVF_BOT ) {
 		return;
 	}
 
-	// send the latest information on all clients
+	G_ProfileBegin( PROF_SCOREBOARD );
+
+	G_UpdateScoreboard();
+
+	base = ent->player->pers.scoreVersion;
+	if ( base < scoreFirstVersion || base > scoreVersion ) {
+		// full update
+		base = 0;
+	}
+
+	// a full update now and then, so demos recorded from the middle
+	// of a match get the whole scoreboard
+	if ( level.time - ent->player->pers.scoreFullTime >= SCORE_FULL_UPDATE_TIME
+		|| level.time < ent->player->pers.scoreFullTime ) {
+		base = 0;
+	}
+	if ( !base ) {
+		ent->player->pers.scoreFullTime = level.time;
+	}
+
+	Com_sprintf( header, sizeof( header ), "dscores %i %i %i %i %i %i", base, scoreVersion,
+		level.teamScores[TEAM_RED], level.teamScores[TEAM_BLUE], numScoreOrder,
+		( !base || scoreOrderVersion > base ) ? 1 : 0 );
+
 	string[0] = 0;
 	stringlength = 0;
-	scoreFlags = 0;
 
-	numSorted = level.numConnectedPlayers;
-	
-	for (i=0 ; i < numSorted ; i++) {
-		int		ping;
+	if ( !base || scoreOrderVersion > base ) {
+		for ( i = 0; i < numScoreOrder; i++ ) {
+			Com_sprintf( entry, sizeof( entry ), " %i", scoreOrder[i] );
+			j = strlen( entry );
+			strcpy( string + stringlength, entry );
+			stringlength += j;
+		}
+	}
 
-		cl = &level.players[level.sortedPlayers[i]];
+	for ( i = 0; i < numScoreOrder; i++ ) {
+		playerNum = scoreOrder[i];
 
-		if ( cl->pers.connected == CON_CONNECTING ) {
-			ping = -1;
-		} else {
-			ping = cl->ps.ping < 999 ? cl->ps.ping : 999;
+		mask = 0;
+		for ( j = 0; j < SCORE_NUM_FIELDS; j++ ) {
+			if ( !base || scoreFieldVersions[playerNum][j] > base ) {
+				mask |= 1 << j;
+			}
+		}
+		if ( !mask ) {
+			continue;
 		}
 
-		if( cl->accuracy_shots ) {
-			accuracy = cl->accuracy_hits * 100 / cl->accuracy_shots;
+		Com_sprintf( entry, sizeof( entry ), " %i %i", playerNum, mask );
+		for ( j = 0; j < SCORE_NUM_FIELDS; j++ ) {
+			if ( mask & ( 1 << j ) ) {
+				Q_strcat( entry, sizeof( entry ), va( " %i", scoreFields[playerNum][j] ) );
+			}
 		}
-		else {
-			accuracy = 0;
+
+		j = strlen( entry );
+		if ( strlen( header ) + stringlength + j >= sizeof( string ) ) {
+			// continue in another command, on top of the version just sent
+			trap_SendServerCommand( ent-g_entities, va( "%s%s", header, string ) );
+			Com_sprintf( header, sizeof( header ), "dscores %i %i %i %i %i 0", scoreVersion, scoreVersion,
+				level.teamScores[TEAM_RED], level.teamScores[TEAM_BLUE], numScoreOrder );
+			string[0] = 0;
+			stringlength = 0;
 		}
-		perfect = ( cl->ps.persistant[PERS_RANK] == 0 && cl->ps.persistant[PERS_KILLED] == 0 ) ? 1 : 0;
-
-		Com_sprintf (entry, sizeof(entry),
-			" %i %i %i %i %i %i %i %i %i %i %i %i %i %i", level.sortedPlayers[i],
-			cl->ps.persistant[PERS_SCORE], ping, (level.time - cl->pers.enterTime)/60000,
-			scoreFlags, g_entities[level.sortedPlayers[i]].s.powerups, accuracy, 
-			cl->ps.persistant[PERS_IMPRESSIVE_COUNT],
-			cl->ps.persistant[PERS_EXCELLENT_COUNT],
-			cl->ps.persistant[PERS_GAUNTLET_FRAG_COUNT], 
-			cl->ps.persistant[PERS_DEFEND_COUNT], 
-			cl->ps.persistant[PERS_ASSIST_COUNT], 
-			perfect,
-			cl->ps.persistant[PERS_CAPTURES]);
-		j = strlen(entry);
-		if (stringlength + j >= sizeof(string))
-			break;
-		strcpy (string + stringlength, entry);
+		strcpy( string + stringlength, entry );
 		stringlength += j;
 	}
 
-	trap_SendServerCommand( ent-g_entities, va("scores %i %i %i%s", i, 
-		level.teamScores[TEAM_RED], level.teamScores[TEAM_BLUE],
-		string ) );
+	trap_SendServerCommand( ent-g_entities, va( "%s%s", header, string ) );
+
+	ent->player->pers.scoreVersion = scoreVersion;
+
+	G_ProfileEnd( PROF_SCOREBOARD );
 }
 
 
@@ -111,9 +268,16 @@ void DeathmatchScoreboardMessage( gentity_t *ent ) {
 Cmd_Score_f
 
 Request current scoreboard information
+score [version]
 ==================
 */
 void Cmd_Score_f( gentity_t *ent ) {
+	char	arg[MAX_TOKEN_CHARS];
+
+	// the version of the scoreboard the client has, or 0 for all of it
+	trap_Argv( 1, arg, sizeof( arg ) );
+	ent->player->pers.scoreVersion = atoi( arg );
+
 	DeathmatchScoreboardMessage( ent );
 }
 
@@ -934,13 +1098,21 @@ void G_Say( gentity_t *ent, gentity_t *target, int mode, const char *chatText )
 	switch ( mode ) {
 	default:
 	case SAY_ALL:
-		G_LogPrintf( "say: %s: %s\n", netname, text );
+		G_LogEventBegin( "say" );
+		G_LogEventInt( "player", playerNum );
+		G_LogEventString( "name", netname );
+		G_LogEventString( "text", text );
+		G_LogEventEnd( "say: %s: %s\n", netname, text );
 		Com_sprintf (name, sizeof(name), "%s%c%c"EC": ", netname, Q_COLOR_ESCAPE, COLOR_WHITE );
 		color = COLOR_GREEN;
 		cmd = "chat";
 		break;
 	case SAY_TEAM:
-		G_LogPrintf( "sayteam: %s: %s\n", netname, text );
+		G_LogEventBegin( "sayteam" );
+		G_LogEventInt( "player", playerNum );
+		G_LogEventString( "name", netname );
+		G_LogEventString( "text", text );
+		G_LogEventEnd( "sayteam: %s: %s\n", netname, text );
 		if (Team_GetLocationMsg(ent, location, sizeof(location)))
 			Com_sprintf (name, sizeof(name), EC"(%s%c%c"EC") (%s)"EC": ", 
 				netname, Q_COLOR_ESCAPE, COLOR_WHITE, location);
@@ -952,7 +1124,13 @@ void G_Say( gentity_t *ent, gentity_t *target, int mode, const char *chatText )
 		break;
 	case SAY_TELL:
 		if ( target && target->player ) {
-			G_LogPrintf( "tell: %s to %s: %s\n", netname, target->player->pers.netname, text );
+			G_LogEventBegin( "tell" );
+			G_LogEventInt( "player", playerNum );
+			G_LogEventInt( "target", target->s.number );
+			G_LogEventString( "name", netname );
+			G_LogEventString( "targetName", target->player->pers.netname );
+			G_LogEventString( "text", text );
+			G_LogEventEnd( "tell: %s to %s: %s\n", netname, target->player->pers.netname, text );
 		}
 		if (OnSameTeam(ent, target) && Team_GetLocationMsg(ent, location, sizeof(location)))
 			Com_sprintf (name, sizeof(name), EC"[%s%c%c"EC"] (%s)"EC": ", netname, Q_COLOR_ESCAPE, COLOR_WHITE, location );
@@ -73,7 +73,7 @@ void AddScore( gentity_t *ent, vec3_t origin, int score ) {
 	if ( g_gametype.integer == GT_TEAM ) {
 		AddTeamScore( origin, ent->player->ps.persistant[PERS_TEAM], score );
 	}
-	CalculateRanks();
+	UpdatePlayerRank( ent->s.number );
 }
 
 /*
@@ -277,7 +277,7 @@ void TossPlayerPersistantPowerups( gentity_t *ent ) {
 	powerup->r.svFlags &= ~SVF_NOCLIENT;
 	powerup->s.eFlags &= ~EF_NODRAW;
 	powerup->s.contents = CONTENTS_TRIGGER;
-	trap_LinkEntity( powerup );
+	G_LinkEntity( powerup );
 
 	ent->player->ps.stats[STAT_PERSISTANT_POWERUP] = 0;
 	ent->player->persistantPowerup = NULL;
@@ -577,7 +577,14 @@ void player_die( gentity_t *self, gentity_t *inflictor, gentity_t *attacker, int
 		obit = modNames[meansOfDeath];
 	}
 
-	G_LogPrintf("Kill: %i %i %i: %s killed %s by %s\n", 
+	G_LogEventBegin( "Kill" );
+	G_LogEventInt( "killer", killer );
+	G_LogEventInt( "victim", self->s.number );
+	G_LogEventInt( "mod", meansOfDeath );
+	G_LogEventString( "killerName", killerName );
+	G_LogEventString( "victimName", self->player->pers.netname );
+	G_LogEventString( "modName", obit );
+	G_LogEventEnd("Kill: %i %i %i: %s killed %s by %s\n", 
 		killer, self->s.number, meansOfDeath, killerName, 
 		self->player->pers.netname, obit );
 
@@ -748,7 +755,7 @@ void player_die( gentity_t *self, gentity_t *inflictor, gentity_t *attacker, int
 	// globally cycle through the different death animations
 	rndAnim = ( rndAnim + 1 ) % 3;
 
-	trap_LinkEntity (self);
+	G_LinkEntity (self);
 
 }
 
@@ -889,7 +896,7 @@ dflags		these flags are used to control how T_Damage works
 ============
 */
 
-void G_Damage( gentity_t *targ, gentity_t *inflictor, gentity_t *attacker,
+static void G_Damage_real( gentity_t *targ, gentity_t *inflictor, gentity_t *attacker,
 			   vec3_t dir, vec3_t point, int damage, int dflags, int mod ) {
 	gplayer_t	*player;
 	int			take;
@@ -930,6 +937,7 @@ void G_Damage( gentity_t *targ, gentity_t *inflictor, gentity_t *attacker,
 	if ( targ->s.eType == ET_MOVER ) {
 		if ( targ->use && targ->moverState == MOVER_POS1 ) {
 			targ->use( targ, inflictor, attacker );
+			G_WakeEntity( targ );
 		}
 		return;
 	}
@@ -1124,14 +1132,23 @@ void G_Damage( gentity_t *targ, gentity_t *inflictor, gentity_t *attacker,
 
 			targ->enemy = attacker;
 			targ->die (targ, inflictor, attacker, take, mod);
+			G_WakeEntity( targ );
 			return;
 		} else if ( targ->pain ) {
 			targ->pain (targ, attacker, take);
+			G_WakeEntity( targ );
 		}
 	}
 
 }
 
+void G_Damage( gentity_t *targ, gentity_t *inflictor, gentity_t *attacker,
+			   vec3_t dir, vec3_t point, int damage, int dflags, int mod ) {
+	G_ProfileBegin( PROF_DAMAGE );
+	G_Damage_real( targ, inflictor, attacker, dir, point, damage, dflags, mod );
+	G_ProfileEnd( PROF_DAMAGE );
+}
+
 
 /*
 ============
@@ -1154,7 +1171,7 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 	VectorScale (midpoint, 0.5, midpoint);
 
 	VectorCopy(midpoint, dest);
-	trap_Trace(&tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
+	G_TraceCached(TRACE_CAN_DAMAGE, &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
 
 	if (tr.fraction == 1.0 || tr.entityNum == targ->s.number)
 		return qtrue;
@@ -1165,7 +1182,7 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 	dest[0] += offsetmaxs[0];
 	dest[1] += offsetmaxs[1];
 	dest[2] += offsetmaxs[2];
-	trap_Trace(&tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
+	G_TraceCached(TRACE_CAN_DAMAGE, &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
 
 	if (tr.fraction == 1.0)
 		return qtrue;
@@ -1174,7 +1191,7 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 	dest[0] += offsetmaxs[0];
 	dest[1] += offsetmins[1];
 	dest[2] += offsetmaxs[2];
-	trap_Trace(&tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
+	G_TraceCached(TRACE_CAN_DAMAGE, &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
 
 	if (tr.fraction == 1.0)
 		return qtrue;
@@ -1183,7 +1200,7 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 	dest[0] += offsetmins[0];
 	dest[1] += offsetmaxs[1];
 	dest[2] += offsetmaxs[2];
-	trap_Trace(&tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
+	G_TraceCached(TRACE_CAN_DAMAGE, &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
 
 	if (tr.fraction == 1.0)
 		return qtrue;
@@ -1192,7 +1209,7 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 	dest[0] += offsetmins[0];
 	dest[1] += offsetmins[1];
 	dest[2] += offsetmaxs[2];
-	trap_Trace(&tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
+	G_TraceCached(TRACE_CAN_DAMAGE, &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
 
 	if (tr.fraction == 1.0)
 		return qtrue;
@@ -1201,7 +1218,7 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 	dest[0] += offsetmaxs[0];
 	dest[1] += offsetmaxs[1];
 	dest[2] += offsetmins[2];
-	trap_Trace(&tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
+	G_TraceCached(TRACE_CAN_DAMAGE, &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
 
 	if (tr.fraction == 1.0)
 		return qtrue;
@@ -1210,7 +1227,7 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 	dest[0] += offsetmaxs[0];
 	dest[1] += offsetmins[1];
 	dest[2] += offsetmins[2];
-	trap_Trace(&tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
+	G_TraceCached(TRACE_CAN_DAMAGE, &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
 
 	if (tr.fraction == 1.0)
 		return qtrue;
@@ -1219,7 +1236,7 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 	dest[0] += offsetmins[0];
 	dest[1] += offsetmaxs[1];
 	dest[2] += offsetmins[2];
-	trap_Trace(&tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
+	G_TraceCached(TRACE_CAN_DAMAGE, &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
 
 	if (tr.fraction == 1.0)
 		return qtrue;
@@ -1228,7 +1245,7 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 	dest[0] += offsetmins[0];
 	dest[1] += offsetmins[1];
 	dest[2] += offsetmins[2];
-	trap_Trace(&tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
+	G_TraceCached(TRACE_CAN_DAMAGE, &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID);
 
 	if (tr.fraction == 1.0)
 		return qtrue;
@@ -262,10 +262,10 @@ typedef struct {
 	int			voteCount;			// to prevent people from constantly calling votes
 	int			teamVoteCount;		// to prevent people from constantly calling votes
 	qboolean	teamInfo;			// send team overlay updates?
+	int			scoreVersion;		// scoreboard version last sent to the client
+	int			scoreFullTime;		// level.time of the last full scoreboard
 } playerPersistant_t;
 
-#define MAX_PLAYER_MARKERS 17
-
 typedef struct {
 	vec3_t		mins;
 	vec3_t		maxs;
@@ -287,9 +287,7 @@ struct gplayer_s {
 
 	qboolean	noclip;
 
-	// history for backward reconcile
-	int			topMarker;
-	playerMarker_t	playerMarkers[MAX_PLAYER_MARKERS];
+	// position before the backward reconcile time shift
 	playerMarker_t	backupMarker;
 
 	int			frameOffset;		// an approximation of the actual server time we received this
@@ -351,6 +349,11 @@ struct gplayer_s {
 #endif
 
 	char		*areabits;
+
+	// Team_GetLocation result, only looked up again after moving
+	gentity_t	*location;
+	vec3_t		locationOrigin;
+	qboolean	locationValid;
 };
 
 
@@ -404,6 +407,8 @@ typedef struct {
 	int			numNonSpectatorPlayers;	// includes connecting players
 	int			numPlayingPlayers;		// connected, non-spectators
 	int			sortedPlayers[MAX_CLIENTS];		// sorted by score
+	qboolean	scoresDirty;			// send the scoreboard at the end of the frame
+	int			scoresSendTime;			// not before this time, see g_scoreboardRate
 	int			follow1, follow2;		// playerNums for auto-follow spectators
 
 	int			snd_fry;				// sound index for standing in lava
@@ -501,12 +506,15 @@ void SaveRegisteredItems( void );
 //
 // g_utils.c
 //
+void	G_InitConfigstringIndexes( void );
 int		G_FindConfigstringIndex( char *name, int start, int max, qboolean create );
 int		G_ModelIndex( char *name );
 int		G_SoundIndex( char *name );
 void	trap_SendServerCommand( int playerNum, char *cmd );
 void	G_TeamCommand( team_t team, char *cmd );
 void	G_KillBox (gentity_t *ent);
+void G_InitEntityNameIndex( void );
+void G_UpdateEntityNameIndex( void );
 gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match);
 gentity_t *G_PickTarget (char *targetname);
 void	G_UseTargets (gentity_t *ent, gentity_t *activator);
@@ -514,6 +522,7 @@ void	G_SetBrushModel( gentity_t *ent, const char *name );
 void	G_SetMovedir ( vec3_t angles, vec3_t movedir);
 
 void	G_InitGentity( gentity_t *e );
+void	G_InitEntityFreeQueue( void );
 gentity_t	*G_Spawn (void);
 gentity_t *G_TempEntity( vec3_t origin, int event );
 void	G_Sound( gentity_t *ent, int channel, int soundIndex );
@@ -576,6 +585,8 @@ gentity_t *fire_prox( gentity_t *self, vec3_t start, vec3_t aimdir );
 //
 // g_mover.c
 //
+void G_InitMoverCaches( void );
+void G_MoverCacheLinked( gentity_t *ent );
 void G_RunMover( gentity_t *ent );
 void Touch_DoorTrigger( gentity_t *ent, gentity_t *other, trace_t *trace );
 
@@ -608,6 +619,18 @@ void Weapon_HookThink (gentity_t *ent);
 //
 // g_client.c
 //
+#define	MAX_SPAWN_POINTS	256
+
+typedef enum {
+	SPAWN_POINTS_DEATHMATCH,
+	SPAWN_POINTS_RED_PLAYER,
+	SPAWN_POINTS_BLUE_PLAYER,
+	SPAWN_POINTS_RED_SPAWN,
+	SPAWN_POINTS_BLUE_SPAWN,
+
+	SPAWN_POINTS_NUM
+} spawnPointType_t;
+
 int TeamCount( int ignorePlayerNum, team_t team );
 int TeamLeader( int team );
 team_t PickTeam( int ignorePlayerNum );
@@ -621,20 +644,113 @@ void PlayerSpawn( gentity_t *ent );
 void player_die (gentity_t *self, gentity_t *inflictor, gentity_t *attacker, int damage, int mod);
 void AddScore( gentity_t *ent, vec3_t origin, int score );
 void CalculateRanks( void );
+void UpdatePlayerRank( int playerNum );
 qboolean SpotWouldTelefrag( gentity_t *spot );
+void G_InitSpawnPoints( void );
+int G_SpawnPointList( spawnPointType_t type, gentity_t ***spots );
+void G_SpotsOccupied( gentity_t **spots, int numSpots, qboolean *occupied );
 
 //
 // g_unlagged.c
 //
+void G_InitHistory( void );
 void G_ResetHistory( gentity_t *ent );
 void G_StoreHistory( gentity_t *ent );
 void G_TimeShiftAllClients( int time, gentity_t *skip );
 void G_UnTimeShiftAllClients( gentity_t *skip );
 void G_DoTimeShiftFor( gentity_t *ent );
+void G_DoTimeShiftForRay( gentity_t *ent, const vec3_t start, const vec3_t end, float spread );
 void G_UndoTimeShiftFor( gentity_t *ent );
 void G_UnTimeShiftClient( gentity_t *client );
 void G_PredictPlayerMove( gentity_t *ent, float frametime );
 
+//
+// g_profile.c
+//
+typedef enum {
+	PROF_FRAME,
+	PROF_RUN_ENTITIES,
+	PROF_RUN_MISSILE,
+	PROF_RUN_ITEM,
+	PROF_RUN_MOVER,
+	PROF_RUN_PLAYER,
+	PROF_RUN_THINK,
+	PROF_PLAYER_THINK,
+	PROF_PMOVE,
+	PROF_DAMAGE,
+	PROF_SCOREBOARD,
+	PROF_BOTAI_FRAME,
+	PROF_BOTLIB_UPDATE,
+	PROF_BOTAI_REGULAR_UPDATE,
+	PROF_BOTAI,
+	PROF_BOT_ROUTING,
+
+	PROF_NUM_SECTIONS
+} profileSection_t;
+
+void G_ProfileStartFrame( void );
+void G_ProfileBegin( profileSection_t section );
+void G_ProfileEnd( profileSection_t section );
+void G_ProfileTrace( void );
+void Svcmd_Profile_f( void );
+
+//
+// g_pmovebench.c
+//
+void Svcmd_PmoveBench_f( void );
+
+//
+// g_trace.c
+//
+typedef enum {
+	TRACE_PMOVE,
+	TRACE_BULLET_FIRE,
+	TRACE_SHOTGUN,
+	TRACE_RAILGUN,
+	TRACE_LIGHTNING,
+	TRACE_GAUNTLET,
+	TRACE_CAN_DAMAGE,
+	TRACE_MISSILE,
+	TRACE_ITEM,
+	TRACE_MOVER_PUSH,
+	TRACE_TARGET,
+	TRACE_TEAM,
+	TRACE_UNLAGGED,
+	TRACE_BOTAI,
+	TRACE_BOT_VISIBLE,
+	TRACE_BOT_GOAL,
+	TRACE_BOT_MOVE,
+	TRACE_BOTLIB,
+
+	TRACE_NUM_TAGS
+} traceTag_t;
+
+void G_TraceStatsStartFrame( void );
+void G_Trace( traceTag_t tag, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask );
+void G_TraceCapsule( traceTag_t tag, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask );
+void G_TraceCached( traceTag_t tag, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask );
+void G_InitTriggerGrid( void );
+int G_TriggersInBox( const vec3_t mins, const vec3_t maxs, int *list, int maxcount );
+void G_LinkEntity( gentity_t *ent );
+void G_UnlinkEntity( gentity_t *ent );
+void G_PmoveTrace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask );
+void G_PmoveTraceCapsule( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask );
+void G_TraceStatsLogExit( void );
+void Svcmd_TraceStats_f( void );
+
+//
+// g_log.c
+//
+void G_OpenLog( void );
+void G_CloseLog( void );
+void G_LogFlush( void );
+void G_LogEndFrame( void );
+void QDECL G_LogPrintf( const char *fmt, ... ) __attribute__ ((format (printf, 1, 2)));
+void G_LogEventBegin( const char *event );
+void G_LogEventInt( const char *key, int value );
+void G_LogEventString( const char *key, const char *value );
+void QDECL G_LogEventEnd( const char *fmt, ... ) __attribute__ ((format (printf, 1, 2)));
+
 //
 // g_svcmds.c
 //
@@ -656,6 +772,7 @@ void G_StartKamikaze( gentity_t *ent );
 // g_cmds.c
 //
 void DeathmatchScoreboardMessage( gentity_t *ent );
+void G_InitScoreboard( void );
 char *ConcatArgs( int start );
 qboolean StringIsInteger( const char * s );
 
@@ -667,8 +784,9 @@ void FindIntermissionPoint( void );
 void SetLeader(int team, int player);
 void CheckTeamLeader( int team );
 void G_RunThink (gentity_t *ent);
+void G_InitEntityRunLists( void );
+void G_WakeEntity( gentity_t *ent );
 void AddTournamentQueue(gplayer_t *player);
-void QDECL G_LogPrintf( const char *fmt, ... ) __attribute__ ((format (printf, 1, 2)));
 void SendScoreboardMessageToAllClients( void );
 void QDECL G_DPrintf( const char *fmt, ... ) __attribute__ ((format (printf, 1, 2)));
 void QDECL G_Printf( const char *fmt, ... ) __attribute__ ((format (printf, 1, 2)));
@@ -785,6 +903,16 @@ extern	vmCvar_t	g_forcerespawn;
 extern	vmCvar_t	g_inactivity;
 extern	vmCvar_t	g_debugMove;
 extern	vmCvar_t	g_debugDamage;
+extern	vmCvar_t	g_profile;
+extern	vmCvar_t	g_traceStats;
+extern	vmCvar_t	g_traceCache;
+extern	vmCvar_t	g_spawnTravelTime;
+extern	vmCvar_t	g_unlaggedRayFilter;
+extern	vmCvar_t	g_scoreboardRate;
+extern	vmCvar_t	g_logfile;
+extern	vmCvar_t	g_logfileSync;
+extern	vmCvar_t	g_logFormat;
+extern	vmCvar_t	g_logFlushTime;
 extern	vmCvar_t	g_weaponRespawn;
 extern	vmCvar_t	g_weaponTeamRespawn;
 extern	vmCvar_t	g_synchronousClients;
@@ -795,6 +923,7 @@ extern	vmCvar_t	g_allowVote;
 extern	vmCvar_t	g_teamAutoJoin;
 extern	vmCvar_t	g_teamForceBalance;
 extern	vmCvar_t	g_banIPs;
+extern	vmCvar_t	g_banIPFiles;
 extern	vmCvar_t	g_filterBan;
 extern	vmCvar_t	g_obeliskHealth;
 extern	vmCvar_t	g_obeliskRegenPeriod;
@@ -0,0 +1,434 @@
+/*
+===========================================================================
+Copyright (C) 1999-2010 id Software LLC, a ZeniMax Media company.
+
+This file is part of Spearmint Source Code.
+
+Spearmint Source Code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 3 of the License,
+or (at your option) any later version.
+
+Spearmint Source Code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Spearmint Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, Spearmint Source Code is also subject to certain additional terms.
+You should have received a copy of these additional terms immediately following
+the terms and conditions of the GNU General Public License.  If not, please
+request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional
+terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+Suite 120, Rockville, Maryland 20850 USA.
+===========================================================================
+*/
+//
+// g_log.c -- buffered game log
+//
+// Log lines are collected in memory and written out in one piece at the end
+// of a frame, at most g_logFlushTime msec after the oldest unwritten line,
+// or when the buffer fills up. g_logsync 1 writes every line right away.
+//
+// g_logFormat 1 writes one JSON object per line instead of the classic
+// text log. Events logged through G_LogEventBegin / G_LogEventEnd get a
+// field per value, anything else logged with G_LogPrintf is written as
+// {"time":..,"event":"<word before the first colon>","text":"<rest>"}.
+// The format is picked up when the log is opened at map start.
+
+#include "g_local.h"
+
+#define LOG_BUFFER_SIZE		0x10000
+#define LOG_LINE_SIZE		4096
+
+typedef enum {
+	LOG_FORMAT_TEXT,
+	LOG_FORMAT_JSON
+} logFormat_t;
+
+static logFormat_t	logFormat;
+
+static char			logBuffer[LOG_BUFFER_SIZE];
+static int			logBufferUsed;
+static int			logBufferTime;		// trap_Milliseconds of the oldest unwritten line
+
+static char			logEvent[LOG_LINE_SIZE];
+static int			logEventLength;
+static qboolean		logEventActive;
+
+static char			logLine[LOG_LINE_SIZE];
+static int			logLineLength;
+
+/*
+================
+G_LogFlush
+
+Writes out everything that is buffered
+================
+*/
+void G_LogFlush( void ) {
+	if ( !logBufferUsed ) {
+		return;
+	}
+	if ( level.logFile ) {
+		trap_FS_Write( logBuffer, logBufferUsed, level.logFile );
+	}
+	logBufferUsed = 0;
+}
+
+/*
+================
+G_LogWrite
+================
+*/
+static void G_LogWrite( const char *data, int length ) {
+	if ( !level.logFile || length <= 0 ) {
+		return;
+	}
+
+	if ( g_logfileSync.integer ) {
+		G_LogFlush();
+		trap_FS_Write( data, length, level.logFile );
+		return;
+	}
+
+	if ( logBufferUsed + length > LOG_BUFFER_SIZE ) {
+		G_LogFlush();
+	}
+	if ( length > LOG_BUFFER_SIZE ) {
+		trap_FS_Write( data, length, level.logFile );
+		return;
+	}
+
+	if ( !logBufferUsed ) {
+		logBufferTime = trap_Milliseconds();
+	}
+	memcpy( logBuffer + logBufferUsed, data, length );
+	logBufferUsed += length;
+}
+
+/*
+================
+G_LogEndFrame
+
+Flushes the buffer once its oldest line has waited g_logFlushTime msec
+================
+*/
+void G_LogEndFrame( void ) {
+	if ( !logBufferUsed ) {
+		return;
+	}
+	if ( trap_Milliseconds() - logBufferTime >= g_logFlushTime.integer ) {
+		G_LogFlush();
+	}
+}
+
+/*
+================
+G_LogAppend
+
+Appends all of s to dest or nothing, always leaving room to close the
+JSON object with G_LogFinishJSON
+================
+*/
+static qboolean G_LogAppend( char *dest, int *length, int size, const char *s ) {
+	int		l;
+
+	l = strlen( s );
+	if ( *length + l > size - 3 ) {
+		return qfalse;
+	}
+	memcpy( dest + *length, s, l + 1 );
+	*length += l;
+	return qtrue;
+}
+
+/*
+================
+G_LogAppendJSONString
+
+Appends s as a quoted JSON string, cut off at a whole character if it
+doesn't fit. Appends nothing if not even the quotes fit.
+================
+*/
+static qboolean G_LogAppendJSONString( char *dest, int *length, int size, const char *s ) {
+	char	escape[8];
+	int		c;
+
+	// room for both quotes
+	if ( !G_LogAppend( dest, length, size - 1, "\"" ) ) {
+		return qfalse;
+	}
+	for ( ; *s; s++ ) {
+		c = *(const unsigned char *)s;
+
+		if ( c == '"' || c == '\\' ) {
+			escape[0] = '\\';
+			escape[1] = c;
+			escape[2] = 0;
+		} else if ( c == '\n' ) {
+			Q_strncpyz( escape, "\\n", sizeof( escape ) );
+		} else if ( c == '\t' ) {
+			Q_strncpyz( escape, "\\t", sizeof( escape ) );
+		} else if ( c < ' ' || c >= 127 ) {
+			// bytes above 127 aren't valid UTF-8 on their own
+			Com_sprintf( escape, sizeof( escape ), "\\u%04x", c );
+		} else {
+			escape[0] = c;
+			escape[1] = 0;
+		}
+		// leave room for the closing quote
+		if ( !G_LogAppend( dest, length, size - 1, escape ) ) {
+			break;
+		}
+	}
+	G_LogAppend( dest, length, size, "\"" );
+	return qtrue;
+}
+
+/*
+================
+G_LogStartJSON
+
+Starts a JSON object with the time and event fields
+================
+*/
+static void G_LogStartJSON( char *dest, int *length, int size, const char *event ) {
+	*length = 0;
+	G_LogAppend( dest, length, size, va( "{\"time\":%d,\"event\":", level.time - level.startTime ) );
+	G_LogAppendJSONString( dest, length, size, event );
+}
+
+/*
+================
+G_LogFinishJSON
+================
+*/
+static void G_LogFinishJSON( char *dest, int *length, int size ) {
+	// G_LogAppend left room for this
+	dest[(*length)++] = '}';
+	dest[(*length)++] = '\n';
+	dest[*length] = 0;
+	G_LogWrite( dest, *length );
+}
+
+/*
+================
+G_LogLine
+
+Writes a line of the classic log, or its generic JSON form
+================
+*/
+static void G_LogLine( const char *text ) {
+	char	string[LOG_LINE_SIZE];
+	char	event[64];
+	int		length, i;
+	int		min, tens, sec;
+
+	if ( g_dedicated.integer ) {
+		G_Printf( "%s", text );
+	}
+
+	if ( !level.logFile ) {
+		return;
+	}
+
+	if ( logFormat == LOG_FORMAT_JSON ) {
+		// "Event: text", anything else is just text
+		for ( i = 0; i < sizeof( event ) - 1; i++ ) {
+			if ( !text[i] || text[i] == ':' || text[i] <= ' ' ) {
+				break;
+			}
+			event[i] = text[i];
+		}
+		event[i] = 0;
+
+		if ( i && text[i] == ':' ) {
+			text += i + 1;
+			while ( *text == ' ' ) {
+				text++;
+			}
+		} else {
+			Q_strncpyz( event, "print", sizeof( event ) );
+		}
+
+		// drop the trailing newline
+		Q_strncpyz( string, text, sizeof( string ) );
+		length = strlen( string );
+		if ( length && string[length - 1] == '\n' ) {
+			string[length - 1] = 0;
+		}
+
+		G_LogStartJSON( logLine, &logLineLength, sizeof( logLine ), event );
+		if ( !G_LogAppend( logLine, &logLineLength, sizeof( logLine ), ",\"text\":" )
+			|| !G_LogAppendJSONString( logLine, &logLineLength, sizeof( logLine ), string ) ) {
+			G_LogStartJSON( logLine, &logLineLength, sizeof( logLine ), event );
+		}
+		G_LogFinishJSON( logLine, &logLineLength, sizeof( logLine ) );
+		return;
+	}
+
+	sec = ( level.time - level.startTime ) / 1000;
+
+	min = sec / 60;
+	sec -= min * 60;
+	tens = sec / 10;
+	sec -= tens * 10;
+
+	Com_sprintf( string, sizeof( string ), "%3i:%i%i %s", min, tens, sec, text );
+	G_LogWrite( string, strlen( string ) );
+}
+
+/*
+=================
+G_LogPrintf
+
+Print to the logfile with a time stamp if it is open
+=================
+*/
+void QDECL G_LogPrintf( const char *fmt, ... ) {
+	va_list		argptr;
+	char		text[LOG_LINE_SIZE];
+
+	va_start( argptr, fmt );
+	Q_vsnprintf( text, sizeof( text ), fmt, argptr );
+	va_end( argptr );
+
+	G_LogLine( text );
+}
+
+/*
+================
+G_LogEventBegin
+
+Starts a structured event. Add its values with G_LogEventInt and
+G_LogEventString, then finish it with G_LogEventEnd and the classic
+text line, which is what ends up in a text log and on the console.
+================
+*/
+void G_LogEventBegin( const char *event ) {
+	logEventActive = ( level.logFile && logFormat == LOG_FORMAT_JSON );
+	if ( !logEventActive ) {
+		return;
+	}
+	G_LogStartJSON( logEvent, &logEventLength, sizeof( logEvent ), event );
+}
+
+/*
+================
+G_LogEventInt
+================
+*/
+void G_LogEventInt( const char *key, int value ) {
+	if ( !logEventActive ) {
+		return;
+	}
+	G_LogAppend( logEvent, &logEventLength, sizeof( logEvent ), va( ",\"%s\":%d", key, value ) );
+}
+
+/*
+================
+G_LogEventString
+================
+*/
+void G_LogEventString( const char *key, const char *value ) {
+	int		length;
+
+	if ( !logEventActive ) {
+		return;
+	}
+	length = logEventLength;
+	if ( !G_LogAppend( logEvent, &logEventLength, sizeof( logEvent ), va( ",\"%s\":", key ) )
+		|| !G_LogAppendJSONString( logEvent, &logEventLength, sizeof( logEvent ), value ) ) {
+		// drop the whole value rather than leave a key without one
+		logEventLength = length;
+		logEvent[length] = 0;
+	}
+}
+
+/*
+================
+G_LogEventEnd
+================
+*/
+void QDECL G_LogEventEnd( const char *fmt, ... ) {
+	va_list		argptr;
+	char		text[LOG_LINE_SIZE];
+
+	va_start( argptr, fmt );
+	Q_vsnprintf( text, sizeof( text ), fmt, argptr );
+	va_end( argptr );
+
+	if ( !logEventActive ) {
+		G_LogLine( text );
+		return;
+	}
+	logEventActive = qfalse;
+
+	if ( g_dedicated.integer ) {
+		G_Printf( "%s", text );
+	}
+	G_LogFinishJSON( logEvent, &logEventLength, sizeof( logEvent ) );
+}
+
+/*
+================
+G_OpenLog
+================
+*/
+void G_OpenLog( void ) {
+	char	serverinfo[MAX_INFO_STRING];
+
+	logBufferUsed = 0;
+	logEventActive = qfalse;
+
+	if ( g_gametype.integer == GT_SINGLE_PLAYER || !g_logfile.string[0] ) {
+		G_Printf( "Not logging to disk.\n" );
+		return;
+	}
+
+	if ( g_logfileSync.integer ) {
+		trap_FS_FOpenFile( g_logfile.string, &level.logFile, FS_APPEND_SYNC );
+	} else {
+		trap_FS_FOpenFile( g_logfile.string, &level.logFile, FS_APPEND );
+	}
+	if ( !level.logFile ) {
+		G_Printf( "WARNING: Couldn't open logfile: %s\n", g_logfile.string );
+		return;
+	}
+
+	logFormat = g_logFormat.integer ? LOG_FORMAT_JSON : LOG_FORMAT_TEXT;
+
+	trap_GetServerinfo( serverinfo, sizeof( serverinfo ) );
+
+	if ( logFormat == LOG_FORMAT_TEXT ) {
+		G_LogPrintf( "------------------------------------------------------------\n" );
+	}
+	G_LogEventBegin( "InitGame" );
+	G_LogEventString( "serverinfo", serverinfo );
+	G_LogEventEnd( "InitGame: %s\n", serverinfo );
+}
+
+/*
+================
+G_CloseLog
+================
+*/
+void G_CloseLog( void ) {
+	if ( !level.logFile ) {
+		return;
+	}
+
+	G_LogPrintf( "ShutdownGame:\n" );
+	if ( logFormat == LOG_FORMAT_TEXT ) {
+		G_LogPrintf( "------------------------------------------------------------\n" );
+	}
+
+	G_LogFlush();
+	trap_FS_FCloseFile( level.logFile );
+	level.logFile = 0;
+}
@@ -80,6 +80,12 @@ vmCvar_t	g_forcerespawn;
 vmCvar_t	g_inactivity;
 vmCvar_t	g_debugMove;
 vmCvar_t	g_debugDamage;
+vmCvar_t	g_profile;
+vmCvar_t	g_traceStats;
+vmCvar_t	g_traceCache;
+vmCvar_t	g_spawnTravelTime;
+vmCvar_t	g_unlaggedRayFilter;
+vmCvar_t	g_scoreboardRate;
 vmCvar_t	g_weaponRespawn;
 vmCvar_t	g_weaponTeamRespawn;
 vmCvar_t	g_motd;
@@ -89,12 +95,15 @@ vmCvar_t	g_doWarmup;
 vmCvar_t	g_restarted;
 vmCvar_t	g_logfile;
 vmCvar_t	g_logfileSync;
+vmCvar_t	g_logFormat;
+vmCvar_t	g_logFlushTime;
 vmCvar_t	g_podiumDist;
 vmCvar_t	g_podiumDrop;
 vmCvar_t	g_allowVote;
 vmCvar_t	g_teamAutoJoin;
 vmCvar_t	g_teamForceBalance;
 vmCvar_t	g_banIPs;
+vmCvar_t	g_banIPFiles;
 vmCvar_t	g_filterBan;
 vmCvar_t	g_smoothClients;
 vmCvar_t	pmove_overbounce;
@@ -149,10 +158,13 @@ static cvarTable_t		gameCvarTable[] = {
 	{ &g_doWarmup, "g_doWarmup", "0", CVAR_ARCHIVE, GCF_TRACK_CHANGE, RANGE_BOOL },
 	{ &g_logfile, "g_log", "games.log", CVAR_ARCHIVE, 0, RANGE_ALL },
 	{ &g_logfileSync, "g_logsync", "0", CVAR_ARCHIVE, 0, RANGE_ALL },
+	{ &g_logFormat, "g_logFormat", "0", CVAR_ARCHIVE, 0, RANGE_INT(0, 1) },
+	{ &g_logFlushTime, "g_logFlushTime", "1000", CVAR_ARCHIVE, 0, RANGE_INT(0, 10000) },
 
 	{ &g_password, "g_password", "", CVAR_USERINFO, 0, RANGE_ALL },
 
 	{ &g_banIPs, "g_banIPs", "", CVAR_ARCHIVE, 0, RANGE_ALL },
+	{ &g_banIPFiles, "g_banIPFiles", "", 0, 0, RANGE_ALL },
 	{ &g_filterBan, "g_filterBan", "1", CVAR_ARCHIVE, 0, RANGE_ALL },
 
 	{ &g_needpass, "g_needpass", "0", CVAR_SERVERINFO | CVAR_ROM, 0, RANGE_BOOL },
@@ -169,6 +181,12 @@ static cvarTable_t		gameCvarTable[] = {
 	{ &g_inactivity, "g_inactivity", "0", 0, GCF_TRACK_CHANGE, RANGE_BOOL },
 	{ &g_debugMove, "g_debugMove", "0", 0, 0, RANGE_BOOL },
 	{ &g_debugDamage, "g_debugDamage", "0", 0, 0, RANGE_BOOL },
+	{ &g_profile, "g_profile", "0", 0, 0, RANGE_BOOL },
+	{ &g_traceStats, "g_traceStats", "0", 0, 0, RANGE_BOOL },
+	{ &g_traceCache, "g_traceCache", "0", 0, 0, RANGE_BOOL },
+	{ &g_spawnTravelTime, "g_spawnTravelTime", "0", CVAR_ARCHIVE, 0, RANGE_BOOL },
+	{ &g_unlaggedRayFilter, "g_unlaggedRayFilter", "1", 0, 0, RANGE_BOOL },
+	{ &g_scoreboardRate, "g_scoreboardRate", "2", 0, 0, RANGE_INT(1, 20) },
 	{ &g_motd, "g_motd", "", 0, 0, RANGE_ALL },
 
 	{ &g_podiumDist, "g_podiumDist", "80", 0, 0, RANGE_ALL },
@@ -262,7 +280,14 @@ Q_EXPORT intptr_t vmMain( int command, int arg0, int arg1, int arg2, int arg3, i
 	case GAME_MAP_RESTART:
 		return G_MapRestart( arg0, arg1 );
 	case BOTAI_START_FRAME:
-		return BotAIStartFrame( arg0 );
+		{
+			int		result;
+
+			G_ProfileBegin( PROF_BOTAI_FRAME );
+			result = BotAIStartFrame( arg0 );
+			G_ProfileEnd( PROF_BOTAI_FRAME );
+			return result;
+		}
 	case GAME_CONSOLE_COMPLETEARGUMENT:
 		return G_ConsoleCompleteArgument(arg0);
 	default:
@@ -504,27 +529,11 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	level.time = levelTime;
 	level.startTime = levelTime;
 
-	level.snd_fry = G_SoundIndex("sound/player/fry.wav");	// FIXME standing in lava / slime
+	G_InitConfigstringIndexes();
 
-	if ( g_gametype.integer != GT_SINGLE_PLAYER && g_logfile.string[0] ) {
-		if ( g_logfileSync.integer ) {
-			trap_FS_FOpenFile( g_logfile.string, &level.logFile, FS_APPEND_SYNC );
-		} else {
-			trap_FS_FOpenFile( g_logfile.string, &level.logFile, FS_APPEND );
-		}
-		if ( !level.logFile ) {
-			G_Printf( "WARNING: Couldn't open logfile: %s\n", g_logfile.string );
-		} else {
-			char	serverinfo[MAX_INFO_STRING];
+	level.snd_fry = G_SoundIndex("sound/player/fry.wav");	// FIXME standing in lava / slime
 
-			trap_GetServerinfo( serverinfo, sizeof( serverinfo ) );
-
-			G_LogPrintf("------------------------------------------------------------\n" );
-			G_LogPrintf("InitGame: %s\n", serverinfo );
-		}
-	} else {
-		G_Printf( "Not logging to disk.\n" );
-	}
+	G_OpenLog();
 
 	G_InitWorldSession();
 
@@ -533,6 +542,14 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	// initialize all entities for this game
 	memset( g_entities, 0, MAX_GENTITIES * sizeof(g_entities[0]) );
 	level.gentities = g_entities;
+	G_InitEntityNameIndex();
+	G_InitEntityFreeQueue();
+	G_InitEntityRunLists();
+	G_InitTriggerGrid();
+	G_InitMoverCaches();
+	G_InitSpawnPoints();
+	G_InitHistory();
+	G_InitScoreboard();
 
 	// initialize all client connections for this game
 	level.maxconnections = g_maxplayers.integer;
@@ -580,6 +597,9 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	// general initialization
 	G_FindTeams();
 
+	// G_FindTeams moves targetnames between team members
+	G_UpdateEntityNameIndex();
+
 	// make sure we have flags for CTF, etc
 	if( g_gametype.integer >= GT_TEAM ) {
 		G_CheckTeamItems();
@@ -616,12 +636,7 @@ G_ShutdownGame
 void G_ShutdownGame( int restart ) {
 	G_DPrintf ("==== ShutdownGame ====\n");
 
-	if ( level.logFile ) {
-		G_LogPrintf("ShutdownGame:\n" );
-		G_LogPrintf("------------------------------------------------------------\n" );
-		trap_FS_FCloseFile( level.logFile );
-		level.logFile = 0;
-	}
+	G_CloseLog();
 
 	// write all the player session data so we can get it back
 	G_WriteSessionData();
@@ -978,21 +993,129 @@ int QDECL SortRanks( const void *a, const void *b ) {
 	return 0;
 }
 
+// position of each player in level.sortedPlayers, only valid while
+// level.sortedPlayers[sortedPlayerIndex[playerNum]] == playerNum
+static int	sortedPlayerIndex[MAX_CLIENTS];
+
+#define SORTED_SCORE( i )	( level.players[ level.sortedPlayers[i] ].ps.persistant[PERS_SCORE] )
+
+/*
+============
+SetPlayerRanks
+
+Sets the rank of the playing players from "first" to "last" in
+level.sortedPlayers, widened to whole groups of tied players so the
+tied flags come out right.
+============
+*/
+static void SetPlayerRanks( int first, int last ) {
+	int		i;
+	int		rank;
+
+	if ( level.numPlayingPlayers <= 0 ) {
+		return;
+	}
+
+	// the neighbours may have been tied with a moved player
+	if ( first > 0 ) {
+		first--;
+	}
+	if ( last < level.numPlayingPlayers - 1 ) {
+		last++;
+	}
+	while ( first > 0 && SORTED_SCORE( first - 1 ) == SORTED_SCORE( first ) ) {
+		first--;
+	}
+	while ( last < level.numPlayingPlayers - 1 && SORTED_SCORE( last + 1 ) == SORTED_SCORE( last ) ) {
+		last++;
+	}
+
+	rank = first;
+	for ( i = first; i <= last; i++ ) {
+		if ( i == first || SORTED_SCORE( i ) != SORTED_SCORE( i - 1 ) ) {
+			rank = i;
+			// assume we aren't tied until the next player is checked
+			level.players[ level.sortedPlayers[i] ].ps.persistant[PERS_RANK] = rank;
+		} else {
+			// we are tied with the previous player
+			level.players[ level.sortedPlayers[i-1] ].ps.persistant[PERS_RANK] = rank | RANK_TIED_FLAG;
+			level.players[ level.sortedPlayers[i] ].ps.persistant[PERS_RANK] = rank | RANK_TIED_FLAG;
+		}
+		if ( g_gametype.integer == GT_SINGLE_PLAYER && level.numPlayingPlayers == 1 ) {
+			level.players[ level.sortedPlayers[i] ].ps.persistant[PERS_RANK] = rank | RANK_TIED_FLAG;
+		}
+	}
+}
+
+/*
+============
+SetTeamRanks
+
+In team games, rank is just the order of the teams, 0=red, 1=blue, 2=tied
+============
+*/
+static void SetTeamRanks( void ) {
+	int		i;
+	int		rank;
+
+	if ( level.teamScores[TEAM_RED] == level.teamScores[TEAM_BLUE] ) {
+		rank = 2;
+	} else if ( level.teamScores[TEAM_RED] > level.teamScores[TEAM_BLUE] ) {
+		rank = 0;
+	} else {
+		rank = 1;
+	}
+
+	for ( i = 0;  i < level.numConnectedPlayers; i++ ) {
+		level.players[ level.sortedPlayers[i] ].ps.persistant[PERS_RANK] = rank;
+	}
+}
+
+/*
+============
+RanksChanged
+
+Publishes new ranks and scores
+============
+*/
+static void RanksChanged( void ) {
+	// set the CS_SCORES1/2 configstrings, which will be visible to everyone
+	if ( g_gametype.integer >= GT_TEAM ) {
+		trap_SetConfigstring( CS_SCORES1, va("%i", level.teamScores[TEAM_RED] ) );
+		trap_SetConfigstring( CS_SCORES2, va("%i", level.teamScores[TEAM_BLUE] ) );
+	} else {
+		if ( level.numConnectedPlayers == 0 ) {
+			trap_SetConfigstring( CS_SCORES1, va("%i", SCORE_NOT_PRESENT) );
+			trap_SetConfigstring( CS_SCORES2, va("%i", SCORE_NOT_PRESENT) );
+		} else if ( level.numConnectedPlayers == 1 ) {
+			trap_SetConfigstring( CS_SCORES1, va("%i", level.players[ level.sortedPlayers[0] ].ps.persistant[PERS_SCORE] ) );
+			trap_SetConfigstring( CS_SCORES2, va("%i", SCORE_NOT_PRESENT) );
+		} else {
+			trap_SetConfigstring( CS_SCORES1, va("%i", level.players[ level.sortedPlayers[0] ].ps.persistant[PERS_SCORE] ) );
+			trap_SetConfigstring( CS_SCORES2, va("%i", level.players[ level.sortedPlayers[1] ].ps.persistant[PERS_SCORE] ) );
+		}
+	}
+
+	// see if it is time to end the level
+	CheckExitRules();
+
+	// if we are at the intermission, send the new info to everyone at the end of the frame
+	if ( level.intermissiontime ) {
+		level.scoresDirty = qtrue;
+	}
+}
+
 /*
 ============
 CalculateRanks
 
 Recalculates the score ranks of all players
-This will be called on every player connect, begin, disconnect, death,
-and team change.
+This will be called on every player connect, begin, disconnect,
+and team change. Score changes of a single player use UpdatePlayerRank.
 ============
 */
 void CalculateRanks( void ) {
 	int		i;
-	int		rank;
-	int		score;
-	int		newScore;
-	gplayer_t	*cl;
 
 	level.follow1 = -1;
 	level.follow2 = -1;
@@ -1035,65 +1158,91 @@ void CalculateRanks( void ) {
 	qsort( level.sortedPlayers, level.numConnectedPlayers, 
 		sizeof(level.sortedPlayers[0]), SortRanks );
 
+	for ( i = 0; i < level.numConnectedPlayers; i++ ) {
+		sortedPlayerIndex[ level.sortedPlayers[i] ] = i;
+	}
+
 	// set the rank value for all players that are connected and not spectators
 	if ( g_gametype.integer >= GT_TEAM ) {
-		// in team games, rank is just the order of the teams, 0=red, 1=blue, 2=tied
-		for ( i = 0;  i < level.numConnectedPlayers; i++ ) {
-			cl = &level.players[ level.sortedPlayers[i] ];
-			if ( level.teamScores[TEAM_RED] == level.teamScores[TEAM_BLUE] ) {
-				cl->ps.persistant[PERS_RANK] = 2;
-			} else if ( level.teamScores[TEAM_RED] > level.teamScores[TEAM_BLUE] ) {
-				cl->ps.persistant[PERS_RANK] = 0;
+		SetTeamRanks();
+	} else {
+		SetPlayerRanks( 0, level.numPlayingPlayers - 1 );
+	}
+
+	RanksChanged();
+}
+
+/*
+============
+UpdatePlayerRank
+
+Moves a playing player whose score changed to its new place in
+level.sortedPlayers and only re-ranks the players in between
+============
+*/
+void UpdatePlayerRank( int playerNum ) {
+	int		index, place;
+	int		low, high, mid;
+	int		score;
+	int		i;
+
+	index = sortedPlayerIndex[playerNum];
+	if ( index >= level.numPlayingPlayers || level.sortedPlayers[index] != playerNum ) {
+		// not in the score ordered part of the list
+		CalculateRanks();
+		return;
+	}
+
+	score = level.players[playerNum].ps.persistant[PERS_SCORE];
+
+	if ( index > 0 && SORTED_SCORE( index - 1 ) < score ) {
+		// moving up, place before the first lower score
+		low = 0;
+		high = index - 1;
+		while ( low < high ) {
+			mid = ( low + high ) / 2;
+			if ( SORTED_SCORE( mid ) < score ) {
+				high = mid;
 			} else {
-				cl->ps.persistant[PERS_RANK] = 1;
+				low = mid + 1;
 			}
 		}
-	} else {	
-		rank = -1;
-		score = 0;
-		for ( i = 0;  i < level.numPlayingPlayers; i++ ) {
-			cl = &level.players[ level.sortedPlayers[i] ];
-			newScore = cl->ps.persistant[PERS_SCORE];
-			if ( i == 0 || newScore != score ) {
-				rank = i;
-				// assume we aren't tied until the next player is checked
-				level.players[ level.sortedPlayers[i] ].ps.persistant[PERS_RANK] = rank;
+		place = low;
+		for ( i = index; i > place; i-- ) {
+			level.sortedPlayers[i] = level.sortedPlayers[i - 1];
+			sortedPlayerIndex[ level.sortedPlayers[i] ] = i;
+		}
+	} else if ( index < level.numPlayingPlayers - 1 && SORTED_SCORE( index + 1 ) > score ) {
+		// moving down, place after the last higher score
+		low = index + 1;
+		high = level.numPlayingPlayers - 1;
+		while ( low < high ) {
+			mid = ( low + high + 1 ) / 2;
+			if ( SORTED_SCORE( mid ) > score ) {
+				low = mid;
 			} else {
-				// we are tied with the previous player
-				level.players[ level.sortedPlayers[i-1] ].ps.persistant[PERS_RANK] = rank | RANK_TIED_FLAG;
-				level.players[ level.sortedPlayers[i] ].ps.persistant[PERS_RANK] = rank | RANK_TIED_FLAG;
-			}
-			score = newScore;
-			if ( g_gametype.integer == GT_SINGLE_PLAYER && level.numPlayingPlayers == 1 ) {
-				level.players[ level.sortedPlayers[i] ].ps.persistant[PERS_RANK] = rank | RANK_TIED_FLAG;
+				high = mid - 1;
 			}
 		}
+		place = low;
+		for ( i = index; i < place; i++ ) {
+			level.sortedPlayers[i] = level.sortedPlayers[i + 1];
+			sortedPlayerIndex[ level.sortedPlayers[i] ] = i;
+		}
+	} else {
+		place = index;
 	}
 
-	// set the CS_SCORES1/2 configstrings, which will be visible to everyone
+	level.sortedPlayers[place] = playerNum;
+	sortedPlayerIndex[playerNum] = place;
+
 	if ( g_gametype.integer >= GT_TEAM ) {
-		trap_SetConfigstring( CS_SCORES1, va("%i", level.teamScores[TEAM_RED] ) );
-		trap_SetConfigstring( CS_SCORES2, va("%i", level.teamScores[TEAM_BLUE] ) );
+		SetTeamRanks();
 	} else {
-		if ( level.numConnectedPlayers == 0 ) {
-			trap_SetConfigstring( CS_SCORES1, va("%i", SCORE_NOT_PRESENT) );
-			trap_SetConfigstring( CS_SCORES2, va("%i", SCORE_NOT_PRESENT) );
-		} else if ( level.numConnectedPlayers == 1 ) {
-			trap_SetConfigstring( CS_SCORES1, va("%i", level.players[ level.sortedPlayers[0] ].ps.persistant[PERS_SCORE] ) );
-			trap_SetConfigstring( CS_SCORES2, va("%i", SCORE_NOT_PRESENT) );
-		} else {
-			trap_SetConfigstring( CS_SCORES1, va("%i", level.players[ level.sortedPlayers[0] ].ps.persistant[PERS_SCORE] ) );
-			trap_SetConfigstring( CS_SCORES2, va("%i", level.players[ level.sortedPlayers[1] ].ps.persistant[PERS_SCORE] ) );
-		}
+		SetPlayerRanks( MIN( index, place ), MAX( index, place ) );
 	}
 
-	// see if it is time to end the level
-	CheckExitRules();
-
-	// if we are at the intermission, send the new info to everyone
-	if ( level.intermissiontime ) {
-		SendScoreboardMessageToAllClients();
-	}
+	RanksChanged();
 }
 
 
@@ -1216,7 +1365,7 @@ void BeginIntermission( void ) {
 			PlayerRespawn(player);
 		}
 		MovePlayerToIntermission( player );
-		trap_UnlinkEntity(player);
+		G_UnlinkEntity(player);
 	}
 #ifdef MISSIONPACK
 	if (g_singlePlayer.integer) {
@@ -1304,42 +1453,6 @@ void ExitLevel (void) {
 
 }
 
-/*
-=================
-G_LogPrintf
-
-Print to the logfile with a time stamp if it is open
-=================
-*/
-void QDECL G_LogPrintf( const char *fmt, ... ) {
-	va_list		argptr;
-	char		string[1024];
-	int			min, tens, sec;
-
-	sec = ( level.time - level.startTime ) / 1000;
-
-	min = sec / 60;
-	sec -= min * 60;
-	tens = sec / 10;
-	sec -= tens * 10;
-
-	Com_sprintf( string, sizeof(string), "%3i:%i%i ", min, tens, sec );
-
-	va_start( argptr, fmt );
-	Q_vsnprintf(string + 7, sizeof(string) - 7, fmt, argptr);
-	va_end( argptr );
-
-	if ( g_dedicated.integer ) {
-		G_Printf( "%s", string + 7 );
-	}
-
-	if ( !level.logFile ) {
-		return;
-	}
-
-	trap_FS_Write( string, strlen( string ), level.logFile );
-}
-
 /*
 ================
 LogExit
@@ -1354,7 +1467,9 @@ void LogExit( const char *string ) {
 	qboolean won = qtrue;
 	team_t team = TEAM_RED;
 #endif
-	G_LogPrintf( "Exit: %s\n", string );
+	G_LogEventBegin( "Exit" );
+	G_LogEventString( "reason", string );
+	G_LogEventEnd( "Exit: %s\n", string );
 
 	level.intermissionQueued = level.time;
 
@@ -1369,7 +1484,10 @@ void LogExit( const char *string ) {
 	}
 
 	if ( g_gametype.integer >= GT_TEAM ) {
-		G_LogPrintf( "red:%i  blue:%i\n",
+		G_LogEventBegin( "teamScores" );
+		G_LogEventInt( "red", level.teamScores[TEAM_RED] );
+		G_LogEventInt( "blue", level.teamScores[TEAM_BLUE] );
+		G_LogEventEnd( "red:%i  blue:%i\n",
 			level.teamScores[TEAM_RED], level.teamScores[TEAM_BLUE] );
 	}
 
@@ -1387,7 +1505,12 @@ void LogExit( const char *string ) {
 
 		ping = cl->ps.ping < 999 ? cl->ps.ping : 999;
 
-		G_LogPrintf( "score: %i  ping: %i  player: %i %s\n", cl->ps.persistant[PERS_SCORE], ping, level.sortedPlayers[i],	cl->pers.netname );
+		G_LogEventBegin( "score" );
+		G_LogEventInt( "score", cl->ps.persistant[PERS_SCORE] );
+		G_LogEventInt( "ping", ping );
+		G_LogEventInt( "player", level.sortedPlayers[i] );
+		G_LogEventString( "name", cl->pers.netname );
+		G_LogEventEnd( "score: %i  ping: %i  player: %i %s\n", cl->ps.persistant[PERS_SCORE], ping, level.sortedPlayers[i],	cl->pers.netname );
 #ifdef MISSIONPACK
 		if (g_singlePlayer.integer && !(g_entities[cl - level.players].r.svFlags & SVF_BOT)) {
 			team = cl->sess.sessionTeam;
@@ -1414,7 +1537,7 @@ void LogExit( const char *string ) {
 	}
 #endif
 
-
+	G_TraceStatsLogExit();
 }
 
 
@@ -1950,6 +2073,322 @@ void G_RunThink (gentity_t *ent) {
 	ent->think (ent);
 }
 
+/*
+=============================================================================
+
+ENTITY RUN SCHEDULING
+
+G_RunFrame only visits the entities that have something to do this frame.
+Missiles, moving items and moving movers run every frame, everything else
+waits in a timer wheel until its nextthink or until its event expires.
+
+Entities are rescheduled after they run and after G_WakeEntity, which must
+be called when an entity is changed from outside its own think or run code
+(callbacks, pushes, events).
+
+=============================================================================
+*/
+
+#define RUN_WHEEL_SLOTS		1024	// one msec per slot
+#define RUN_BITS_WORDS		( MAX_GENTITIES / 32 )
+
+typedef struct {
+	int		wakeTime;				// 0 if not in the wheel
+	int		prev, next;				// entity numbers in the slot, -1 ends the list
+} runWheelLink_t;
+
+static int				runWheel[RUN_WHEEL_SLOTS];
+static runWheelLink_t	runWheelLinks[MAX_GENTITIES];
+static int				runWheelTime;	// level.time the wheel was last advanced to
+
+static unsigned int		alwaysRunBits[RUN_BITS_WORDS];
+static unsigned int		runBits[RUN_BITS_WORDS];	// entities to run this frame
+
+static int				dirtyEntities[MAX_GENTITIES];
+static int				numDirtyEntities;
+static qboolean			entityIsDirty[MAX_GENTITIES];
+
+static qboolean			runningEntities;
+static int				runEntityNum;	// entity G_RunFrame is running
+
+/*
+================
+G_InitEntityRunLists
+================
+*/
+void G_InitEntityRunLists( void ) {
+	int		i;
+
+	for ( i = 0; i < RUN_WHEEL_SLOTS; i++ ) {
+		runWheel[i] = -1;
+	}
+	memset( runWheelLinks, 0, sizeof( runWheelLinks ) );
+	runWheelTime = level.time;
+
+	memset( alwaysRunBits, 0, sizeof( alwaysRunBits ) );
+	memset( runBits, 0, sizeof( runBits ) );
+
+	numDirtyEntities = 0;
+	memset( entityIsDirty, 0, sizeof( entityIsDirty ) );
+
+	runningEntities = qfalse;
+}
+
+/*
+================
+G_WakeEntity
+
+The entity may have been changed, so check what it has to do
+again before the next frame. If G_RunFrame hasn't reached the
+entity yet it will also be run this frame.
+================
+*/
+void G_WakeEntity( gentity_t *ent ) {
+	int		num;
+
+	num = ent - g_entities;
+
+	if ( !entityIsDirty[num] ) {
+		entityIsDirty[num] = qtrue;
+		dirtyEntities[numDirtyEntities++] = num;
+	}
+
+	if ( runningEntities && num > runEntityNum ) {
+		runBits[num >> 5] |= 1u << ( num & 31 );
+	}
+}
+
+/*
+================
+G_UnlinkRunWheel
+================
+*/
+static void G_UnlinkRunWheel( int num ) {
+	runWheelLink_t	*link;
+
+	link = &runWheelLinks[num];
+	if ( !link->wakeTime ) {
+		return;
+	}
+	if ( link->prev != -1 ) {
+		runWheelLinks[link->prev].next = link->next;
+	} else {
+		runWheel[link->wakeTime & ( RUN_WHEEL_SLOTS - 1 )] = link->next;
+	}
+	if ( link->next != -1 ) {
+		runWheelLinks[link->next].prev = link->prev;
+	}
+	link->wakeTime = 0;
+}
+
+/*
+================
+G_LinkRunWheel
+
+Wake times that already passed are put in the next slot
+================
+*/
+static void G_LinkRunWheel( int num, int wakeTime ) {
+	runWheelLink_t	*link;
+	int				slot;
+
+	if ( wakeTime <= runWheelTime ) {
+		wakeTime = runWheelTime + 1;
+	}
+	slot = wakeTime & ( RUN_WHEEL_SLOTS - 1 );
+
+	link = &runWheelLinks[num];
+	link->wakeTime = wakeTime;
+	link->prev = -1;
+	link->next = runWheel[slot];
+	if ( link->next != -1 ) {
+		runWheelLinks[link->next].prev = num;
+	}
+	runWheel[slot] = num;
+}
+
+/*
+================
+G_ScheduleEntity
+
+Mirrors the decisions G_RunEntity makes
+================
+*/
+static void G_ScheduleEntity( gentity_t *ent ) {
+	int			num, wakeTime;
+	qboolean	alwaysRun, thinks;
+
+	num = ent - g_entities;
+
+	G_UnlinkRunWheel( num );
+	alwaysRunBits[num >> 5] &= ~( 1u << ( num & 31 ) );
+
+	// players are always run
+	if ( !ent->inuse || num < MAX_CLIENTS ) {
+		return;
+	}
+
+	alwaysRun = qfalse;
+	thinks = !ent->freeAfterEvent;
+
+	if ( ent->s.eType == ET_MISSILE ) {
+		alwaysRun = qtrue;
+	} else if ( ent->s.eType == ET_ITEM || ent->physicsObject ) {
+		// items only think while they are at rest
+		if ( ent->s.pos.trType != TR_STATIONARY || ent->s.groundEntityNum == ENTITYNUM_NONE ) {
+			alwaysRun = qtrue;
+		}
+	} else if ( ent->s.eType == ET_MOVER ) {
+		// the team captain moves and thinks for the whole team
+		if ( ent->flags & FL_TEAMSLAVE ) {
+			thinks = qfalse;
+		} else if ( ent->s.pos.trType != TR_STATIONARY || ent->s.apos.trType != TR_STATIONARY ) {
+			alwaysRun = qtrue;
+		}
+	}
+
+	if ( alwaysRun ) {
+		alwaysRunBits[num >> 5] |= 1u << ( num & 31 );
+		thinks = qfalse;
+	}
+
+	wakeTime = 0;
+	if ( ent->s.event || ent->freeAfterEvent || ent->unlinkAfterEvent ) {
+		wakeTime = ent->eventTime + EVENT_VALID_MSEC + 1;
+	}
+	if ( thinks && ent->nextthink > 0 ) {
+		if ( !wakeTime || ent->nextthink < wakeTime ) {
+			wakeTime = ent->nextthink;
+		}
+	}
+	if ( wakeTime ) {
+		G_LinkRunWheel( num, wakeTime );
+	}
+}
+
+/*
+================
+G_ScheduleDirtyEntities
+================
+*/
+static void G_ScheduleDirtyEntities( void ) {
+	int		i, num;
+
+	for ( i = 0; i < numDirtyEntities; i++ ) {
+		num = dirtyEntities[i];
+		entityIsDirty[num] = qfalse;
+		G_ScheduleEntity( &g_entities[num] );
+	}
+	numDirtyEntities = 0;
+}
+
+/*
+================
+G_AdvanceRunWheel
+
+Marks the entities that are due this frame
+================
+*/
+static void G_AdvanceRunWheel( void ) {
+	int		time, endTime, num, next;
+
+	endTime = level.time;
+	// going around once checks every slot
+	if ( endTime - runWheelTime > RUN_WHEEL_SLOTS ) {
+		runWheelTime = endTime - RUN_WHEEL_SLOTS;
+	}
+
+	for ( time = runWheelTime + 1; time <= endTime; time++ ) {
+		for ( num = runWheel[time & ( RUN_WHEEL_SLOTS - 1 )]; num != -1; num = next ) {
+			next = runWheelLinks[num].next;
+			// far away wake times stay for another round
+			if ( runWheelLinks[num].wakeTime > endTime ) {
+				continue;
+			}
+			G_UnlinkRunWheel( num );
+			runBits[num >> 5] |= 1u << ( num & 31 );
+			// schedule it again after it ran
+			G_WakeEntity( &g_entities[num] );
+		}
+	}
+
+	runWheelTime = endTime;
+}
+
+/*
+================
+G_RunEntity
+================
+*/
+static void G_RunEntity( gentity_t *ent ) {
+	if ( !ent->inuse ) {
+		return;
+	}
+
+	// clear events that are too old
+	if ( level.time - ent->eventTime > EVENT_VALID_MSEC ) {
+		if ( ent->s.event ) {
+			ent->s.event = 0;	// &= EV_EVENT_BITS;
+			if ( ent->player ) {
+				ent->player->ps.externalEvent = 0;
+				// predicted events should never be set to zero
+				//ent->player->ps.events[0] = 0;
+				//ent->player->ps.events[1] = 0;
+			}
+		}
+		if ( ent->freeAfterEvent ) {
+			// tempEntities or dropped items completely go away after their event
+			G_FreeEntity( ent );
+			return;
+		} else if ( ent->unlinkAfterEvent ) {
+			// items that will respawn will hide themselves after their pickup event
+			ent->unlinkAfterEvent = qfalse;
+			G_UnlinkEntity( ent );
+		}
+	}
+
+	// temporary entities don't think
+	if ( ent->freeAfterEvent ) {
+		return;
+	}
+
+	if ( !ent->r.linked && ent->neverFree ) {
+		return;
+	}
+
+	if ( ent->s.eType == ET_MISSILE ) {
+		G_ProfileBegin( PROF_RUN_MISSILE );
+		G_RunMissile( ent );
+		G_ProfileEnd( PROF_RUN_MISSILE );
+		return;
+	}
+
+	if ( ent->s.eType == ET_ITEM || ent->physicsObject ) {
+		G_ProfileBegin( PROF_RUN_ITEM );
+		G_RunItem( ent );
+		G_ProfileEnd( PROF_RUN_ITEM );
+		return;
+	}
+
+	if ( ent->s.eType == ET_MOVER ) {
+		G_ProfileBegin( PROF_RUN_MOVER );
+		G_RunMover( ent );
+		G_ProfileEnd( PROF_RUN_MOVER );
+		return;
+	}
+
+	if ( ent - g_entities < MAX_CLIENTS ) {
+		G_ProfileBegin( PROF_RUN_PLAYER );
+		G_RunPlayer( ent );
+		G_ProfileEnd( PROF_RUN_PLAYER );
+		return;
+	}
+
+	G_ProfileBegin( PROF_RUN_THINK );
+	G_RunThink( ent );
+	G_ProfileEnd( PROF_RUN_THINK );
+}
+
 /*
 ================
 G_RunFrame
@@ -1958,7 +2397,7 @@ Advances the non-player objects in the world
 ================
 */
 void G_RunFrame( int levelTime ) {
-	int			i;
+	int			i, word, bit;
 	gentity_t	*ent;
 
 	// if we are waiting for the level to restart, do nothing
@@ -1973,68 +2412,53 @@ void G_RunFrame( int levelTime ) {
 	// get any cvar changes
 	G_UpdateCvars();
 
+	G_ProfileStartFrame();
+	G_TraceStatsStartFrame();
+	G_ProfileBegin( PROF_FRAME );
+
+	// pick up entity names changed since the last frame
+	G_UpdateEntityNameIndex();
+
 	//
-	// go through all allocated objects
+	// go through the entities that have something to do
 	//
-	ent = &g_entities[0];
-	for (i=0 ; i<level.num_entities ; i++, ent++) {
-		if ( !ent->inuse ) {
-			continue;
-		}
+	G_ScheduleDirtyEntities();
 
-		// clear events that are too old
-		if ( level.time - ent->eventTime > EVENT_VALID_MSEC ) {
-			if ( ent->s.event ) {
-				ent->s.event = 0;	// &= EV_EVENT_BITS;
-				if ( ent->player ) {
-					ent->player->ps.externalEvent = 0;
-					// predicted events should never be set to zero
-					//ent->player->ps.events[0] = 0;
-					//ent->player->ps.events[1] = 0;
-				}
-			}
-			if ( ent->freeAfterEvent ) {
-				// tempEntities or dropped items completely go away after their event
-				G_FreeEntity( ent );
+	memset( runBits, 0, sizeof( runBits ) );
+	G_AdvanceRunWheel();
+	for ( word = 0; word < RUN_BITS_WORDS; word++ ) {
+		runBits[word] |= alwaysRunBits[word];
+	}
+	for ( i = 0; i < MAX_CLIENTS; i++ ) {
+		runBits[i >> 5] |= 1u << ( i & 31 );
+	}
+
+	// entities woken while running are run in entity order,
+	// as long as they come after the running entity
+	G_ProfileBegin( PROF_RUN_ENTITIES );
+	runningEntities = qtrue;
+	for ( word = 0; word < RUN_BITS_WORDS; word++ ) {
+		for ( bit = 0; runBits[word] && bit < 32; bit++ ) {
+			if ( !( runBits[word] & ( 1u << bit ) ) ) {
 				continue;
-			} else if ( ent->unlinkAfterEvent ) {
-				// items that will respawn will hide themselves after their pickup event
-				ent->unlinkAfterEvent = qfalse;
-				trap_UnlinkEntity( ent );
 			}
-		}
-
-		// temporary entities don't think
-		if ( ent->freeAfterEvent ) {
-			continue;
-		}
-
-		if ( !ent->r.linked && ent->neverFree ) {
-			continue;
-		}
-
-		if ( ent->s.eType == ET_MISSILE ) {
-			G_RunMissile( ent );
-			continue;
-		}
+			runBits[word] &= ~( 1u << bit );
 
-		if ( ent->s.eType == ET_ITEM || ent->physicsObject ) {
-			G_RunItem( ent );
-			continue;
-		}
-
-		if ( ent->s.eType == ET_MOVER ) {
-			G_RunMover( ent );
-			continue;
-		}
+			runEntityNum = word * 32 + bit;
+			if ( runEntityNum >= level.num_entities ) {
+				continue;
+			}
+			ent = &g_entities[runEntityNum];
+			G_RunEntity( ent );
 
-		if ( i < MAX_CLIENTS ) {
-			G_RunPlayer( ent );
-			continue;
+			// anything may have changed
+			if ( runEntityNum >= MAX_CLIENTS ) {
+				G_WakeEntity( ent );
+			}
 		}
-
-		G_RunThink( ent );
 	}
+	runningEntities = qfalse;
+	G_ProfileEnd( PROF_RUN_ENTITIES );
 
 	// perform final fixups on the players
 	ent = &g_entities[0];
@@ -2060,9 +2484,19 @@ void G_RunFrame( int levelTime ) {
 	CheckTeamVote( TEAM_RED );
 	CheckTeamVote( TEAM_BLUE );
 
+	// send the scoreboard if the ranks changed during the intermission
+	if ( level.scoresDirty && level.time >= level.scoresSendTime ) {
+		level.scoresDirty = qfalse;
+		level.scoresSendTime = level.time + 1000 / g_scoreboardRate.integer;
+		SendScoreboardMessageToAllClients();
+	}
+
 	// for tracking changes
 	CheckCvars();
 
+	// write out the log lines that have waited long enough
+	G_LogEndFrame();
+
 	if (g_listEntity.integer) {
 		for (i = 0; i < MAX_GENTITIES; i++) {
 			G_Printf("%4i: %s\n", i, g_entities[i].classname);
@@ -2070,6 +2504,8 @@ void G_RunFrame( int levelTime ) {
 		trap_Cvar_SetValue("g_listEntity", 0);
 	}
 
+	G_ProfileEnd( PROF_FRAME );
+
 	// record the time at the end of this frame - it should be about
 	// the time the next frame begins - when the server starts
 	// accepting commands from connected clients
@@ -47,7 +47,183 @@ typedef struct {
 	vec3_t	angles;
 	float	deltayaw;
 } pushed_t;
-pushed_t	pushed[MAX_GENTITIES], *pushed_p;
+
+// backups of everything a team move pushed, reset by G_MoverTeam
+static pushed_t	pushed[MAX_GENTITIES], *pushed_p;
+
+/*
+Mover candidate caches
+
+Every moving team keeps the entities linked within MOVER_CACHE_PAD units
+of its swept bounds. G_LinkEntity adds any entity linked inside the padded
+box since, so the list always holds everything trap_EntitiesInBox would
+find in it, and the query is only repeated once the team moves out of the
+padded box, stops for a frame, or collects too many candidates.
+*/
+
+#define MAX_MOVER_CACHES		64
+#define MAX_MOVER_CANDIDATES	256
+#define MOVER_CACHE_PAD			128
+
+typedef struct {
+	gentity_t	*mover;			// team captain, NULL if free
+	int			frame;			// level.framenum it was last used
+	vec3_t		mins, maxs;
+	int			numCandidates;
+	int			candidates[MAX_MOVER_CANDIDATES];
+	byte		listed[MAX_GENTITIES / 8];
+} moverCache_t;
+
+static moverCache_t	moverCaches[MAX_MOVER_CACHES];
+static int			numMoverCaches;
+
+/*
+================
+G_InitMoverCaches
+================
+*/
+void G_InitMoverCaches( void ) {
+	memset( moverCaches, 0, sizeof( moverCaches ) );
+	numMoverCaches = 0;
+}
+
+/*
+================
+G_MoverCacheLive
+
+Caches that weren't used last frame are rebuilt before they are used again
+================
+*/
+static qboolean G_MoverCacheLive( moverCache_t *cache ) {
+	return cache->mover && cache->frame >= level.framenum - 1;
+}
+
+/*
+================
+G_MoverCacheAdd
+================
+*/
+static void G_MoverCacheAdd( moverCache_t *cache, int num ) {
+	if ( cache->listed[num >> 3] & ( 1 << ( num & 7 ) ) ) {
+		return;
+	}
+	if ( cache->numCandidates >= MAX_MOVER_CANDIDATES ) {
+		// too crowded, query again next time
+		cache->mover = NULL;
+		return;
+	}
+	cache->listed[num >> 3] |= 1 << ( num & 7 );
+	cache->candidates[cache->numCandidates++] = num;
+}
+
+/*
+================
+G_MoverCacheLinked
+
+Called by G_LinkEntity so the caches pick up entities moving into them
+================
+*/
+void G_MoverCacheLinked( gentity_t *ent ) {
+	moverCache_t	*cache;
+	int				i;
+
+	for ( i = 0, cache = moverCaches; i < numMoverCaches; i++, cache++ ) {
+		if ( !G_MoverCacheLive( cache ) ) {
+			continue;
+		}
+		if ( ent->r.absmin[0] > cache->maxs[0] || ent->r.absmax[0] < cache->mins[0]
+			|| ent->r.absmin[1] > cache->maxs[1] || ent->r.absmax[1] < cache->mins[1]
+			|| ent->r.absmin[2] > cache->maxs[2] || ent->r.absmax[2] < cache->mins[2] ) {
+			continue;
+		}
+		G_MoverCacheAdd( cache, ent->s.number );
+	}
+}
+
+/*
+================
+G_MoverFilterCandidates
+
+Keeps the linked entities touching mins / maxs, like trap_EntitiesInBox
+================
+*/
+static int G_MoverFilterCandidates( const int *candidates, int numCandidates, const vec3_t mins, const vec3_t maxs, int *list ) {
+	gentity_t	*check;
+	int			i, num;
+
+	num = 0;
+	for ( i = 0; i < numCandidates; i++ ) {
+		check = &g_entities[candidates[i]];
+		if ( !check->inuse || !check->r.linked ) {
+			continue;
+		}
+		if ( check->r.absmin[0] > maxs[0] || check->r.absmax[0] < mins[0]
+			|| check->r.absmin[1] > maxs[1] || check->r.absmax[1] < mins[1]
+			|| check->r.absmin[2] > maxs[2] || check->r.absmax[2] < mins[2] ) {
+			continue;
+		}
+		list[num++] = candidates[i];
+	}
+	return num;
+}
+
+/*
+================
+G_MoverCandidates
+
+Fills list with the entities in the swept bounds of a whole mover team
+================
+*/
+static int G_MoverCandidates( gentity_t *team, const vec3_t mins, const vec3_t maxs, int *list ) {
+	static int		entityList[MAX_GENTITIES];
+	moverCache_t	*cache, *freeCache;
+	vec3_t			padMins, padMaxs;
+	int				i, num;
+
+	freeCache = NULL;
+	for ( i = 0, cache = moverCaches; i < numMoverCaches; i++, cache++ ) {
+		if ( cache->mover == team ) {
+			break;
+		}
+		if ( !freeCache && !G_MoverCacheLive( cache ) ) {
+			freeCache = cache;
+		}
+	}
+
+	if ( i < numMoverCaches ) {
+		if ( G_MoverCacheLive( cache )
+			&& mins[0] >= cache->mins[0] && mins[1] >= cache->mins[1] && mins[2] >= cache->mins[2]
+			&& maxs[0] <= cache->maxs[0] && maxs[1] <= cache->maxs[1] && maxs[2] <= cache->maxs[2] ) {
+			cache->frame = level.framenum;
+			return G_MoverFilterCandidates( cache->candidates, cache->numCandidates, mins, maxs, list );
+		}
+	} else if ( freeCache ) {
+		cache = freeCache;
+	} else if ( numMoverCaches < MAX_MOVER_CACHES ) {
+		cache = &moverCaches[numMoverCaches++];
+	} else {
+		return trap_EntitiesInBox( mins, maxs, list, MAX_GENTITIES );
+	}
+
+	// (re)build the cache
+	for ( i = 0; i < 3; i++ ) {
+		padMins[i] = mins[i] - MOVER_CACHE_PAD;
+		padMaxs[i] = maxs[i] + MOVER_CACHE_PAD;
+	}
+	num = trap_EntitiesInBox( padMins, padMaxs, entityList, MAX_GENTITIES );
+
+	memset( cache->listed, 0, sizeof( cache->listed ) );
+	cache->mover = team;
+	cache->frame = level.framenum;
+	VectorCopy( padMins, cache->mins );
+	VectorCopy( padMaxs, cache->maxs );
+	cache->numCandidates = 0;
+	for ( i = 0; i < num && cache->mover; i++ ) {
+		G_MoverCacheAdd( cache, entityList[i] );
+	}
+
+	return G_MoverFilterCandidates( entityList, num, mins, maxs, list );
+}
 
 
 /*
@@ -77,9 +253,9 @@ gentity_t	*G_TestEntityPosition( gentity_t *ent ) {
 	}
 
 	if ( collisionType == CT_CAPSULE ) {
-		trap_TraceCapsule( &tr, origin, ent->s.mins, ent->s.maxs, origin, ent->s.number, mask );
+		G_TraceCapsule( TRACE_MOVER_PUSH, &tr, origin, ent->s.mins, ent->s.maxs, origin, ent->s.number, mask );
 	} else {
-		trap_Trace( &tr, origin, ent->s.mins, ent->s.maxs, origin, ent->s.number, mask );
+		G_Trace( TRACE_MOVER_PUSH, &tr, origin, ent->s.mins, ent->s.maxs, origin, ent->s.number, mask );
 	}
 	
 	if (tr.startsolid)
@@ -146,10 +322,11 @@ qboolean	G_TryPushingEntity( gentity_t *check, gentity_t *pusher, vec3_t move, v
 	}
 
 	// save off the old position
-	if (pushed_p > &pushed[MAX_GENTITIES]) {
-		G_Error( "pushed_p > &pushed[MAX_GENTITIES]" );
+	if (pushed_p >= &pushed[MAX_GENTITIES]) {
+		G_Error( "pushed_p >= &pushed[MAX_GENTITIES]" );
 	}
 	pushed_p->ent = check;
+	G_WakeEntity( check );
 	VectorCopy (check->s.pos.trBase, pushed_p->origin);
 	VectorCopy (check->s.apos.trBase, pushed_p->angles);
 	if ( check->player ) {
@@ -194,7 +371,7 @@ qboolean	G_TryPushingEntity( gentity_t *check, gentity_t *pusher, vec3_t move, v
 		} else {
 			VectorCopy( check->s.pos.trBase, check->r.currentOrigin );
 		}
-		trap_LinkEntity (check);
+		G_LinkEntity (check);
 		return qtrue;
 	}
 
@@ -228,7 +405,7 @@ qboolean G_CheckProxMinePosition( gentity_t *check ) {
 
 	VectorMA(check->s.pos.trBase, 0.125, check->movedir, start);
 	VectorMA(check->s.pos.trBase, 2, check->movedir, end);
-	trap_Trace( &tr, start, NULL, NULL, end, check->s.number, MASK_SOLID );
+	G_Trace( TRACE_MOVER_PUSH, &tr, start, NULL, NULL, end, check->s.number, MASK_SOLID );
 	
 	if (tr.startsolid || tr.fraction < 1)
 		return qfalse;
@@ -264,7 +441,7 @@ qboolean G_TryPushingProxMine( gentity_t *check, gentity_t *pusher, vec3_t move,
 	ret = G_CheckProxMinePosition( check );
 	if (ret) {
 		VectorCopy( check->s.pos.trBase, check->r.currentOrigin );
-		trap_LinkEntity (check);
+		G_LinkEntity (check);
 	}
 	return ret;
 }
@@ -273,27 +450,15 @@ void G_ExplodeMissile( gentity_t *ent );
 
 /*
 ============
-G_MoverPush
+G_MoverPushBounds
 
-Objects need to be moved back on a failed push,
-otherwise riders would continue to slide.
-If qfalse is returned, *obstacle will be the blocking entity
+mins/maxs are the bounds at the destination
+totalMins / totalMaxs are the bounds for the entire move
 ============
 */
-qboolean G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t **obstacle ) {
-	int			i, e;
-	gentity_t	*check;
-	vec3_t		mins, maxs;
-	pushed_t	*p;
-	int			entityList[MAX_GENTITIES];
-	int			listedEntities;
-	vec3_t		totalMins, totalMaxs;
+static void G_MoverPushBounds( gentity_t *pusher, vec3_t move, vec3_t amove, vec3_t mins, vec3_t maxs, vec3_t totalMins, vec3_t totalMaxs ) {
+	int			i;
 
-	*obstacle = NULL;
-
-
-	// mins/maxs are the bounds at the destination
-	// totalMins / totalMaxs are the bounds for the entire move
 	if ( pusher->r.currentAngles[0] || pusher->r.currentAngles[1] || pusher->r.currentAngles[2]
 		|| amove[0] || amove[1] || amove[2] ) {
 		float		radius;
@@ -321,21 +486,51 @@ qboolean G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t **
 			}
 		}
 	}
+}
 
-	// unlink the pusher so we don't get it in the entityList
-	trap_UnlinkEntity( pusher );
+/*
+============
+G_MoverPush
+
+Objects need to be moved back on a failed push,
+otherwise riders would continue to slide.
+If qfalse is returned, *obstacle will be the blocking entity
+
+entityList holds the candidates for the whole team, G_MoverTeam
+queries them once for all parts.
+============
+*/
+static qboolean G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t **obstacle,
+							const int *entityList, int listedEntities ) {
+	int			e;
+	gentity_t	*check;
+	vec3_t		mins, maxs;
+	pushed_t	*p;
+	vec3_t		totalMins, totalMaxs;
+
+	*obstacle = NULL;
 
-	listedEntities = trap_EntitiesInBox( totalMins, totalMaxs, entityList, MAX_GENTITIES );
+	G_MoverPushBounds( pusher, move, amove, mins, maxs, totalMins, totalMaxs );
 
 	// move the pusher to its final position
 	VectorAdd( pusher->r.currentOrigin, move, pusher->r.currentOrigin );
 	VectorAdd( pusher->r.currentAngles, amove, pusher->r.currentAngles );
-	trap_LinkEntity( pusher );
+	G_LinkEntity( pusher );
 
 	// see if any solid entities are inside the final position
 	for ( e = 0 ; e < listedEntities ; e++ ) {
 		check = &g_entities[ entityList[ e ] ];
 
+		// only the entities in this part's own swept bounds
+		if ( check == pusher || !check->inuse || !check->r.linked ) {
+			continue;
+		}
+		if ( check->r.absmin[0] > totalMaxs[0] || check->r.absmax[0] < totalMins[0]
+			|| check->r.absmin[1] > totalMaxs[1] || check->r.absmax[1] < totalMins[1]
+			|| check->r.absmin[2] > totalMaxs[2] || check->r.absmax[2] < totalMins[2] ) {
+			continue;
+		}
+
 		if ( check->s.eType == ET_GRAPPLE ) {
 			// if this grappling hook is attached to this mover try to move it with the pusher
 			if ( check->enemy == pusher ) {
@@ -435,7 +630,7 @@ qboolean G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t **
 				p->ent->player->ps.delta_angles[YAW] = p->deltayaw;
 				VectorCopy (p->origin, p->ent->player->ps.origin);
 			}
-			trap_LinkEntity (p->ent);
+			G_LinkEntity (p->ent);
 		}
 		return qfalse;
 	}
@@ -453,9 +648,26 @@ void G_MoverTeam( gentity_t *ent ) {
 	vec3_t		move, amove;
 	gentity_t	*part, *obstacle;
 	vec3_t		origin, angles;
+	vec3_t		mins, maxs, totalMins, totalMaxs;
+	vec3_t		teamMins, teamMaxs;
+	int			entityList[MAX_GENTITIES];
+	int			listedEntities;
 
 	obstacle = NULL;
 
+	// get the entities the whole team may touch
+	ClearBounds( teamMins, teamMaxs );
+	for (part = ent ; part ; part=part->teamchain) {
+		BG_EvaluateTrajectory( &part->s.pos, level.time, origin );
+		BG_EvaluateTrajectory( &part->s.apos, level.time, angles );
+		VectorSubtract( origin, part->r.currentOrigin, move );
+		VectorSubtract( angles, part->r.currentAngles, amove );
+		G_MoverPushBounds( part, move, amove, mins, maxs, totalMins, totalMaxs );
+		AddPointToBounds( totalMins, teamMins, teamMaxs );
+		AddPointToBounds( totalMaxs, teamMins, teamMaxs );
+	}
+	listedEntities = G_MoverCandidates( ent, teamMins, teamMaxs, entityList );
+
 	// make sure all team slaves can move before committing
 	// any moves or calling any think functions
 	// if the move is blocked, all moved objects will be backed out
@@ -466,7 +678,7 @@ void G_MoverTeam( gentity_t *ent ) {
 		BG_EvaluateTrajectory( &part->s.apos, level.time, angles );
 		VectorSubtract( origin, part->r.currentOrigin, move );
 		VectorSubtract( angles, part->r.currentAngles, amove );
-		if ( !G_MoverPush( part, move, amove, &obstacle ) ) {
+		if ( !G_MoverPush( part, move, amove, &obstacle, entityList, listedEntities ) ) {
 			break;	// move was blocked
 		}
 	}
@@ -478,12 +690,13 @@ void G_MoverTeam( gentity_t *ent ) {
 			part->s.apos.trTime += level.time - level.previousTime;
 			BG_EvaluateTrajectory( &part->s.pos, level.time, part->r.currentOrigin );
 			BG_EvaluateTrajectory( &part->s.apos, level.time, part->r.currentAngles );
-			trap_LinkEntity( part );
+			G_LinkEntity( part );
 		}
 
 		// if the pusher has a "blocked" function, call it
 		if (ent->blocked) {
 			ent->blocked( ent, obstacle );
+			G_WakeEntity( ent );
 		}
 		return;
 	}
@@ -495,6 +708,7 @@ void G_MoverTeam( gentity_t *ent ) {
 			if ( level.time >= part->s.pos.trTime + part->s.pos.trDuration ) {
 				if ( part->reached ) {
 					part->reached( part );
+					G_WakeEntity( part );
 				}
 			}
 		}
@@ -543,6 +757,8 @@ void SetMoverState( gentity_t *ent, moverState_t moverState, int time ) {
 	float			f;
 
 	ent->moverState = moverState;
+	// the team captain may not be the entity that was used
+	G_WakeEntity( ent );
 
 	ent->s.pos.trTime = time;
 	switch( moverState ) {
@@ -570,7 +786,7 @@ void SetMoverState( gentity_t *ent, moverState_t moverState, int time ) {
 		break;
 	}
 	BG_EvaluateTrajectory( &ent->s.pos, level.time, ent->r.currentOrigin );	
-	trap_LinkEntity( ent );
+	G_LinkEntity( ent );
 }
 
 /*
@@ -794,7 +1010,7 @@ void InitMover( gentity_t *ent ) {
 	ent->r.svFlags = SVF_USE_CURRENT_ORIGIN;
 	ent->s.eType = ET_MOVER;
 	VectorCopy (ent->pos1, ent->r.currentOrigin);
-	trap_LinkEntity (ent);
+	G_LinkEntity (ent);
 
 	ent->s.pos.trType = TR_STATIONARY;
 	VectorCopy( ent->pos1, ent->s.pos.trBase );
@@ -951,7 +1167,7 @@ void Think_SpawnNewDoorTrigger( gentity_t *ent ) {
 	other->touch = Touch_DoorTrigger;
 	// remember the thinnest axis
 	other->count = best;
-	trap_LinkEntity (other);
+	G_LinkEntity (other);
 
 	MatchTeam( ent, ent->moverState, level.time );
 }
@@ -1132,7 +1348,7 @@ void SpawnPlatTrigger( gentity_t *ent ) {
 	VectorCopy (tmin, trigger->s.mins);
 	VectorCopy (tmax, trigger->s.maxs);
 
-	trap_LinkEntity (trigger);
+	G_LinkEntity (trigger);
 }
 
 
@@ -1557,7 +1773,7 @@ void SP_func_rotating (gentity_t *ent) {
 	VectorCopy( ent->s.pos.trBase, ent->r.currentOrigin );
 	VectorCopy( ent->s.apos.trBase, ent->r.currentAngles );
 
-	trap_LinkEntity( ent );
+	G_LinkEntity( ent );
 }
 
 
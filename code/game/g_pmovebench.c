@@ -0,0 +1,77 @@
+/*
+===========================================================================
+Copyright (C) 1999-2010 id Software LLC, a ZeniMax Media company.
+
+This file is part of Spearmint Source Code.
+
+Spearmint Source Code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 3 of the License,
+or (at your option) any later version.
+
+Spearmint Source Code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Spearmint Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, Spearmint Source Code is also subject to certain additional terms.
+You should have received a copy of these additional terms immediately following
+the terms and conditions of the GNU General Public License.  If not, please
+request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional
+terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+Suite 120, Rockville, Maryland 20850 USA.
+===========================================================================
+*/
+//
+// g_pmovebench.c -- Pmove benchmark inside the game
+//
+// Runs a generated stream of usercmds through Pmove in the stub world of
+// bg_pmovebench.c, so the speed of the game module itself (QVM or native)
+// can be compared with the standalone pmovebench tool, which also records
+// and replays command streams.
+//
+// pmovebench [moves] [seed]
+
+#include "g_local.h"
+
+static usercmd_t	benchCmds[MAX_BENCH_MOVES];
+static int			benchChecksums[MAX_BENCH_MOVES];
+
+/*
+================
+Svcmd_PmoveBench_f
+================
+*/
+void Svcmd_PmoveBench_f( void ) {
+	char	buf[MAX_TOKEN_CHARS];
+	int		numMoves, start, msec;
+
+	trap_Argv( 1, buf, sizeof( buf ) );
+	numMoves = buf[0] ? atoi( buf ) : DEFAULT_BENCH_MOVES;
+	if ( numMoves < 1 ) {
+		numMoves = 1;
+	} else if ( numMoves > MAX_BENCH_MOVES ) {
+		numMoves = MAX_BENCH_MOVES;
+	}
+	trap_Argv( 2, buf, sizeof( buf ) );
+
+	BG_BenchBuildWorld();
+	BG_BenchGenerateCmds( benchCmds, numMoves, atoi( buf ) );
+
+	BG_BenchRun( benchCmds, numMoves, benchChecksums );
+	G_Printf( "Checksum %08x\n", benchChecksums[numMoves - 1] );
+
+	start = trap_Milliseconds();
+	BG_BenchRun( benchCmds, numMoves, NULL );
+	msec = trap_Milliseconds() - start;
+	if ( msec <= 0 ) {
+		msec = 1;
+	}
+	G_Printf( "%d moves in %d msec, %d moves per second\n", numMoves, msec,
+				(int)( numMoves * 1000.0f / msec ) );
+}
@@ -0,0 +1,336 @@
+/*
+===========================================================================
+Copyright (C) 1999-2010 id Software LLC, a ZeniMax Media company.
+
+This file is part of Spearmint Source Code.
+
+Spearmint Source Code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 3 of the License,
+or (at your option) any later version.
+
+Spearmint Source Code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Spearmint Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, Spearmint Source Code is also subject to certain additional terms.
+You should have received a copy of these additional terms immediately following
+the terms and conditions of the GNU General Public License.  If not, please
+request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional
+terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+Suite 120, Rockville, Maryland 20850 USA.
+===========================================================================
+*/
+//
+// g_profile.c -- server frame profiler
+//
+// Set g_profile 1 to time the sections below. Every finished section is
+// added to a summary and stored in a ring of recent events, which the
+// "profile" server command prints or writes out as CSV or as Chrome
+// trace-event JSON (chrome://tracing).
+//
+// trap_Milliseconds is the only clock available to the VM, so single
+// events are rounded to whole msec. Sections start at random points within
+// a msec though, so totals and averages over many calls are still accurate.
+
+#include "g_local.h"
+
+#define MAX_PROFILE_EVENTS		8192
+#define MAX_PROFILE_DEPTH		16
+
+typedef struct {
+	short			section;
+	short			depth;
+	int				start;		// msec
+	int				duration;	// msec
+} profileEvent_t;
+
+typedef struct {
+	int				calls;
+	int				totalTime;
+	int				maxTime;
+	int				traces;
+} profileStats_t;
+
+static const char *profileSectionNames[PROF_NUM_SECTIONS] = {
+	"G_RunFrame",
+	"G_RunEntities",
+	"G_RunMissile",
+	"G_RunItem",
+	"G_RunMover",
+	"G_RunPlayer",
+	"G_RunThink",
+	"PlayerThink_real",
+	"Pmove",
+	"G_Damage",
+	"ScoreboardMessage",
+	"BotAIStartFrame",
+	"BotLibUpdateEntities",
+	"BotAIRegularUpdate",
+	"BotAI",
+	"BotRouting"
+};
+
+static qboolean			profiling;
+static int				profileStartTime;
+static int				profileFrames;
+
+static profileStats_t	profileStats[PROF_NUM_SECTIONS];
+
+static profileEvent_t	profileEvents[MAX_PROFILE_EVENTS];
+static int				numProfileEvents;	// total, the ring keeps the last MAX_PROFILE_EVENTS
+
+static int				profileStack[MAX_PROFILE_DEPTH];
+static int				profileStackTime[MAX_PROFILE_DEPTH];
+static int				profileDepth;
+
+/*
+================
+G_ProfileReset
+================
+*/
+static void G_ProfileReset( void ) {
+	memset( profileStats, 0, sizeof( profileStats ) );
+	numProfileEvents = 0;
+	profileDepth = 0;
+	profileFrames = 0;
+	profileStartTime = trap_Milliseconds();
+}
+
+/*
+================
+G_ProfileStartFrame
+
+Picks up g_profile changes, sections are only timed while it is set
+================
+*/
+void G_ProfileStartFrame( void ) {
+	if ( g_profile.integer && !profiling ) {
+		G_ProfileReset();
+	}
+	profiling = g_profile.integer;
+	// sections left open by an error or early return
+	profileDepth = 0;
+	if ( profiling ) {
+		profileFrames++;
+	}
+}
+
+/*
+================
+G_ProfileBegin
+================
+*/
+void G_ProfileBegin( profileSection_t section ) {
+	if ( !profiling ) {
+		return;
+	}
+	if ( profileDepth >= MAX_PROFILE_DEPTH ) {
+		profileDepth++;
+		return;
+	}
+	profileStack[profileDepth] = section;
+	profileStackTime[profileDepth] = trap_Milliseconds();
+	profileDepth++;
+}
+
+/*
+================
+G_ProfileEnd
+================
+*/
+void G_ProfileEnd( profileSection_t section ) {
+	profileEvent_t	*event;
+	profileStats_t	*stats;
+	int				duration;
+
+	if ( !profiling || profileDepth <= 0 ) {
+		return;
+	}
+	profileDepth--;
+	if ( profileDepth >= MAX_PROFILE_DEPTH ) {
+		return;
+	}
+	if ( profileStack[profileDepth] != section ) {
+		G_DPrintf( "G_ProfileEnd: %s doesn't match %s\n", profileSectionNames[section],
+					profileSectionNames[profileStack[profileDepth]] );
+		profileDepth = 0;
+		return;
+	}
+
+	duration = trap_Milliseconds() - profileStackTime[profileDepth];
+
+	stats = &profileStats[section];
+	stats->calls++;
+	stats->totalTime += duration;
+	if ( duration > stats->maxTime ) {
+		stats->maxTime = duration;
+	}
+
+	event = &profileEvents[numProfileEvents % MAX_PROFILE_EVENTS];
+	event->section = section;
+	event->depth = profileDepth;
+	event->start = profileStackTime[profileDepth];
+	event->duration = duration;
+	numProfileEvents++;
+}
+
+/*
+================
+G_ProfileTrace
+
+Counts a trace for the innermost open section
+================
+*/
+void G_ProfileTrace( void ) {
+	if ( !profiling || profileDepth <= 0 || profileDepth > MAX_PROFILE_DEPTH ) {
+		return;
+	}
+	profileStats[profileStack[profileDepth - 1]].traces++;
+}
+
+/*
+================
+G_ProfileWrite
+================
+*/
+static void QDECL G_ProfileWrite( fileHandle_t f, const char *fmt, ... ) __attribute__ ((format (printf, 2, 3)));
+
+static void QDECL G_ProfileWrite( fileHandle_t f, const char *fmt, ... ) {
+	va_list		argptr;
+	char		text[1024];
+
+	va_start( argptr, fmt );
+	Q_vsnprintf( text, sizeof( text ), fmt, argptr );
+	va_end( argptr );
+
+	trap_FS_Write( text, strlen( text ), f );
+}
+
+/*
+================
+G_ProfileSummary
+================
+*/
+static void G_ProfileSummary( void ) {
+	profileStats_t	*stats;
+	int				i;
+
+	G_Printf( "%d frames, %d msec\n", profileFrames, trap_Milliseconds() - profileStartTime );
+	G_Printf( "section                 calls   total     avg   max  traces\n" );
+	for ( i = 0; i < PROF_NUM_SECTIONS; i++ ) {
+		stats = &profileStats[i];
+		if ( !stats->calls ) {
+			continue;
+		}
+		G_Printf( "%-20s %8d %7d %7.3f %5d %7d\n", profileSectionNames[i], stats->calls,
+					stats->totalTime, (float)stats->totalTime / stats->calls, stats->maxTime, stats->traces );
+	}
+}
+
+/*
+================
+G_ProfileWriteCSV
+================
+*/
+static void G_ProfileWriteCSV( const char *filename ) {
+	fileHandle_t	f;
+	profileStats_t	*stats;
+	int				i;
+
+	trap_FS_FOpenFile( filename, &f, FS_WRITE );
+	if ( !f ) {
+		G_Printf( "Couldn't write %s\n", filename );
+		return;
+	}
+
+	G_ProfileWrite( f, "section,calls,total_msec,avg_msec,max_msec,traces\n" );
+	for ( i = 0; i < PROF_NUM_SECTIONS; i++ ) {
+		stats = &profileStats[i];
+		G_ProfileWrite( f, "%s,%d,%d,%.3f,%d,%d\n", profileSectionNames[i], stats->calls, stats->totalTime,
+					stats->calls ? (float)stats->totalTime / stats->calls : 0.0f, stats->maxTime, stats->traces );
+	}
+
+	trap_FS_FCloseFile( f );
+	G_Printf( "Wrote %s\n", filename );
+}
+
+/*
+================
+G_ProfileWriteTrace
+
+Chrome trace-event format, timestamps are in usec
+================
+*/
+static void G_ProfileWriteTrace( const char *filename ) {
+	fileHandle_t	f;
+	profileEvent_t	*event;
+	int				i, first;
+
+	trap_FS_FOpenFile( filename, &f, FS_WRITE );
+	if ( !f ) {
+		G_Printf( "Couldn't write %s\n", filename );
+		return;
+	}
+
+	first = numProfileEvents - MAX_PROFILE_EVENTS;
+	if ( first < 0 ) {
+		first = 0;
+	}
+
+	G_ProfileWrite( f, "{\"traceEvents\":[\n" );
+	for ( i = first; i < numProfileEvents; i++ ) {
+		event = &profileEvents[i % MAX_PROFILE_EVENTS];
+		G_ProfileWrite( f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%d000,\"dur\":%d000,\"args\":{\"depth\":%d}}%s\n",
+					profileSectionNames[event->section], event->start - profileStartTime, event->duration,
+					event->depth, i < numProfileEvents - 1 ? "," : "" );
+	}
+	G_ProfileWrite( f, "],\"displayTimeUnit\":\"ms\"}\n" );
+
+	trap_FS_FCloseFile( f );
+	G_Printf( "Wrote %d events to %s\n", numProfileEvents - first, filename );
+}
+
+/*
+================
+Svcmd_Profile_f
+
+profile [summary | reset | csv <file> | trace <file>]
+================
+*/
+void Svcmd_Profile_f( void ) {
+	char	cmd[MAX_TOKEN_CHARS];
+	char	filename[MAX_QPATH];
+
+	trap_Argv( 1, cmd, sizeof( cmd ) );
+	trap_Argv( 2, filename, sizeof( filename ) );
+
+	if ( !g_profile.integer && !profileFrames ) {
+		G_Printf( "Set g_profile 1 to profile the server frames\n" );
+		return;
+	}
+
+	if ( !cmd[0] || !Q_stricmp( cmd, "summary" ) ) {
+		G_ProfileSummary();
+	} else if ( !Q_stricmp( cmd, "reset" ) ) {
+		G_ProfileReset();
+	} else if ( !Q_stricmp( cmd, "csv" ) ) {
+		if ( !filename[0] ) {
+			Q_strncpyz( filename, "profile.csv", sizeof( filename ) );
+		}
+		G_ProfileWriteCSV( filename );
+	} else if ( !Q_stricmp( cmd, "trace" ) ) {
+		if ( !filename[0] ) {
+			Q_strncpyz( filename, "profile.json", sizeof( filename ) );
+		}
+		G_ProfileWriteTrace( filename );
+	} else {
+		G_Printf( "usage: profile [summary | reset | csv <file> | trace <file>]\n" );
+	}
+}
@@ -127,6 +127,83 @@ field_t fields[] = {
 	{NULL}
 };
 
+/*
+Field names are looked up through a collision free hash table. The seed
+is searched for when the table is first used, so adding fields doesn't
+need any tuning by hand.
+*/
+#define FIELD_HASH_SIZE		64
+
+static field_t	*fieldHash[FIELD_HASH_SIZE];
+static int		fieldHashSeed;
+
+/*
+===============
+G_FieldHash
+
+Case insensitive, like the Q_stricmp the fields are matched with
+===============
+*/
+static int G_FieldHash( const char *name, int seed ) {
+	unsigned	hash;
+	int			c;
+
+	hash = seed;
+	for ( ; *name; name++ ) {
+		c = *name;
+		if ( c >= 'A' && c <= 'Z' ) {
+			c += 'a' - 'A';
+		}
+		hash = ( hash ^ c ) * 16777619u;
+	}
+	return ( hash ^ ( hash >> 15 ) ) & ( FIELD_HASH_SIZE - 1 );
+}
+
+/*
+===============
+G_InitFieldHash
+===============
+*/
+static void G_InitFieldHash( void ) {
+	field_t	*f;
+	int		seed, h;
+
+	for ( seed = 1; seed < 0x10000; seed++ ) {
+		memset( fieldHash, 0, sizeof( fieldHash ) );
+		for ( f = fields; f->name; f++ ) {
+			h = G_FieldHash( f->name, seed );
+			if ( fieldHash[h] ) {
+				break;
+			}
+			fieldHash[h] = f;
+		}
+		if ( !f->name ) {
+			fieldHashSeed = seed;
+			return;
+		}
+	}
+	G_Error( "G_InitFieldHash: no perfect hash for %d fields", (int)( f - fields ) );
+}
+
+/*
+===============
+G_FindField
+===============
+*/
+static field_t *G_FindField( const char *key ) {
+	field_t	*f;
+
+	if ( !fieldHashSeed ) {
+		G_InitFieldHash();
+	}
+
+	f = fieldHash[G_FieldHash( key, fieldHashSeed )];
+	if ( f && !Q_stricmp( f->name, key ) ) {
+		return f;
+	}
+	return NULL;
+}
+
 
 typedef struct {
 	char	*name;
@@ -290,6 +367,110 @@ spawn_t	spawns[] = {
 	{NULL, 0}
 };
 
+/*
+Classnames of the items and the spawns[] table, hashed so G_CallSpawn
+doesn't have to compare against all of them. Items come first, like
+they did in the old lookup.
+*/
+#define SPAWN_HASH_SIZE		256
+#define MAX_SPAWN_CLASSES	512
+
+typedef struct spawnClass_s {
+	const char			*classname;
+	gitem_t				*item;
+	spawn_t				*spawn;
+	struct spawnClass_s	*next;
+} spawnClass_t;
+
+static spawnClass_t	spawnClasses[MAX_SPAWN_CLASSES];
+static spawnClass_t	*spawnClassHash[SPAWN_HASH_SIZE];
+static qboolean		spawnClassesInitialized;
+
+/*
+===============
+G_SpawnClassHash
+===============
+*/
+static int G_SpawnClassHash( const char *classname ) {
+	unsigned	hash;
+
+	hash = 2166136261u;
+	for ( ; *classname; classname++ ) {
+		hash = ( hash ^ *classname ) * 16777619u;
+	}
+	return ( hash ^ ( hash >> 16 ) ) & ( SPAWN_HASH_SIZE - 1 );
+}
+
+/*
+===============
+G_FindSpawnClass
+===============
+*/
+static spawnClass_t *G_FindSpawnClass( const char *classname ) {
+	spawnClass_t	*c;
+
+	for ( c = spawnClassHash[G_SpawnClassHash( classname )]; c; c = c->next ) {
+		if ( !strcmp( c->classname, classname ) ) {
+			return c;
+		}
+	}
+	return NULL;
+}
+
+/*
+===============
+G_AddSpawnClass
+===============
+*/
+static void G_AddSpawnClass( int *numClasses, const char *classname, gitem_t *item, spawn_t *spawn ) {
+	spawnClass_t	*c;
+	int				h;
+
+	// the first one wins
+	if ( G_FindSpawnClass( classname ) ) {
+		return;
+	}
+	if ( *numClasses >= MAX_SPAWN_CLASSES ) {
+		G_Error( "G_AddSpawnClass: MAX_SPAWN_CLASSES" );
+	}
+
+	h = G_SpawnClassHash( classname );
+	c = &spawnClasses[(*numClasses)++];
+	c->classname = classname;
+	c->item = item;
+	c->spawn = spawn;
+	c->next = spawnClassHash[h];
+	spawnClassHash[h] = c;
+}
+
+/*
+===============
+G_InitSpawnClasses
+===============
+*/
+static void G_InitSpawnClasses( void ) {
+	gitem_t	*item;
+	spawn_t	*s;
+	int		i, numClasses;
+
+	memset( spawnClassHash, 0, sizeof( spawnClassHash ) );
+	numClasses = 0;
+
+	for ( i = 1; i < BG_NumItems(); i++ ) {
+		item = BG_ItemForItemNum( i );
+		if ( !item->classname || !*item->classname ) {
+			continue;
+		}
+		G_AddSpawnClass( &numClasses, item->classname, item, NULL );
+	}
+
+	for ( s = spawns; s->name; s++ ) {
+		G_AddSpawnClass( &numClasses, s->name, NULL, s );
+	}
+
+	spawnClassesInitialized = qtrue;
+}
+
 /*
 ===============
 G_CallSpawn
@@ -299,38 +480,29 @@ returning qfalse if not found
 ===============
 */
 qboolean G_CallSpawn( gentity_t *ent ) {
-	spawn_t	*s;
-	gitem_t	*item;
-	int		i;
+	spawnClass_t	*c;
 
 	if ( !ent->classname ) {
 		G_Printf ("G_CallSpawn: NULL classname\n");
 		return qfalse;
 	}
 
-	// check item spawn functions
-	for ( i = 1; i < BG_NumItems(); i++ ) {
-		item = BG_ItemForItemNum( i );
-		if ( !item->classname || !*item->classname ) {
-			continue;
-		}
-		if ( !strcmp(item->classname, ent->classname) ) {
-			if ( g_instagib.integer && item->giType != IT_TEAM ) {
-				// only spawn team play items in instagib mode
-				return qfalse;
-			}
-			G_SpawnItem( ent, item );
-			return qtrue;
-		}
+	if ( !spawnClassesInitialized ) {
+		G_InitSpawnClasses();
 	}
 
-	// check normal spawn functions
-	for ( s=spawns ; s->name ; s++ ) {
-		if ( !strcmp(s->name, ent->classname) ) {
-			// found it
-			s->spawn(ent);
-			return qtrue;
+	c = G_FindSpawnClass( ent->classname );
+	if ( c && c->item ) {
+		if ( g_instagib.integer && c->item->giType != IT_TEAM ) {
+			// only spawn team play items in instagib mode
+			return qfalse;
 		}
+		G_SpawnItem( ent, c->item );
+		return qtrue;
+	}
+	if ( c ) {
+		c->spawn->spawn(ent);
+		return qtrue;
 	}
 	G_Printf ("%s doesn't have a spawn function\n", ent->classname);
 	return qfalse;
@@ -338,19 +510,14 @@ qboolean G_CallSpawn( gentity_t *ent ) {
 
 /*
 =============
-G_NewString
+G_TranslateNewlines
 
-Builds a copy of the string, translating \n to real linefeeds
-so message texts can be multi-line
+Copies the string, translating \n to real linefeeds
 =============
 */
-char *G_NewString( const char *string ) {
-	char	*newb, *new_p;
-	int		i,l;
-	
-	l = strlen(string) + 1;
-
-	newb = trap_HeapMalloc( l );
+static void G_TranslateNewlines( char *newb, const char *string, int l ) {
+	char	*new_p;
+	int		i;
 
 	new_p = newb;
 
@@ -367,8 +534,68 @@ char *G_NewString( const char *string ) {
 			*new_p++ = string[i];
 		}
 	}
+
+	// a trailing backslash swallows the terminator
+	newb[l-1] = '\0';
+}
+
+/*
+=============
+G_NewString
+
+Builds a copy of the string, translating \n to real linefeeds
+so message texts can be multi-line
+
+Identical strings are only allocated once, the returned
+string must not be modified
+=============
+*/
+#define MAX_INTERNED_STRING_HASH	1024
+
+typedef struct internedString_s {
+	struct internedString_s	*next;
+	char					*string;
+} internedString_t;
+
+static internedString_t	*internedStrings[MAX_INTERNED_STRING_HASH];
+
+char *G_NewString( const char *string ) {
+	char	buf[MAX_STRING_CHARS];
+	char	*newb, *p;
+	int		l, hash;
+	internedString_t	*interned;
 	
-	return newb;
+	l = strlen(string) + 1;
+
+	// too long to be worth sharing
+	if ( l > sizeof( buf ) ) {
+		newb = trap_HeapMalloc( l );
+		G_TranslateNewlines( newb, string, l );
+		return newb;
+	}
+
+	G_TranslateNewlines( buf, string, l );
+
+	hash = 0;
+	for ( p = buf; *p; p++ ) {
+		hash = hash * 31 + *p;
+	}
+	hash &= MAX_INTERNED_STRING_HASH - 1;
+
+	for ( interned = internedStrings[hash]; interned; interned = interned->next ) {
+		if ( !strcmp( interned->string, buf ) ) {
+			return interned->string;
+		}
+	}
+
+	l = strlen( buf ) + 1;
+	interned = trap_HeapMalloc( sizeof( *interned ) + l );
+	interned->string = (char *)( interned + 1 );
+	memcpy( interned->string, buf, l );
+	interned->next = internedStrings[hash];
+	internedStrings[hash] = interned;
+
+	return interned->string;
 }
 
 
@@ -388,43 +615,42 @@ void G_ParseField( const char *key, const char *value, gentity_t *ent ) {
 	float	v;
 	vec3_t	vec;
 
-	for ( f=fields ; f->name ; f++ ) {
-		if ( !Q_stricmp(f->name, key) ) {
-			// found it
-			b = (byte *)ent;
+	f = G_FindField( key );
+	if ( !f ) {
+		return;
+	}
 
-			switch( f->type ) {
-			case F_STRING:
-				*(char **)(b+f->ofs) = G_NewString (value);
-				break;
-			case F_VECTOR:
-				sscanf (value, "%f %f %f", &vec[0], &vec[1], &vec[2]);
-				((float *)(b+f->ofs))[0] = vec[0];
-				((float *)(b+f->ofs))[1] = vec[1];
-				((float *)(b+f->ofs))[2] = vec[2];
-				break;
-			case F_INT:
-				*(int *)(b+f->ofs) = atoi(value);
-				break;
-			case F_FLOAT:
-				*(float *)(b+f->ofs) = atof(value);
-				break;
-			case F_ANGLEHACK:
-				v = atof(value);
-				((float *)(b+f->ofs))[0] = 0;
-				((float *)(b+f->ofs))[1] = v;
-				((float *)(b+f->ofs))[2] = 0;
-				break;
-			}
-			return;
-		}
+	b = (byte *)ent;
+
+	switch( f->type ) {
+	case F_STRING:
+		*(char **)(b+f->ofs) = G_NewString (value);
+		break;
+	case F_VECTOR:
+		sscanf (value, "%f %f %f", &vec[0], &vec[1], &vec[2]);
+		((float *)(b+f->ofs))[0] = vec[0];
+		((float *)(b+f->ofs))[1] = vec[1];
+		((float *)(b+f->ofs))[2] = vec[2];
+		break;
+	case F_INT:
+		*(int *)(b+f->ofs) = atoi(value);
+		break;
+	case F_FLOAT:
+		*(float *)(b+f->ofs) = atof(value);
+		break;
+	case F_ANGLEHACK:
+		v = atof(value);
+		((float *)(b+f->ofs))[0] = 0;
+		((float *)(b+f->ofs))[1] = v;
+		((float *)(b+f->ofs))[2] = 0;
+		break;
 	}
 }
 
 #define ADJUST_AREAPORTAL() \
 	if(ent->s.eType == ET_MOVER) \
 	{ \
-		trap_LinkEntity(ent); \
+		G_LinkEntity(ent); \
 		trap_AdjustAreaPortalState(ent, qtrue); \
 	}
 
@@ -473,26 +699,49 @@ void G_SpawnGEntityFromSpawnVars( void ) {
 
 /*
 ====================
-G_AddSpawnVarToken
+G_ReadSpawnVarToken
+
+Reads the next token straight into level.spawnVarChars, it is only
+kept if G_AddSpawnVarToken is called for it
 ====================
 */
-char *G_AddSpawnVarToken( const char *string ) {
-	int		l;
+static char *G_ReadSpawnVarToken( void ) {
 	char	*dest;
+	int		size, l;
 
-	l = strlen( string );
-	if ( level.numSpawnVarChars + l + 1 > MAX_SPAWN_VARS_CHARS ) {
-		G_Error( "G_AddSpawnVarToken: MAX_SPAWN_VARS_CHARS" );
+	size = MAX_SPAWN_VARS_CHARS - level.numSpawnVarChars;
+	if ( size > MAX_TOKEN_CHARS ) {
+		size = MAX_TOKEN_CHARS;
+	}
+	if ( size < 2 ) {
+		G_Error( "G_ReadSpawnVarToken: MAX_SPAWN_VARS_CHARS" );
 	}
 
 	dest = level.spawnVarChars + level.numSpawnVarChars;
-	memcpy( dest, string, l+1 );
+	if ( !trap_GetEntityToken( &level.spawnEntityOffset, dest, size ) ) {
+		G_Error( "G_ParseSpawnVars: EOF without closing brace" );
+	}
 
-	level.numSpawnVarChars += l + 1;
+	// a token filling what is left of the buffer may have been cut off
+	l = strlen( dest );
+	if ( l + 1 >= size && size < MAX_TOKEN_CHARS ) {
+		G_Error( "G_ReadSpawnVarToken: MAX_SPAWN_VARS_CHARS" );
+	}
 
 	return dest;
 }
 
+/*
+====================
+G_AddSpawnVarToken
+
+Keeps the token G_ReadSpawnVarToken just read
+====================
+*/
+static void G_AddSpawnVarToken( const char *token ) {
+	level.numSpawnVarChars += strlen( token ) + 1;
+}
+
 /*
 ====================
 G_ParseSpawnVars
@@ -504,7 +753,8 @@ This does not actually spawn an entity.
 ====================
 */
 qboolean G_ParseSpawnVars( void ) {
-	char		keyname[MAX_TOKEN_CHARS];
+	char		*keyname;
+	char		*value;
 	char		com_token[MAX_TOKEN_CHARS];
 
 	level.numSpawnVars = 0;
@@ -522,27 +772,26 @@ qboolean G_ParseSpawnVars( void ) {
 	// go through all the key / value pairs
 	while ( 1 ) {	
 		// parse key
-		if ( !trap_GetEntityToken( &level.spawnEntityOffset, keyname, sizeof( keyname ) ) ) {
-			G_Error( "G_ParseSpawnVars: EOF without closing brace" );
-		}
+		keyname = G_ReadSpawnVarToken();
 
 		if ( keyname[0] == '}' ) {
 			break;
 		}
+		G_AddSpawnVarToken( keyname );
 		
 		// parse value	
-		if ( !trap_GetEntityToken( &level.spawnEntityOffset, com_token, sizeof( com_token ) ) ) {
-			G_Error( "G_ParseSpawnVars: EOF without closing brace" );
-		}
+		value = G_ReadSpawnVarToken();
 
-		if ( com_token[0] == '}' ) {
+		if ( value[0] == '}' ) {
 			G_Error( "G_ParseSpawnVars: closing brace without data" );
 		}
 		if ( level.numSpawnVars == MAX_SPAWN_VARS ) {
 			G_Error( "G_ParseSpawnVars: MAX_SPAWN_VARS" );
 		}
-		level.spawnVars[ level.numSpawnVars ][0] = G_AddSpawnVarToken( keyname );
-		level.spawnVars[ level.numSpawnVars ][1] = G_AddSpawnVarToken( com_token );
+		G_AddSpawnVarToken( value );
+
+		level.spawnVars[ level.numSpawnVars ][0] = keyname;
+		level.spawnVars[ level.numSpawnVars ][1] = value;
 		level.numSpawnVars++;
 	}
 
@@ -624,6 +873,7 @@ void G_SpawnEntitiesFromString( void ) {
 	level.spawning = qtrue;
 	level.numSpawnVars = 0;
 	level.spawnEntityOffset = 0;
+	memset( internedStrings, 0, sizeof( internedStrings ) );
 
 	// the worldspawn is not an actual entity, but it still
 	// has a "spawn" function to perform any global setup
@@ -47,12 +47,22 @@ removeip <ip>
 
 The ip address is specified in dot format, and you can use '*' to match any value
 so you can specify an entire class C network with "addip 192.246.40.*"
+Networks can also be given as CIDR prefixes, for IPv4 and IPv6, like
+"addip 192.246.40.0/24" or "addip 2001:db8::/32". A '*' can only replace
+the trailing parts of an address.
 
-Removeip will only remove an address specified exactly the same way.  You cannot addip a subnet, then removeip a single host.
+Removeip will only remove the same network that was added.  You cannot addip a subnet, then removeip a single host.
 
 listip
 Prints the current list of filters.
 
+loadips <file>
+Adds all the filters in a file, one per line. Lines starting with '#' or
+"//" are ignored. Filters from files aren't saved in g_banIPs, which only
+holds about 20 of them. The file name is kept in g_banIPFiles instead and
+the file is read again on every map load, so edit the file rather than
+using removeip to drop one of its filters for good.
+
 g_filterban <0 or 1>
 
 If 1 (the default), then ip addresses matching the current list will be prohibited from entering the game.  This is the default setting.
@@ -67,114 +77,629 @@ still, you should rely on PB for banning instead
 ==============================================================================
 */
 
+// Filters are stored as prefixes of 128 bit addresses, IPv4 addresses are
+// mapped to ::ffff:0:0/96. They are kept in a path compressed binary trie,
+// so checking an address takes at most one node per prefix bit.
+
+#define	MAX_IPFILTERS		4096
+#define	MAX_IPFILTER_NODES	( MAX_IPFILTERS * 2 )
+#define	IPFILTER_BITS		128
+#define	IPV4_MAPPED_BITS	96
+
 typedef struct ipFilter_s
 {
-	unsigned	mask;
-	unsigned	compare;
+	byte		addr[16];
+	int			bits;				// prefix length
 } ipFilter_t;
 
-#define	MAX_IPFILTERS	1024
+typedef struct ipFilterNode_s
+{
+	ipFilter_t	prefix;				// common to everything below this node
+	qboolean	filter;				// the prefix itself is a filter
+	int			child[2];			// node numbers by the next bit, -1 for none
+} ipFilterNode_t;
+
+static ipFilterNode_t	ipFilterNodes[MAX_IPFILTER_NODES];
+static int				ipFilterRoot = -1;
+static int				ipFilterFreeNode = -1;	// chained through child[0]
+static int				numIPFilterNodes;		// ever used, the rest were never allocated
+static int				numIPFilters;
 
-static ipFilter_t	ipFilters[MAX_IPFILTERS];
-static int			numIPFilters;
+static const byte ipv4MappedPrefix[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
 
 /*
 =================
-StringToFilter
+IPFilterBit
 =================
 */
-static qboolean StringToFilter (char *s, ipFilter_t *f)
+static int IPFilterBit( const byte *addr, int bit )
 {
-	char	num[128];
-	int		i, j;
-	byte	b[4];
-	byte	m[4];
-	
-	for (i=0 ; i<4 ; i++)
-	{
-		b[i] = 0;
-		m[i] = 0;
+	return ( addr[bit >> 3] >> ( 7 - ( bit & 7 ) ) ) & 1;
+}
+
+/*
+=================
+IPFilterCommonBits
+
+Number of leading bits the addresses share, up to max
+=================
+*/
+static int IPFilterCommonBits( const byte *a, const byte *b, int max )
+{
+	int		i, bits;
+	byte	diff;
+
+	for ( i = 0, bits = 0; bits < max; i++, bits += 8 ) {
+		diff = a[i] ^ b[i];
+		if ( diff ) {
+			while ( !( diff & 0x80 ) ) {
+				diff <<= 1;
+				bits++;
+			}
+			break;
+		}
 	}
-	
-	for (i=0 ; i<4 ; i++)
-	{
-		if (*s < '0' || *s > '9')
-		{
-			if (*s == '*') // 'match any'
-			{
-				// b[i] and m[i] to 0
-				s++;
-				if (!*s)
-					break;
-				s++;
-				continue;
+
+	return bits < max ? bits : max;
+}
+
+/*
+=================
+ClearIPFilters
+=================
+*/
+static void ClearIPFilters( void )
+{
+	ipFilterRoot = -1;
+	ipFilterFreeNode = -1;
+	numIPFilterNodes = 0;
+	numIPFilters = 0;
+}
+
+/*
+=================
+AllocIPFilterNode
+=================
+*/
+static int AllocIPFilterNode( const ipFilter_t *prefix, int bits, qboolean filter )
+{
+	ipFilterNode_t	*node;
+	int				num;
+
+	if ( ipFilterFreeNode != -1 ) {
+		num = ipFilterFreeNode;
+		ipFilterFreeNode = ipFilterNodes[num].child[0];
+	} else if ( numIPFilterNodes < MAX_IPFILTER_NODES ) {
+		num = numIPFilterNodes++;
+	} else {
+		return -1;
+	}
+
+	node = &ipFilterNodes[num];
+	node->prefix = *prefix;
+	node->prefix.bits = bits;
+	node->filter = filter;
+	node->child[0] = node->child[1] = -1;
+	return num;
+}
+
+/*
+=================
+FreeIPFilterNode
+=================
+*/
+static void FreeIPFilterNode( int num )
+{
+	ipFilterNodes[num].child[0] = ipFilterFreeNode;
+	ipFilterFreeNode = num;
+}
+
+/*
+=================
+InsertIPFilter
+
+Returns qfalse if the filter was already there or the list is full
+=================
+*/
+static qboolean InsertIPFilter( const ipFilter_t *f )
+{
+	ipFilterNode_t	*node;
+	int				*link;
+	int				common, leaf, split;
+
+	if ( numIPFilters >= MAX_IPFILTERS ) {
+		G_Printf( "IP filter list is full\n" );
+		return qfalse;
+	}
+
+	link = &ipFilterRoot;
+	while ( *link != -1 ) {
+		node = &ipFilterNodes[*link];
+		common = IPFilterCommonBits( f->addr, node->prefix.addr, MIN( f->bits, node->prefix.bits ) );
+
+		if ( common == node->prefix.bits ) {
+			if ( node->prefix.bits == f->bits ) {
+				if ( node->filter ) {
+					return qfalse;
+				}
+				node->filter = qtrue;
+				numIPFilters++;
+				return qtrue;
 			}
-			G_Printf( "Bad filter address: %s\n", s );
+			// the filter is below this node
+			link = &node->child[IPFilterBit( f->addr, node->prefix.bits )];
+			continue;
+		}
+
+		if ( common == f->bits ) {
+			// the filter goes between this node and its parent
+			leaf = AllocIPFilterNode( f, f->bits, qtrue );
+			if ( leaf == -1 ) {
+				break;
+			}
+			ipFilterNodes[leaf].child[IPFilterBit( node->prefix.addr, f->bits )] = *link;
+			*link = leaf;
+			numIPFilters++;
+			return qtrue;
+		}
+
+		// the filter and this node part after the common bits
+		split = AllocIPFilterNode( f, common, qfalse );
+		leaf = AllocIPFilterNode( f, f->bits, qtrue );
+		if ( split == -1 || leaf == -1 ) {
+			if ( split != -1 ) {
+				FreeIPFilterNode( split );
+			}
+			break;
+		}
+		ipFilterNodes[split].child[IPFilterBit( f->addr, common )] = leaf;
+		ipFilterNodes[split].child[IPFilterBit( node->prefix.addr, common )] = *link;
+		*link = split;
+		numIPFilters++;
+		return qtrue;
+	}
+
+	if ( *link == -1 ) {
+		leaf = AllocIPFilterNode( f, f->bits, qtrue );
+		if ( leaf != -1 ) {
+			*link = leaf;
+			numIPFilters++;
+			return qtrue;
+		}
+	}
+
+	G_Printf( "IP filter list is full\n" );
+	return qfalse;
+}
+
+/*
+=================
+RemoveIPFilter
+
+Returns qfalse if the filter wasn't in the list
+=================
+*/
+static qboolean RemoveIPFilter( const ipFilter_t *f )
+{
+	ipFilterNode_t	*node;
+	int				*link, *parentLink;
+	int				num, child;
+
+	parentLink = NULL;
+	link = &ipFilterRoot;
+	while ( *link != -1 ) {
+		node = &ipFilterNodes[*link];
+		if ( node->prefix.bits > f->bits
+			|| IPFilterCommonBits( f->addr, node->prefix.addr, node->prefix.bits ) < node->prefix.bits ) {
 			return qfalse;
 		}
-		
-		j = 0;
-		while (*s >= '0' && *s <= '9')
-		{
-			num[j++] = *s++;
+		if ( node->prefix.bits == f->bits ) {
+			break;
 		}
-		num[j] = 0;
-		b[i] = atoi(num);
-		m[i] = 255;
+		parentLink = link;
+		link = &node->child[IPFilterBit( f->addr, node->prefix.bits )];
+	}
 
-		if (!*s)
+	if ( *link == -1 || !ipFilterNodes[*link].filter ) {
+		return qfalse;
+	}
+
+	num = *link;
+	node = &ipFilterNodes[num];
+	node->filter = qfalse;
+	numIPFilters--;
+
+	// drop nodes that no longer split anything
+	if ( node->child[0] != -1 && node->child[1] != -1 ) {
+		return qtrue;
+	}
+	*link = node->child[0] != -1 ? node->child[0] : node->child[1];
+	FreeIPFilterNode( num );
+
+	if ( *link == -1 && parentLink ) {
+		num = *parentLink;
+		node = &ipFilterNodes[num];
+		if ( !node->filter ) {
+			child = node->child[0] != -1 ? node->child[0] : node->child[1];
+			*parentLink = child;
+			FreeIPFilterNode( num );
+		}
+	}
+
+	return qtrue;
+}
+
+/*
+=================
+MatchIPFilter
+
+Returns qtrue if any filter contains the address
+=================
+*/
+static qboolean MatchIPFilter( const byte *addr )
+{
+	ipFilterNode_t	*node;
+	int				num;
+
+	num = ipFilterRoot;
+	while ( num != -1 ) {
+		node = &ipFilterNodes[num];
+		if ( IPFilterCommonBits( addr, node->prefix.addr, node->prefix.bits ) < node->prefix.bits ) {
+			return qfalse;
+		}
+		if ( node->filter ) {
+			return qtrue;
+		}
+		if ( node->prefix.bits >= IPFILTER_BITS ) {
+			return qfalse;
+		}
+		num = node->child[IPFilterBit( addr, node->prefix.bits )];
+	}
+
+	return qfalse;
+}
+
+/*
+=================
+ParseIPv4
+
+Parses "a.b.c.d" into the last four bytes of an IPv4 mapped address,
+'*' parts are returned as the prefix length. Returns the end of the
+address or NULL.
+=================
+*/
+static const char *ParseIPv4( const char *s, byte *addr, int *bits )
+{
+	int		i, n;
+
+	*bits = IPFILTER_BITS;
+	for ( i = 0; i < 4; i++ ) {
+		if ( *s == '*' ) {
+			// 'match any' for this and the following parts
+			if ( *bits == IPFILTER_BITS ) {
+				*bits = IPV4_MAPPED_BITS + i * 8;
+			}
+			addr[12 + i] = 0;
+			s++;
+		} else if ( *s >= '0' && *s <= '9' && *bits == IPFILTER_BITS ) {
+			n = 0;
+			while ( *s >= '0' && *s <= '9' ) {
+				n = n * 10 + ( *s++ - '0' );
+			}
+			if ( n > 255 ) {
+				return NULL;
+			}
+			addr[12 + i] = n;
+		} else if ( !*s && i > 0 ) {
+			// legacy "192.246.40" or "192.246.*" style filter
+			if ( *bits == IPFILTER_BITS ) {
+				*bits = IPV4_MAPPED_BITS + i * 8;
+			}
+			for ( ; i < 4; i++ ) {
+				addr[12 + i] = 0;
+			}
 			break;
-		s++;
+		} else {
+			return NULL;
+		}
+
+		if ( i < 3 ) {
+			if ( *s == '.' ) {
+				s++;
+			} else if ( *s ) {
+				return NULL;
+			}
+		}
 	}
-	
-	f->mask = *(unsigned *)m;
-	f->compare = *(unsigned *)b;
+
+	memcpy( addr, ipv4MappedPrefix, sizeof( ipv4MappedPrefix ) );
+	return s;
+}
+
+/*
+=================
+ParseIPv6
+
+Parses an IPv6 address with optional "::" and a trailing IPv4 part.
+Returns the end of the address or NULL.
+=================
+*/
+static const char *ParseIPv6( const char *s, byte *addr )
+{
+	byte		ipv4[16];
+	int			words[8];
+	int			numWords, gap;
+	int			i, n, digits, bits;
+	const char	*start, *end;
+
+	numWords = 0;
+	gap = -1;
+
+	if ( s[0] == ':' && s[1] == ':' ) {
+		gap = 0;
+		s += 2;
+	}
+
+	while ( numWords < 8 ) {
+		start = s;
+		n = 0;
+		digits = 0;
+		while ( digits < 4 ) {
+			if ( *s >= '0' && *s <= '9' ) {
+				n = n * 16 + *s - '0';
+			} else if ( *s >= 'a' && *s <= 'f' ) {
+				n = n * 16 + *s - 'a' + 10;
+			} else if ( *s >= 'A' && *s <= 'F' ) {
+				n = n * 16 + *s - 'A' + 10;
+			} else {
+				break;
+			}
+			s++;
+			digits++;
+		}
+
+		if ( *s == '.' && numWords <= 6 ) {
+			// dotted IPv4 for the last two words
+			end = ParseIPv4( start, ipv4, &bits );
+			if ( !end || bits != IPFILTER_BITS ) {
+				return NULL;
+			}
+			words[numWords++] = ( ipv4[12] << 8 ) | ipv4[13];
+			words[numWords++] = ( ipv4[14] << 8 ) | ipv4[15];
+			s = end;
+			break;
+		}
+
+		if ( !digits ) {
+			if ( gap == numWords && numWords == 0 ) {
+				break;	// just "::"
+			}
+			return NULL;
+		}
+		words[numWords++] = n;
+
+		if ( s[0] == ':' && s[1] == ':' && gap == -1 ) {
+			gap = numWords;
+			s += 2;
+			if ( !( ( *s >= '0' && *s <= '9' ) || ( *s >= 'a' && *s <= 'f' ) || ( *s >= 'A' && *s <= 'F' ) ) ) {
+				break;
+			}
+		} else if ( s[0] == ':' ) {
+			s++;
+		} else {
+			break;
+		}
+	}
+
+	if ( gap == -1 ) {
+		if ( numWords != 8 ) {
+			return NULL;
+		}
+	} else {
+		if ( numWords >= 8 ) {
+			return NULL;
+		}
+		// move the words after the gap to the end
+		n = 8 - numWords;
+		for ( i = numWords - 1; i >= gap; i-- ) {
+			words[i + n] = words[i];
+		}
+		for ( i = gap; i < gap + n; i++ ) {
+			words[i] = 0;
+		}
+	}
+
+	for ( i = 0; i < 8; i++ ) {
+		addr[i * 2] = words[i] >> 8;
+		addr[i * 2 + 1] = words[i] & 255;
+	}
+	return s;
+}
+
+/*
+=================
+StringToFilter
+=================
+*/
+static qboolean StringToFilter (const char *s, ipFilter_t *f)
+{
+	const char	*end;
+	int			bits, i;
+
+	memset( f, 0, sizeof( *f ) );
+
+	if ( strchr( s, ':' ) ) {
+		end = ParseIPv6( s, f->addr );
+		bits = IPFILTER_BITS;
+	} else {
+		end = ParseIPv4( s, f->addr, &bits );
+	}
+
+	if ( end && *end == '/' && bits == IPFILTER_BITS ) {
+		bits = atoi( end + 1 );
+		if ( !strchr( s, ':' ) ) {
+			bits += IPV4_MAPPED_BITS;
+		}
+		// an empty prefix length isn't /0
+		if ( end[1] < '0' || end[1] > '9' ) {
+			end = NULL;
+		} else {
+			for ( end++; *end >= '0' && *end <= '9'; end++ ) {
+			}
+			if ( bits > IPFILTER_BITS ) {
+				end = NULL;
+			}
+		}
+	}
+
+	if ( !end || *end ) {
+		G_Printf( "Bad filter address: %s\n", s );
+		return qfalse;
+	}
+
+	// clear the bits after the prefix
+	for ( i = bits; i < IPFILTER_BITS; i++ ) {
+		f->addr[i >> 3] &= ~( 0x80 >> ( i & 7 ) );
+	}
+	f->bits = bits;
 	
 	return qtrue;
 }
 
 /*
 =================
-UpdateIPBans
+FilterToString
+
+IPv4 networks on byte boundaries are written with '*' like before
 =================
 */
-static void UpdateIPBans (void)
+static void FilterToString( const ipFilter_t *f, char *s, int size )
 {
-	byte	b[4] = {0};
-	byte	m[4] = {0};
-	int		i,j;
-	char	iplist_final[MAX_CVAR_VALUE_STRING] = {0};
-	char	ip[64] = {0};
-
-	*iplist_final = 0;
-	for (i = 0 ; i < numIPFilters ; i++)
-	{
-		if (ipFilters[i].compare == 0xffffffff)
-			continue;
+	int		i, bits;
+
+	if ( f->bits >= IPV4_MAPPED_BITS
+		&& IPFilterCommonBits( f->addr, ipv4MappedPrefix, IPV4_MAPPED_BITS ) == IPV4_MAPPED_BITS ) {
+		bits = f->bits - IPV4_MAPPED_BITS;
+		s[0] = 0;
+		if ( bits & 7 ) {
+			Com_sprintf( s, size, "%i.%i.%i.%i/%i", f->addr[12], f->addr[13], f->addr[14], f->addr[15], bits );
+			return;
+		}
+		for ( i = 0; i < 4; i++ ) {
+			Q_strcat( s, size, i * 8 < bits ? va( "%i", f->addr[12 + i] ) : "*" );
+			Q_strcat( s, size, i < 3 ? "." : "" );
+		}
+		return;
+	}
+
+	if ( !f->bits ) {
+		Q_strncpyz( s, "*", size );
+		return;
+	}
+
+	s[0] = 0;
+	for ( i = 0; i < 8; i++ ) {
+		Q_strcat( s, size, va( i ? ":%x" : "%x", ( f->addr[i * 2] << 8 ) | f->addr[i * 2 + 1] ) );
+	}
+	if ( f->bits < IPFILTER_BITS ) {
+		Q_strcat( s, size, va( "/%i", f->bits ) );
+	}
+}
+
+/*
+=================
+SaveIPBan
+
+Appends a filter to g_banIPs
+=================
+*/
+static void SaveIPBan( const ipFilter_t *f )
+{
+	char	iplist[MAX_CVAR_VALUE_STRING];
+	char	ip[64];
+
+	FilterToString( f, ip, sizeof( ip ) );
+
+	Q_strncpyz( iplist, g_banIPs.string, sizeof( iplist ) );
+	if ( strlen( iplist ) + strlen( ip ) + 1 >= sizeof( iplist ) ) {
+		Com_Printf("g_banIPs overflowed at MAX_CVAR_VALUE_STRING\n");
+		return;
+	}
+	if ( iplist[0] && iplist[strlen( iplist ) - 1] != ' ' ) {
+		Q_strcat( iplist, sizeof( iplist ), " " );
+	}
+	Q_strcat( iplist, sizeof( iplist ), ip );
+	Q_strcat( iplist, sizeof( iplist ), " " );
+
+	trap_Cvar_Set( "g_banIPs", iplist );
+	trap_Cvar_Update( &g_banIPs );
+}
 
-		*(unsigned *)b = ipFilters[i].compare;
-		*(unsigned *)m = ipFilters[i].mask;
-		*ip = 0;
-		for (j = 0 ; j < 4 ; j++)
-		{
-			if (m[j]!=255)
-				Q_strcat(ip, sizeof(ip), "*");
-			else
-				Q_strcat(ip, sizeof(ip), va("%i", b[j]));
-			Q_strcat(ip, sizeof(ip), (j<3) ? "." : " ");
-		}		
-		if (strlen(iplist_final)+strlen(ip) < MAX_CVAR_VALUE_STRING)
-		{
-			Q_strcat( iplist_final, sizeof(iplist_final), ip);
-		}
-		else
-		{
-			Com_Printf("g_banIPs overflowed at MAX_CVAR_VALUE_STRING\n");
+/*
+=================
+UnsaveIPBan
+
+Removes the entries for a filter from g_banIPs
+=================
+*/
+static void UnsaveIPBan( const ipFilter_t *f )
+{
+	char		iplist[MAX_CVAR_VALUE_STRING];
+	char		ip[MAX_CVAR_VALUE_STRING];
+	ipFilter_t	entry;
+	const char	*s;
+	int			len;
+
+	iplist[0] = 0;
+	for ( s = g_banIPs.string; *s; ) {
+		while ( *s == ' ' ) {
+			s++;
+		}
+		for ( len = 0; s[len] && s[len] != ' '; len++ ) {
+		}
+		if ( !len ) {
 			break;
 		}
+		Q_strncpyz( ip, s, len + 1 );
+		s += len;
+
+		if ( StringToFilter( ip, &entry ) && entry.bits == f->bits
+			&& IPFilterCommonBits( entry.addr, f->addr, f->bits ) == f->bits ) {
+			continue;
+		}
+		Q_strcat( iplist, sizeof( iplist ), ip );
+		Q_strcat( iplist, sizeof( iplist ), " " );
 	}
 
-	trap_Cvar_Set( "g_banIPs", iplist_final );
+	trap_Cvar_Set( "g_banIPs", iplist );
+	trap_Cvar_Update( &g_banIPs );
+}
+
+/*
+=================
+AddressToBytes
+
+Parses the "ip" userinfo value, "a.b.c.d:port" or "[v6]:port"
+=================
+*/
+static qboolean AddressToBytes( const char *from, byte *addr )
+{
+	const char	*end;
+	int			bits;
+
+	if ( *from == '[' ) {
+		end = ParseIPv6( from + 1, addr );
+		return end && *end == ']';
+	}
+
+	end = ParseIPv4( from, addr, &bits );
+	if ( end && bits == IPFILTER_BITS && ( !*end || *end == ':' ) ) {
+		return qtrue;
+	}
+
+	// IPv6 without a port
+	end = ParseIPv6( from, addr );
+	return end && !*end;
 }
 
 /*
@@ -184,29 +709,18 @@ G_FilterPacket
 */
 qboolean G_FilterPacket (char *from)
 {
-	int		i;
-	unsigned	in;
-	byte m[4] = {0};
-	char *p;
-
-	i = 0;
-	p = from;
-	while (*p && i < 4) {
-		m[i] = 0;
-		while (*p >= '0' && *p <= '9') {
-			m[i] = m[i]*10 + (*p - '0');
-			p++;
-		}
-		if (!*p || *p == ':')
-			break;
-		i++, p++;
+	byte	addr[16];
+
+	if ( !AddressToBytes( from, addr ) ) {
+		// "localhost", "bot" and such only match a filter for everything
+		memset( addr, 0, sizeof( addr ) );
+		if ( ipFilterRoot == -1 || ipFilterNodes[ipFilterRoot].prefix.bits || !ipFilterNodes[ipFilterRoot].filter ) {
+			return g_filterBan.integer == 0;
+		}
 	}
-	
-	in = *(unsigned *)m;
 
-	for (i=0 ; i<numIPFilters ; i++)
-		if ( (in & ipFilters[i].mask) == ipFilters[i].compare)
-			return g_filterBan.integer != 0;
+	if ( MatchIPFilter( addr ) )
+		return g_filterBan.integer != 0;
 
 	return g_filterBan.integer == 0;
 }
@@ -216,29 +730,26 @@ qboolean G_FilterPacket (char *from)
 AddIP
 =================
 */
-static void AddIP( char *str )
+static qboolean AddIP( const char *str, qboolean save )
 {
-	int		i;
+	ipFilter_t	f;
 
-	for (i = 0 ; i < numIPFilters ; i++)
-		if (ipFilters[i].compare == 0xffffffff)
-			break;		// free spot
-	if (i == numIPFilters)
-	{
-		if (numIPFilters == MAX_IPFILTERS)
-		{
-			G_Printf ("IP filter list is full\n");
-			return;
-		}
-		numIPFilters++;
+	if ( !StringToFilter( str, &f ) ) {
+		return qfalse;
+	}
+
+	if ( !InsertIPFilter( &f ) ) {
+		return qfalse;
 	}
-	
-	if (!StringToFilter (str, &ipFilters[i]))
-		ipFilters[i].compare = 0xffffffffu;
 
-	UpdateIPBans();
+	if ( save ) {
+		SaveIPBan( &f );
+	}
+	return qtrue;
 }
 
+static int LoadIPFile( const char *filename, int *lines );
+
 /*
 =================
 G_ProcessIPBans
@@ -246,19 +757,40 @@ G_ProcessIPBans
 */
 void G_ProcessIPBans(void) 
 {
-	char *s, *t;
-	char		str[MAX_CVAR_VALUE_STRING];
+	char	str[MAX_CVAR_VALUE_STRING];
+	char	*s, *t;
+	int		lines;
+
+	ClearIPFilters();
 
 	Q_strncpyz( str, g_banIPs.string, sizeof(str) );
 
-	for (t = s = g_banIPs.string; *t; /* */ ) {
-		s = strchr(s, ' ');
-		if (!s)
+	for ( t = s = str; *t; /* */ ) {
+		s = strchr( s, ' ' );
+		if ( s ) {
+			while ( *s == ' ' )
+				*s++ = 0;
+		}
+		if ( *t )
+			AddIP( t, qfalse );
+		if ( !s )
+			break;
+		t = s;
+	}
+
+	// filters from loadips don't survive the game module being restarted
+	Q_strncpyz( str, g_banIPFiles.string, sizeof(str) );
+
+	for ( t = s = str; *t; /* */ ) {
+		s = strchr( s, ' ' );
+		if ( s ) {
+			while ( *s == ' ' )
+				*s++ = 0;
+		}
+		if ( *t )
+			LoadIPFile( t, &lines );
+		if ( !s )
 			break;
-		while (*s == ' ')
-			*s++ = 0;
-		if (*t)
-			AddIP( t );
 		t = s;
 	}
 }
@@ -280,7 +812,7 @@ void Svcmd_AddIP_f (void)
 
 	trap_Argv( 1, str, sizeof( str ) );
 
-	AddIP( str );
+	AddIP( str, qtrue );
 
 }
 
@@ -292,7 +824,6 @@ Svcmd_RemoveIP_f
 void Svcmd_RemoveIP_f (void)
 {
 	ipFilter_t	f;
-	int			i;
 	char		str[MAX_TOKEN_CHARS];
 
 	if ( trap_Argc() < 2 ) {
@@ -305,18 +836,170 @@ void Svcmd_RemoveIP_f (void)
 	if (!StringToFilter (str, &f))
 		return;
 
-	for (i=0 ; i<numIPFilters ; i++) {
-		if (ipFilters[i].mask == f.mask	&&
-			ipFilters[i].compare == f.compare) {
-			ipFilters[i].compare = 0xffffffffu;
-			G_Printf ("Removed.\n");
+	if ( RemoveIPFilter( &f ) ) {
+		G_Printf ("Removed.\n");
+		UnsaveIPBan( &f );
+		return;
+	}
+
+	G_Printf ( "Didn't find %s.\n", str );
+}
+
+/*
+=================
+LoadIPLine
+
+Returns -1 for blank lines and comments, else if the filter was added
+=================
+*/
+static int LoadIPLine( char *line )
+{
+	char	*s, *end;
+
+	for ( s = line; *s == ' ' || *s == '\t'; s++ ) {
+	}
+	for ( end = s; *end && *end != ' ' && *end != '\t'; end++ ) {
+	}
+	*end = 0;
+
+	if ( !*s || *s == '#' || ( s[0] == '/' && s[1] == '/' ) ) {
+		return -1;
+	}
+
+	return AddIP( s, qfalse );
+}
+
+/*
+=================
+LoadIPFile
+
+Adds the filters in a file, returns the number added or -1 if the file
+couldn't be opened
+=================
+*/
+static int LoadIPFile( const char *filename, int *lines )
+{
+	char			buffer[4096];
+	char			line[128];
+	fileHandle_t	f;
+	int				len, pos, read, lineLen;
+	int				added, result;
+	int				i;
+
+	*lines = 0;
+
+	len = trap_FS_FOpenFile( filename, &f, FS_READ );
+	if ( !f ) {
+		G_Printf( "Couldn't open %s\n", filename );
+		return -1;
+	}
+
+	added = 0;
+	lineLen = 0;
+	for ( pos = 0; pos <= len; pos += read ) {
+		if ( pos < len ) {
+			read = MIN( len - pos, (int)sizeof( buffer ) );
+			trap_FS_Read( buffer, read, f );
+		} else {
+			// end the last line
+			buffer[0] = '\n';
+			read = 1;
+		}
+
+		for ( i = 0; i < read; i++ ) {
+			if ( buffer[i] != '\n' && buffer[i] != '\r' ) {
+				if ( lineLen < (int)sizeof( line ) - 1 ) {
+					line[lineLen++] = buffer[i];
+				}
+				continue;
+			}
+
+			line[lineLen] = 0;
+			lineLen = 0;
+
+			result = LoadIPLine( line );
+			if ( result != -1 ) {
+				(*lines)++;
+				added += result;
+			}
+		}
+	}
+
+	trap_FS_FCloseFile( f );
+
+	return added;
+}
 
-			UpdateIPBans();
+/*
+=================
+SaveIPFile
+
+Appends a file name to g_banIPFiles so it's loaded again on map changes
+=================
+*/
+static void SaveIPFile( const char *filename )
+{
+	char		filelist[MAX_CVAR_VALUE_STRING];
+	const char	*s;
+	int			len, n;
+
+	len = strlen( filename );
+	for ( s = g_banIPFiles.string; *s; s += n ) {
+		while ( *s == ' ' ) {
+			s++;
+		}
+		for ( n = 0; s[n] && s[n] != ' '; n++ ) {
+		}
+		if ( n == len && !Q_stricmpn( s, filename, len ) ) {
 			return;
 		}
 	}
 
-	G_Printf ( "Didn't find %s.\n", str );
+	if ( strchr( filename, ' ' ) ) {
+		G_Printf( "%s isn't saved in g_banIPFiles because of the space in its name\n", filename );
+		return;
+	}
+
+	Q_strncpyz( filelist, g_banIPFiles.string, sizeof( filelist ) );
+	if ( strlen( filelist ) + len + 1 >= sizeof( filelist ) ) {
+		G_Printf( "g_banIPFiles overflowed at MAX_CVAR_VALUE_STRING\n" );
+		return;
+	}
+	if ( filelist[0] ) {
+		Q_strcat( filelist, sizeof( filelist ), " " );
+	}
+	Q_strcat( filelist, sizeof( filelist ), filename );
+
+	trap_Cvar_Set( "g_banIPFiles", filelist );
+	trap_Cvar_Update( &g_banIPFiles );
+}
+
+/*
+=================
+Svcmd_LoadIPs_f
+
+Bulk loads filters from a file, one per line
+=================
+*/
+void Svcmd_LoadIPs_f (void)
+{
+	char	filename[MAX_QPATH];
+	int		added, lines;
+
+	if ( trap_Argc() < 2 ) {
+		G_Printf("Usage: loadips <file>\n");
+		return;
+	}
+
+	trap_Argv( 1, filename, sizeof( filename ) );
+
+	added = LoadIPFile( filename, &lines );
+	if ( added < 0 ) {
+		return;
+	}
+	SaveIPFile( filename );
+
+	G_Printf( "Added %i of %i filters from %s, %i filters in total\n", added, lines, filename, numIPFilters );
 }
 
 /*
@@ -565,7 +1248,31 @@ Svcmd_ListIPs_f
 ===================
 */
 void	Svcmd_ListIPs_f( void ) {
-	trap_Cmd_ExecuteText( EXEC_NOW, "g_banIPs\n" );
+	ipFilterNode_t	*node;
+	int				stack[IPFILTER_BITS + 2];
+	int				depth;
+	char			ip[64];
+
+	// depth first, so the filters come out sorted
+	depth = 0;
+	if ( ipFilterRoot != -1 ) {
+		stack[depth++] = ipFilterRoot;
+	}
+	while ( depth > 0 ) {
+		node = &ipFilterNodes[stack[--depth]];
+		if ( node->filter ) {
+			FilterToString( &node->prefix, ip, sizeof( ip ) );
+			G_Printf( "%s\n", ip );
+		}
+		if ( node->child[1] != -1 ) {
+			stack[depth++] = node->child[1];
+		}
+		if ( node->child[0] != -1 ) {
+			stack[depth++] = node->child[0];
+		}
+	}
+
+	G_Printf( "%i filters\n", numIPFilters );
 }
 
 /*
@@ -643,10 +1350,14 @@ struct svcmd
   { "entityList", qfalse, Svcmd_EntityList_f },
   { "forceTeam", qfalse, Svcmd_ForceTeam_f, Svcmd_ForceTeamComplete },
   { "listip", qfalse, Svcmd_ListIPs_f },
+  { "loadips", qfalse, Svcmd_LoadIPs_f },
+  { "pmovebench", qfalse, Svcmd_PmoveBench_f },
+  { "profile", qfalse, Svcmd_Profile_f },
   { "removeip", qfalse, Svcmd_RemoveIP_f },
   { "say", qtrue, Svcmd_Say_f },
   { "teleport", qfalse, Svcmd_Teleport_f, Svcmd_TeleportComplete },
   { "tell", qtrue, Svcmd_Tell_f, Svcmd_TellComplete },
+  { "tracestats", qfalse, Svcmd_TraceStats_f },
 };
 
 const size_t numSvCmds = ARRAY_LEN(svcmds);
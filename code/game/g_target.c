@@ -57,7 +57,7 @@ void Use_Target_Give( gentity_t *ent, gentity_t *other, gentity_t *activator ) {
 
 		// make sure it isn't going to respawn or show any events
 		t->nextthink = 0;
-		trap_UnlinkEntity( t );
+		G_UnlinkEntity( t );
 	}
 }
 
@@ -272,7 +272,7 @@ void SP_target_speaker( gentity_t *ent ) {
 
 	// must link the entity so we get areas and clusters so
 	// the server can determine who to send updates to
-	trap_LinkEntity( ent );
+	G_LinkEntity( ent );
 }
 
 
@@ -298,7 +298,7 @@ void target_laser_think (gentity_t *self) {
 	// fire forward and see what we hit
 	VectorMA (self->s.origin, 2048, self->movedir, end);
 
-	trap_Trace( &tr, self->s.origin, NULL, NULL, end, self->s.number, CONTENTS_SOLID|CONTENTS_BODY|CONTENTS_CORPSE);
+	G_Trace( TRACE_TARGET, &tr, self->s.origin, NULL, NULL, end, self->s.number, CONTENTS_SOLID|CONTENTS_BODY|CONTENTS_CORPSE);
 
 	if ( tr.entityNum ) {
 		// hurt it if we can
@@ -308,7 +308,7 @@ void target_laser_think (gentity_t *self) {
 
 	VectorCopy (tr.endpos, self->s.origin2);
 
-	trap_LinkEntity( self );
+	G_LinkEntity( self );
 	self->nextthink = level.time + FRAMETIME;
 }
 
@@ -321,7 +321,7 @@ void target_laser_on (gentity_t *self)
 
 void target_laser_off (gentity_t *self)
 {
-	trap_UnlinkEntity( self );
+	G_UnlinkEntity( self );
 	self->nextthink = 0;
 }
 
@@ -420,6 +420,7 @@ void target_relay_use (gentity_t *self, gentity_t *other, gentity_t *activator)
 		ent = G_PickTarget( self->target );
 		if ( ent && ent->use ) {
 			ent->use( ent, self, activator );
+			G_WakeEntity( ent );
 		}
 		return;
 	}
@@ -469,6 +470,10 @@ static void target_location_linkup(gentity_t *ent)
 			i < level.num_entities;
 			i++, ent++) {
 		if (ent->classname && !Q_stricmp(ent->classname, "target_location")) {
+			if (n >= MAX_LOCATIONS) {
+				G_Printf( "WARNING: more than %d target_locations\n", MAX_LOCATIONS - 1 );
+				break;
+			}
 			// lets overload some variables!
 			ent->health = n; // use for location marking
 			trap_SetConfigstring( CS_LOCATIONS + n, ent->message );
@@ -479,6 +484,7 @@ static void target_location_linkup(gentity_t *ent)
 	}
 
 	// All linked together now
+	Team_InitLocations();
 }
 
 /*QUAKED target_location (0 0.5 0) (-8 -8 -8) (8 8 8)
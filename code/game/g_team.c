@@ -885,44 +885,239 @@ int Pickup_Team( gentity_t *ent, gentity_t *other ) {
 
 /*
 ===========
-Team_GetLocation
+Team_InitLocations
 
-Report a location for the player. Uses placed nearby target_location entities
+Sorts the linked target_locations into a grid over the x/y plane, so
+Team_GetLocation only has to look at the cells near the player
 ============
 */
-gentity_t *Team_GetLocation(gentity_t *ent)
-{
-	gentity_t		*eloc, *best;
-	float			bestlen, len;
-	vec3_t			origin;
+#define LOCATION_GRID_SIZE		16
+#define LOCATION_CELL_SIZE		512
+#define LOCATION_CACHE_DIST		64		// look the location up again after moving this far
+
+typedef struct {
+	int			size[2];
+	float		mins[2];
+	float		cellSize;
+	int			cellStart[LOCATION_GRID_SIZE * LOCATION_GRID_SIZE + 1];
+	gentity_t	*locations[MAX_LOCATIONS];	// sorted by cell
+	int			numLocations;
+} locationGrid_t;
+
+static locationGrid_t	locationGrid;
+
+static int Team_LocationCell( float v, int axis ) {
+	int		cell;
+
+	cell = (int)( ( v - locationGrid.mins[axis] ) / locationGrid.cellSize );
+	if ( cell < 0 ) {
+		return 0;
+	}
+	if ( cell >= locationGrid.size[axis] ) {
+		return locationGrid.size[axis] - 1;
+	}
+	return cell;
+}
 
-	if ( !ent ) {
-		return NULL;
+void Team_InitLocations( void ) {
+	gentity_t	*eloc;
+	float		maxs[2], extent;
+	int			cells[MAX_LOCATIONS];
+	int			count[LOCATION_GRID_SIZE * LOCATION_GRID_SIZE];
+	int			i, n, cell;
+
+	memset( &locationGrid, 0, sizeof( locationGrid ) );
+	memset( count, 0, sizeof( count ) );
+	maxs[0] = maxs[1] = 0;
+
+	for ( i = 0; i < level.maxplayers; i++ ) {
+		level.players[i].locationValid = qfalse;
 	}
 
-	best = NULL;
-	bestlen = 3*8192.0*8192.0;
+	n = 0;
+	for ( eloc = level.locationHead; eloc && n < MAX_LOCATIONS; eloc = eloc->nextTrain ) {
+		for ( i = 0; i < 2; i++ ) {
+			if ( !n || eloc->r.currentOrigin[i] < locationGrid.mins[i] ) {
+				locationGrid.mins[i] = eloc->r.currentOrigin[i];
+			}
+			if ( !n || eloc->r.currentOrigin[i] > maxs[i] ) {
+				maxs[i] = eloc->r.currentOrigin[i];
+			}
+		}
+		n++;
+	}
+	if ( !n ) {
+		return;
+	}
 
-	VectorCopy( ent->r.currentOrigin, origin );
+	// grow the cells on huge maps
+	locationGrid.cellSize = LOCATION_CELL_SIZE;
+	for ( i = 0; i < 2; i++ ) {
+		extent = ( maxs[i] - locationGrid.mins[i] ) / ( LOCATION_GRID_SIZE - 1 );
+		if ( extent > locationGrid.cellSize ) {
+			locationGrid.cellSize = extent;
+		}
+	}
+	for ( i = 0; i < 2; i++ ) {
+		locationGrid.size[i] = (int)( ( maxs[i] - locationGrid.mins[i] ) / locationGrid.cellSize ) + 1;
+		if ( locationGrid.size[i] > LOCATION_GRID_SIZE ) {
+			locationGrid.size[i] = LOCATION_GRID_SIZE;
+		}
+	}
 
-	for (eloc = level.locationHead; eloc; eloc = eloc->nextTrain) {
-		len = ( origin[0] - eloc->r.currentOrigin[0] ) * ( origin[0] - eloc->r.currentOrigin[0] )
-			+ ( origin[1] - eloc->r.currentOrigin[1] ) * ( origin[1] - eloc->r.currentOrigin[1] )
-			+ ( origin[2] - eloc->r.currentOrigin[2] ) * ( origin[2] - eloc->r.currentOrigin[2] );
+	// counting sort, keeping the list order within a cell
+	n = 0;
+	for ( eloc = level.locationHead; eloc && n < MAX_LOCATIONS; eloc = eloc->nextTrain ) {
+		cells[n] = Team_LocationCell( eloc->r.currentOrigin[1], 1 ) * locationGrid.size[0]
+			+ Team_LocationCell( eloc->r.currentOrigin[0], 0 );
+		count[cells[n]]++;
+		n++;
+	}
+	locationGrid.numLocations = n;
 
-		if ( len > bestlen ) {
-			continue;
+	for ( cell = 0; cell < locationGrid.size[0] * locationGrid.size[1]; cell++ ) {
+		locationGrid.cellStart[cell + 1] = locationGrid.cellStart[cell] + count[cell];
+		count[cell] = locationGrid.cellStart[cell];
+	}
+
+	n = 0;
+	for ( eloc = level.locationHead; eloc && n < MAX_LOCATIONS; eloc = eloc->nextTrain ) {
+		locationGrid.locations[count[cells[n]]++] = eloc;
+		n++;
+	}
+}
+
+/*
+===========
+Team_FindLocation
+
+Closest target_location in the PVS of origin. Searches rings of grid cells
+outwards and only tests the PVS of a candidate once no unvisited cell can
+hold a closer one, so usually only the answer gets a trap_InPVS call.
+============
+*/
+static gentity_t *Team_FindLocation( const vec3_t origin ) {
+	gentity_t	*candidates[MAX_LOCATIONS];
+	float		dists[MAX_LOCATIONS];
+	int			numCandidates, tested;
+	int			cx, cy, x, y, x0, y0, x1, y1, r;
+	int			i, j;
+	gentity_t	*eloc;
+	float		len, covered, edge;
+	qboolean	all;
+
+	if ( !locationGrid.numLocations ) {
+		return NULL;
+	}
+
+	cx = Team_LocationCell( origin[0], 0 );
+	cy = Team_LocationCell( origin[1], 1 );
+
+	numCandidates = tested = 0;
+	for ( r = 0; ; r++ ) {
+		x0 = cx - r;
+		x1 = cx + r;
+		y0 = cy - r;
+		y1 = cy + r;
+
+		// add the locations in the ring, sorted by distance
+		for ( y = MAX( y0, 0 ); y <= MIN( y1, locationGrid.size[1] - 1 ); y++ ) {
+			for ( x = MAX( x0, 0 ); x <= MIN( x1, locationGrid.size[0] - 1 ); x++ ) {
+				if ( y != y0 && y != y1 && x != x0 && x != x1 ) {
+					// inside the ring, step to its right edge
+					if ( x1 < locationGrid.size[0] ) {
+						x = x1 - 1;
+						continue;
+					}
+					break;
+				}
+				for ( i = locationGrid.cellStart[y * locationGrid.size[0] + x];
+						i < locationGrid.cellStart[y * locationGrid.size[0] + x + 1]; i++ ) {
+					eloc = locationGrid.locations[i];
+					len = DistanceSquared( origin, eloc->r.currentOrigin );
+					for ( j = numCandidates; j > tested && dists[j - 1] > len; j-- ) {
+						candidates[j] = candidates[j - 1];
+						dists[j] = dists[j - 1];
+					}
+					candidates[j] = eloc;
+					dists[j] = len;
+					numCandidates++;
+				}
+			}
 		}
 
-		if ( !trap_InPVS( origin, eloc->r.currentOrigin ) ) {
-			continue;
+		// distance to the nearest cell that hasn't been visited
+		all = qtrue;
+		covered = 3*8192.0*8192.0;
+		if ( x0 > 0 ) {
+			edge = origin[0] - ( locationGrid.mins[0] + x0 * locationGrid.cellSize );
+			covered = MIN( covered, edge );
+			all = qfalse;
+		}
+		if ( x1 < locationGrid.size[0] - 1 ) {
+			edge = locationGrid.mins[0] + ( x1 + 1 ) * locationGrid.cellSize - origin[0];
+			covered = MIN( covered, edge );
+			all = qfalse;
+		}
+		if ( y0 > 0 ) {
+			edge = origin[1] - ( locationGrid.mins[1] + y0 * locationGrid.cellSize );
+			covered = MIN( covered, edge );
+			all = qfalse;
+		}
+		if ( y1 < locationGrid.size[1] - 1 ) {
+			edge = locationGrid.mins[1] + ( y1 + 1 ) * locationGrid.cellSize - origin[1];
+			covered = MIN( covered, edge );
+			all = qfalse;
+		}
+		if ( covered < 0 ) {
+			covered = 0;
+		}
+
+		for ( ; tested < numCandidates; tested++ ) {
+			if ( !all && dists[tested] > covered * covered ) {
+				break;
+			}
+			if ( trap_InPVS( origin, candidates[tested]->r.currentOrigin ) ) {
+				return candidates[tested];
+			}
 		}
 
-		bestlen = len;
-		best = eloc;
+		if ( all ) {
+			return NULL;
+		}
 	}
+}
+
+/*
+===========
+Team_GetLocation
 
-	return best;
+Report a location for the player. Uses placed nearby target_location entities
+============
+*/
+gentity_t *Team_GetLocation(gentity_t *ent)
+{
+	gplayer_t		*player;
+
+	if ( !ent ) {
+		return NULL;
+	}
+
+	player = ent->player;
+	if ( !player ) {
+		return Team_FindLocation( ent->r.currentOrigin );
+	}
+
+	if ( player->locationValid
+		&& DistanceSquared( ent->r.currentOrigin, player->locationOrigin ) < Square( LOCATION_CACHE_DIST ) ) {
+		return player->location;
+	}
+
+	player->location = Team_FindLocation( ent->r.currentOrigin );
+	VectorCopy( ent->r.currentOrigin, player->locationOrigin );
+	player->locationValid = level.locationLinked;
+
+	return player->location;
 }
 
 
@@ -966,42 +1161,49 @@ go to a random point that doesn't telefrag
 */
 #define	MAX_TEAM_SPAWN_POINTS	32
 gentity_t *SelectRandomTeamSpawnPoint( int teamstate, team_t team ) {
-	gentity_t	*spot;
+	gentity_t	**teamSpots;
+	qboolean	occupied[MAX_SPAWN_POINTS];
 	int			count;
 	int			selection;
 	gentity_t	*spots[MAX_TEAM_SPAWN_POINTS];
-	char		*classname;
+	spawnPointType_t	type;
+	int			i, numTeamSpots;
 
 	if (teamstate == TEAM_BEGIN) {
 		if (team == TEAM_RED)
-			classname = "team_CTF_redplayer";
+			type = SPAWN_POINTS_RED_PLAYER;
 		else if (team == TEAM_BLUE)
-			classname = "team_CTF_blueplayer";
+			type = SPAWN_POINTS_BLUE_PLAYER;
 		else
 			return NULL;
 	} else {
 		if (team == TEAM_RED)
-			classname = "team_CTF_redspawn";
+			type = SPAWN_POINTS_RED_SPAWN;
 		else if (team == TEAM_BLUE)
-			classname = "team_CTF_bluespawn";
+			type = SPAWN_POINTS_BLUE_SPAWN;
 		else
 			return NULL;
 	}
-	count = 0;
 
-	spot = NULL;
+	numTeamSpots = G_SpawnPointList( type, &teamSpots );
+	if ( !numTeamSpots ) {
+		return NULL;
+	}
 
-	while ((spot = G_Find (spot, FOFS(classname), classname)) != NULL) {
-		if ( SpotWouldTelefrag( spot ) ) {
+	G_SpotsOccupied( teamSpots, numTeamSpots, occupied );
+
+	count = 0;
+	for ( i = 0; i < numTeamSpots; i++ ) {
+		if ( occupied[i] ) {
 			continue;
 		}
-		spots[ count ] = spot;
+		spots[ count ] = teamSpots[i];
 		if (++count == MAX_TEAM_SPAWN_POINTS)
 			break;
 	}
 
 	if ( !count ) {	// no spots that won't telefrag
-		return G_Find( NULL, FOFS(classname), classname);
+		return teamSpots[0];
 	}
 
 	selection = rand() % count;
@@ -1344,7 +1546,7 @@ gentity_t *SpawnObelisk( vec3_t origin, vec3_t mins, vec3_t maxs, int team ) {
 
 	ent->spawnflags = team;
 
-	trap_LinkEntity( ent );
+	G_LinkEntity( ent );
 
 	return ent;
 }
@@ -1369,7 +1571,7 @@ void ObeliskInit( gentity_t *ent ) {
 
 		// drop to floor
 		VectorSet( dest, ent->s.origin[0], ent->s.origin[1], ent->s.origin[2] - 4096 );
-		trap_Trace( &tr, ent->s.origin, ent->s.mins, ent->s.maxs, dest, ent->s.number, MASK_SOLID );
+		G_Trace( TRACE_TEAM, &tr, ent->s.origin, ent->s.mins, ent->s.maxs, dest, ent->s.number, MASK_SOLID );
 		if ( tr.startsolid ) {
 			ent->s.origin[2] -= 1;
 			G_Printf( "SpawnObelisk: %s startsolid at %s\n", ent->classname, vtos(ent->s.origin) );
@@ -1407,7 +1609,7 @@ void SP_team_redobelisk( gentity_t *ent ) {
 		obelisk->activator = ent;
 	}
 	ent->s.modelindex = TEAM_RED;
-	trap_LinkEntity(ent);
+	G_LinkEntity(ent);
 }
 
 /*QUAKED team_blueobelisk (0 0 1) (-16 -16 0) (16 16 88)
@@ -1432,7 +1634,7 @@ void SP_team_blueobelisk( gentity_t *ent ) {
 		obelisk->activator = ent;
 	}
 	ent->s.modelindex = TEAM_BLUE;
-	trap_LinkEntity(ent);
+	G_LinkEntity(ent);
 }
 
 /*QUAKED team_neutralobelisk (0 0 1) (-16 -16 0) (16 16 88)
@@ -1448,7 +1650,7 @@ void SP_team_neutralobelisk( gentity_t *ent ) {
 		neutralObelisk->activator = ent;
 	}
 	ent->s.modelindex = TEAM_FREE;
-	trap_LinkEntity(ent);
+	G_LinkEntity(ent);
 }
 
 
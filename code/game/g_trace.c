@@ -0,0 +1,506 @@
+/*
+===========================================================================
+Copyright (C) 1999-2010 id Software LLC, a ZeniMax Media company.
+
+This file is part of Spearmint Source Code.
+
+Spearmint Source Code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 3 of the License,
+or (at your option) any later version.
+
+Spearmint Source Code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Spearmint Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, Spearmint Source Code is also subject to certain additional terms.
+You should have received a copy of these additional terms immediately following
+the terms and conditions of the GNU General Public License.  If not, please
+request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional
+terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+Suite 120, Rockville, Maryland 20850 USA.
+===========================================================================
+*/
+//
+// g_trace.c -- tagged traces
+//
+// All game traces go through G_Trace / G_TraceCapsule with a tag naming
+// the caller. With g_traceStats 1 every tag keeps a count, the total time
+// and histograms of the swept length and the resulting fraction, which the
+// "tracestats" server command prints and LogExit writes to the game log.
+//
+// Callers that repeat the same traces within a frame (CanDamage, bot
+// visibility checks) can use G_TraceCached instead. With g_traceCache 1
+// the results are remembered until the end of the frame, keyed on the
+// trace parameters snapped to TRACE_CACHE_SNAP units. Linking or
+// unlinking an entity through G_LinkEntity / G_UnlinkEntity drops the
+// cached traces whose swept box it touches, so all game code has to use
+// those instead of the traps.
+//
+// The same two functions keep the trigger grid up to date, which
+// G_TriggersInBox queries for G_TouchTriggers.
+
+#include "g_local.h"
+
+#define TRACE_LENGTH_BUCKETS	6
+#define TRACE_FRACTION_BUCKETS	6
+
+#define TRACE_CACHE_SIZE		256		// must be a power of two
+#define TRACE_CACHE_SNAP		0.125f
+#define TRACE_CACHE_KEYS		14
+
+typedef struct {
+	int				traces;
+	int				totalTime;		// msec
+	int				startSolid;
+	int				cached;			// traces answered from the cache
+	int				length[TRACE_LENGTH_BUCKETS];
+	int				fraction[TRACE_FRACTION_BUCKETS];
+} traceStats_t;
+
+static const char *traceTagNames[TRACE_NUM_TAGS] = {
+	"Pmove",
+	"Bullet_Fire",
+	"ShotgunPellet",
+	"weapon_railgun_fire",
+	"LightningFire",
+	"CheckGauntletAttack",
+	"CanDamage",
+	"G_RunMissile",
+	"items",
+	"G_MoverPush",
+	"target_laser_think",
+	"ObeliskInit",
+	"unlagged",
+	"BotAI",
+	"BotEntityVisible",
+	"BotGoal",
+	"BotMove",
+	"botlib"
+};
+
+// upper bounds of the swept length buckets, the last one is open
+static const float traceLengthBuckets[TRACE_LENGTH_BUCKETS - 1] = {
+	1, 32, 128, 512, 2048
+};
+
+static const char *traceLengthNames[TRACE_LENGTH_BUCKETS] = {
+	"0", "<32", "<128", "<512", "<2048", ">=2048"
+};
+
+static const char *traceFractionNames[TRACE_FRACTION_BUCKETS] = {
+	"0", "<.25", "<.5", "<.75", "<1", "1"
+};
+
+typedef struct {
+	int				frame;			// frame the slot was added to traceCacheLive
+	qboolean		valid;
+	int				key[TRACE_CACHE_KEYS];
+	vec3_t			absmin, absmax;	// swept box
+	trace_t			trace;
+} traceCacheEntry_t;
+
+static traceStats_t		traceStats[TRACE_NUM_TAGS];
+static int				traceStatsStartTime;
+static qboolean			traceStatsActive;
+
+static traceCacheEntry_t	traceCache[TRACE_CACHE_SIZE];
+static int				traceCacheLive[TRACE_CACHE_SIZE];	// slots used this frame
+static int				numTraceCacheLive;
+static int				traceCacheFrame;
+
+/*
+================
+G_TraceStatsReset
+================
+*/
+static void G_TraceStatsReset( void ) {
+	memset( traceStats, 0, sizeof( traceStats ) );
+	traceStatsStartTime = trap_Milliseconds();
+}
+
+/*
+================
+G_TraceStatsStartFrame
+
+Picks up g_traceStats changes
+================
+*/
+void G_TraceStatsStartFrame( void ) {
+	if ( g_traceStats.integer && !traceStatsActive ) {
+		G_TraceStatsReset();
+	}
+	traceStatsActive = g_traceStats.integer;
+}
+
+/*
+================
+G_TraceAccount
+================
+*/
+static void G_TraceAccount( traceTag_t tag, const trace_t *results, const vec3_t start, const vec3_t end, int duration ) {
+	traceStats_t	*stats;
+	float			length;
+	int				i;
+
+	stats = &traceStats[tag];
+	stats->traces++;
+	stats->totalTime += duration;
+
+	if ( results->startsolid ) {
+		stats->startSolid++;
+	}
+
+	length = Distance( start, end );
+	for ( i = 0; i < TRACE_LENGTH_BUCKETS - 1; i++ ) {
+		if ( length < traceLengthBuckets[i] ) {
+			break;
+		}
+	}
+	stats->length[i]++;
+
+	if ( results->fraction <= 0 ) {
+		i = 0;
+	} else if ( results->fraction >= 1 ) {
+		i = TRACE_FRACTION_BUCKETS - 1;
+	} else {
+		i = 1 + (int)( results->fraction * 4 );
+	}
+	stats->fraction[i]++;
+}
+
+/*
+================
+G_Trace
+================
+*/
+void G_Trace( traceTag_t tag, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask ) {
+	int		startTime;
+
+	G_ProfileTrace();
+
+	if ( !traceStatsActive ) {
+		trap_Trace( results, start, mins, maxs, end, passEntityNum, contentmask );
+		return;
+	}
+
+	startTime = trap_Milliseconds();
+	trap_Trace( results, start, mins, maxs, end, passEntityNum, contentmask );
+	G_TraceAccount( tag, results, start, end, trap_Milliseconds() - startTime );
+}
+
+/*
+================
+G_TraceCapsule
+================
+*/
+void G_TraceCapsule( traceTag_t tag, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask ) {
+	int		startTime;
+
+	G_ProfileTrace();
+
+	if ( !traceStatsActive ) {
+		trap_TraceCapsule( results, start, mins, maxs, end, passEntityNum, contentmask );
+		return;
+	}
+
+	startTime = trap_Milliseconds();
+	trap_TraceCapsule( results, start, mins, maxs, end, passEntityNum, contentmask );
+	G_TraceAccount( tag, results, start, end, trap_Milliseconds() - startTime );
+}
+
+/*
+================
+G_PmoveTrace
+
+pmove_t trace callbacks
+================
+*/
+void G_PmoveTrace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask ) {
+	G_Trace( TRACE_PMOVE, results, start, mins, maxs, end, passEntityNum, contentmask );
+}
+
+void G_PmoveTraceCapsule( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask ) {
+	G_TraceCapsule( TRACE_PMOVE, results, start, mins, maxs, end, passEntityNum, contentmask );
+}
+
+/*
+================
+G_TraceCacheKey
+
+Snaps the trace parameters to the cache grid and returns the slot
+================
+*/
+static int G_TraceCacheKey( int *key, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask ) {
+	unsigned	hash;
+	int			i;
+
+	for ( i = 0; i < 3; i++ ) {
+		key[i] = (int)floor( start[i] / TRACE_CACHE_SNAP + 0.5f );
+		key[3+i] = (int)floor( end[i] / TRACE_CACHE_SNAP + 0.5f );
+		key[6+i] = mins ? (int)floor( mins[i] / TRACE_CACHE_SNAP + 0.5f ) : 0;
+		key[9+i] = maxs ? (int)floor( maxs[i] / TRACE_CACHE_SNAP + 0.5f ) : 0;
+	}
+	key[12] = passEntityNum;
+	key[13] = contentmask;
+
+	hash = 0;
+	for ( i = 0; i < TRACE_CACHE_KEYS; i++ ) {
+		hash = hash * 31 + key[i];
+	}
+	return hash & ( TRACE_CACHE_SIZE - 1 );
+}
+
+/*
+================
+G_TraceCached
+
+Same as G_Trace, but an identical trace earlier in the frame is reused.
+The result may come from a trace up to TRACE_CACHE_SNAP/2 units away.
+================
+*/
+void G_TraceCached( traceTag_t tag, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask ) {
+	traceCacheEntry_t	*entry;
+	int					key[TRACE_CACHE_KEYS];
+	int					i;
+
+	if ( !g_traceCache.integer ) {
+		G_Trace( tag, results, start, mins, maxs, end, passEntityNum, contentmask );
+		return;
+	}
+
+	if ( traceCacheFrame != level.framenum ) {
+		for ( i = 0; i < numTraceCacheLive; i++ ) {
+			traceCache[traceCacheLive[i]].valid = qfalse;
+		}
+		traceCacheFrame = level.framenum;
+		numTraceCacheLive = 0;
+	}
+
+	entry = &traceCache[G_TraceCacheKey( key, start, mins, maxs, end, passEntityNum, contentmask )];
+
+	if ( entry->frame == traceCacheFrame && entry->valid ) {
+		for ( i = 0; i < TRACE_CACHE_KEYS; i++ ) {
+			if ( entry->key[i] != key[i] ) {
+				break;
+			}
+		}
+		if ( i == TRACE_CACHE_KEYS ) {
+			*results = entry->trace;
+			if ( traceStatsActive ) {
+				traceStats[tag].cached++;
+			}
+			return;
+		}
+	}
+
+	G_Trace( tag, results, start, mins, maxs, end, passEntityNum, contentmask );
+
+	if ( entry->frame != traceCacheFrame ) {
+		entry->frame = traceCacheFrame;
+		traceCacheLive[numTraceCacheLive++] = entry - traceCache;
+	}
+	entry->valid = qtrue;
+	memcpy( entry->key, key, sizeof( entry->key ) );
+	entry->trace = *results;
+
+	// pad by more than the snap distance so traces that round onto this entry are covered too
+	for ( i = 0; i < 3; i++ ) {
+		entry->absmin[i] = MIN( start[i], end[i] ) + ( mins ? mins[i] : 0 ) - 1;
+		entry->absmax[i] = MAX( start[i], end[i] ) + ( maxs ? maxs[i] : 0 ) + 1;
+	}
+}
+
+/*
+================
+G_TraceCacheInvalidate
+
+Drops the cached traces that sweep through the box
+================
+*/
+static void G_TraceCacheInvalidate( const vec3_t absmin, const vec3_t absmax ) {
+	traceCacheEntry_t	*entry;
+	int					i;
+
+	for ( i = 0; i < numTraceCacheLive; i++ ) {
+		entry = &traceCache[traceCacheLive[i]];
+		if ( !entry->valid ) {
+			continue;
+		}
+		if ( entry->absmin[0] > absmax[0] || entry->absmin[1] > absmax[1] || entry->absmin[2] > absmax[2]
+			|| entry->absmax[0] < absmin[0] || entry->absmax[1] < absmin[1] || entry->absmax[2] < absmin[2] ) {
+			continue;
+		}
+		entry->valid = qfalse;
+	}
+}
+
+// linked entities with CONTENTS_TRIGGER, for G_TriggersInBox
+static bgTriggerGrid_t	triggerGrid;
+
+/*
+================
+G_InitTriggerGrid
+================
+*/
+void G_InitTriggerGrid( void ) {
+	BG_TriggerGridClear( &triggerGrid );
+}
+
+/*
+================
+G_TriggersInBox
+
+Like trap_EntitiesInBox, but only returns linked entities with
+CONTENTS_TRIGGER
+================
+*/
+int G_TriggersInBox( const vec3_t mins, const vec3_t maxs, int *list, int maxcount ) {
+	return BG_TriggerGridQuery( &triggerGrid, mins, maxs, list, maxcount );
+}
+
+/*
+================
+G_LinkEntity
+================
+*/
+void G_LinkEntity( gentity_t *ent ) {
+	if ( numTraceCacheLive && ent->r.linked ) {
+		G_TraceCacheInvalidate( ent->r.absmin, ent->r.absmax );
+	}
+	trap_LinkEntity( ent );
+	if ( numTraceCacheLive ) {
+		G_TraceCacheInvalidate( ent->r.absmin, ent->r.absmax );
+	}
+
+	if ( ent->s.contents & CONTENTS_TRIGGER ) {
+		BG_TriggerGridLink( &triggerGrid, ent->s.number, ent->r.absmin, ent->r.absmax );
+	} else {
+		BG_TriggerGridUnlink( &triggerGrid, ent->s.number );
+	}
+
+	G_MoverCacheLinked( ent );
+}
+
+/*
+================
+G_UnlinkEntity
+================
+*/
+void G_UnlinkEntity( gentity_t *ent ) {
+	if ( numTraceCacheLive && ent->r.linked ) {
+		G_TraceCacheInvalidate( ent->r.absmin, ent->r.absmax );
+	}
+	trap_UnlinkEntity( ent );
+
+	BG_TriggerGridUnlink( &triggerGrid, ent->s.number );
+}
+
+/*
+================
+G_TraceStatsPrint
+================
+*/
+static void QDECL G_TraceStatsPrint( qboolean toLog, const char *fmt, ... ) __attribute__ ((format (printf, 2, 3)));
+
+static void QDECL G_TraceStatsPrint( qboolean toLog, const char *fmt, ... ) {
+	va_list		argptr;
+	char		text[1024];
+
+	va_start( argptr, fmt );
+	Q_vsnprintf( text, sizeof( text ), fmt, argptr );
+	va_end( argptr );
+
+	if ( toLog ) {
+		G_LogPrintf( "%s", text );
+	} else {
+		G_Printf( "%s", text );
+	}
+}
+
+/*
+================
+G_TraceStatsReport
+================
+*/
+static void G_TraceStatsReport( qboolean toLog ) {
+	traceStats_t	*stats;
+	char			line[MAX_STRING_CHARS];
+	int				total;
+	int				i, j;
+
+	total = 0;
+	for ( i = 0; i < TRACE_NUM_TAGS; i++ ) {
+		total += traceStats[i].traces;
+	}
+
+	G_TraceStatsPrint( toLog, "tracestats: %d traces in %d msec\n", total, trap_Milliseconds() - traceStatsStartTime );
+	if ( !total ) {
+		return;
+	}
+
+	G_TraceStatsPrint( toLog, "tracestats: %-20s %8s %5s %7s %7s %7s\n", "tag", "traces", "%", "msec", "solid", "cached" );
+	for ( i = 0; i < TRACE_NUM_TAGS; i++ ) {
+		stats = &traceStats[i];
+		if ( !stats->traces && !stats->cached ) {
+			continue;
+		}
+		G_TraceStatsPrint( toLog, "tracestats: %-20s %8d %5.1f %7d %7d %7d\n", traceTagNames[i], stats->traces,
+				100.0f * stats->traces / total, stats->totalTime, stats->startSolid, stats->cached );
+
+		line[0] = '\0';
+		for ( j = 0; j < TRACE_LENGTH_BUCKETS; j++ ) {
+			Q_strcat( line, sizeof( line ), va( " %s:%d", traceLengthNames[j], stats->length[j] ) );
+		}
+		G_TraceStatsPrint( toLog, "tracestats:   length  %s\n", line );
+
+		line[0] = '\0';
+		for ( j = 0; j < TRACE_FRACTION_BUCKETS; j++ ) {
+			Q_strcat( line, sizeof( line ), va( " %s:%d", traceFractionNames[j], stats->fraction[j] ) );
+		}
+		G_TraceStatsPrint( toLog, "tracestats:   fraction%s\n", line );
+	}
+}
+
+/*
+================
+G_TraceStatsLogExit
+================
+*/
+void G_TraceStatsLogExit( void ) {
+	if ( !traceStatsActive ) {
+		return;
+	}
+	G_TraceStatsReport( qtrue );
+}
+
+/*
+================
+Svcmd_TraceStats_f
+
+tracestats [reset]
+================
+*/
+void Svcmd_TraceStats_f( void ) {
+	char	cmd[MAX_TOKEN_CHARS];
+
+	if ( !traceStatsActive ) {
+		G_Printf( "Set g_traceStats 1 to count the game traces\n" );
+		return;
+	}
+
+	trap_Argv( 1, cmd, sizeof( cmd ) );
+
+	if ( !Q_stricmp( cmd, "reset" ) ) {
+		G_TraceStatsReset();
+		return;
+	}
+
+	G_TraceStatsReport( qfalse );
+}
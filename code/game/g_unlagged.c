@@ -30,6 +30,61 @@ Suite 120, Rockville, Maryland 20850 USA.
 //
 #include "g_local.h"
 
+#define MAX_HISTORY_FRAMES	17
+#define HISTORY_WORDS		( ( MAX_CLIENTS + 31 ) / 32 )
+
+// One snapshot of every player per server frame. Positions are stored per
+// axis for all players, so a time shift finds its two frames once and then
+// lerps everyone in a single pass over contiguous arrays.
+typedef struct {
+	int			time;
+	int			stored[HISTORY_WORDS];	// players with a position in this frame
+	float		origin[3][MAX_CLIENTS];
+	float		mins[3][MAX_CLIENTS];
+	float		maxs[3][MAX_CLIENTS];
+} historyFrame_t;
+
+typedef enum {
+	HISTORY_CURRENT,	// time isn't in the past, don't shift
+	HISTORY_LERP,		// between two frames
+	HISTORY_OLDEST		// older than the history, use the oldest frame
+} historyShift_t;
+
+static historyFrame_t	historyFrames[MAX_HISTORY_FRAMES];
+static int				historyHead;
+
+// positions of all players at the shifted time
+static float			shiftOrigin[3][MAX_CLIENTS];
+static float			shiftMins[3][MAX_CLIENTS];
+static float			shiftMaxs[3][MAX_CLIENTS];
+static int				shiftValid[HISTORY_WORDS];
+
+/*
+============
+G_InitHistory
+============
+*/
+void G_InitHistory( void ) {
+	memset( historyFrames, 0, sizeof( historyFrames ) );
+	historyHead = 0;
+}
+
+/*
+============
+G_SetHistoryPosition
+============
+*/
+static void G_SetHistoryPosition( historyFrame_t *frame, int playerNum, const vec3_t origin, const vec3_t mins, const vec3_t maxs ) {
+	int		i;
+
+	for ( i = 0; i < 3; i++ ) {
+		frame->origin[i][playerNum] = origin[i];
+		frame->mins[i][playerNum] = mins[i];
+		frame->maxs[i][playerNum] = maxs[i];
+	}
+	frame->stored[playerNum >> 5] |= 1 << ( playerNum & 31 );
+}
+
 /*
 ============
 G_ResetHistory
@@ -38,15 +93,11 @@ Clear out the given client's history (should be called when the teleport bit is
 ============
 */
 void G_ResetHistory( gentity_t *ent ) {
-	int		i, time;
+	int		i;
 
 	// fill up the history with data (assume the current position)
-	ent->player->topMarker = MAX_PLAYER_MARKERS - 1;
-	for ( i = ent->player->topMarker, time = level.time; i >= 0; i--, time -= 50 ) {
-		VectorCopy( ent->s.mins, ent->player->playerMarkers[i].mins );
-		VectorCopy( ent->s.maxs, ent->player->playerMarkers[i].maxs );
-		VectorCopy( ent->r.currentOrigin, ent->player->playerMarkers[i].origin );
-		ent->player->playerMarkers[i].time = time;
+	for ( i = 0; i < MAX_HISTORY_FRAMES; i++ ) {
+		G_SetHistoryPosition( &historyFrames[i], ent->s.number, ent->r.currentOrigin, ent->s.mins, ent->s.maxs );
 	}
 }
 
@@ -59,33 +110,83 @@ Keep track of where the client's been
 ============
 */
 void G_StoreHistory( gentity_t *ent ) {
-	int		head;
+	historyFrame_t	*frame;
+	vec3_t			origin;
+
+	// the first player to end this frame starts a new snapshot
+	if ( historyFrames[historyHead].time != level.time ) {
+		historyHead++;
+		if ( historyHead >= MAX_HISTORY_FRAMES ) {
+			historyHead = 0;
+		}
+		frame = &historyFrames[historyHead];
+		frame->time = level.time;
+		memset( frame->stored, 0, sizeof( frame->stored ) );
+	}
+
+	frame = &historyFrames[historyHead];
+
+	// store all the collision-detection info
+	VectorCopy( ent->s.pos.trBase, origin );
+	SnapVector( origin );
+	G_SetHistoryPosition( frame, ent->s.number, origin, ent->s.mins, ent->s.maxs );
+}
+
+
+/*
+=================
+G_FindHistoryFrames
+
+Find the two frames in the history whose times sandwich "time"
+=================
+*/
+static historyShift_t G_FindHistoryFrames( int time, int *older, int *newer, float *frac ) {
+	int		j, k;
+
+	// assumes no two adjacent records have the same timestamp
+	j = k = historyHead;
+	do {
+		if ( historyFrames[j].time <= time )
+			break;
+
+		k = j;
+		j--;
+		if ( j < 0 ) {
+			j = MAX_HISTORY_FRAMES - 1;
+		}
+	}
+	while ( j != historyHead );
 
-	ent->player->topMarker++;
-	if ( ent->player->topMarker >= MAX_PLAYER_MARKERS ) {
-		ent->player->topMarker = 0;
+	// this only happens when the client is using a negative timenudge, because that
+	// number is added to the command time
+	if ( j == k ) {
+		return HISTORY_CURRENT;
 	}
 
-	head = ent->player->topMarker;
+	// if we wrapped back to the head, grab the earliest
+	if ( j == historyHead ) {
+		*older = *newer = k;
+		*frac = 0;
+		return HISTORY_OLDEST;
+	}
 
-	// store all the collision-detection info and the time
-	VectorCopy( ent->s.mins, ent->player->playerMarkers[head].mins );
-	VectorCopy( ent->s.maxs, ent->player->playerMarkers[head].maxs );
-	VectorCopy( ent->s.pos.trBase, ent->player->playerMarkers[head].origin );
-	SnapVector( ent->player->playerMarkers[head].origin );
-	ent->player->playerMarkers[head].time = level.time;
+	*older = j;
+	*newer = k;
+	*frac = (float)(time - historyFrames[j].time) / (float)(historyFrames[k].time - historyFrames[j].time);
+	return HISTORY_LERP;
 }
 
 
 /*
-=============
-TimeShiftLerp
+=================
+G_LerpHistory
 
-Used below to interpolate between two previous vectors
-Returns a vector "frac" times the distance between "start" and "end"
-=============
+Interpolate all the players between two frames at once
+=================
 */
-static void TimeShiftLerp( float frac, vec3_t start, vec3_t end, vec3_t result ) {
+static void G_LerpHistory( const historyFrame_t *start, const historyFrame_t *end, float frac ) {
+	int		i, j;
+
 // From CG_InterpolateEntityPosition in cg_ents.c:
 /*
 	cent->lerpOrigin[0] = current[0] + f * ( next[0] - current[0] );
@@ -94,9 +195,22 @@ static void TimeShiftLerp( float frac, vec3_t start, vec3_t end, vec3_t result )
 */
 // Making these exactly the same should avoid floating-point error
 
-	result[0] = start[0] + frac * ( end[0] - start[0] );
-	result[1] = start[1] + frac * ( end[1] - start[1] );
-	result[2] = start[2] + frac * ( end[2] - start[2] );
+	for ( i = 0; i < 3; i++ ) {
+		for ( j = 0; j < MAX_CLIENTS; j++ ) {
+			shiftOrigin[i][j] = start->origin[i][j] + frac * ( end->origin[i][j] - start->origin[i][j] );
+		}
+		// lerp these too, just for fun (and ducking)
+		for ( j = 0; j < MAX_CLIENTS; j++ ) {
+			shiftMins[i][j] = start->mins[i][j] + frac * ( end->mins[i][j] - start->mins[i][j] );
+		}
+		for ( j = 0; j < MAX_CLIENTS; j++ ) {
+			shiftMaxs[i][j] = start->maxs[i][j] + frac * ( end->maxs[i][j] - start->maxs[i][j] );
+		}
+	}
+
+	for ( i = 0; i < HISTORY_WORDS; i++ ) {
+		shiftValid[i] = start->stored[i] & end->stored[i];
+	}
 }
 
 
@@ -104,159 +218,108 @@ static void TimeShiftLerp( float frac, vec3_t start, vec3_t end, vec3_t result )
 =================
 G_TimeShiftClient
 
-Move a client back to where he was at the specified "time"
+Move a client to the position G_LerpHistory found for it
 =================
 */
-void G_TimeShiftClient( gentity_t *ent, int time, qboolean debug, gentity_t *debugger ) {
-	int		j, k;
-	char msg[2048];
+static void G_TimeShiftClient( gentity_t *ent, int time, qboolean debug, gentity_t *debugger ) {
+	int		num;
+	vec3_t	origin, mins, maxs;
+	char	msg[2048];
 
-	// this will dump out the head index, and the time for all the stored positions
-/*
-	if ( debug ) {
-		char	str[MAX_STRING_CHARS];
-
-		Com_sprintf(str, sizeof(str), "print \"head: %d, %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n\"",
-			ent->client->topMarker,
-			ent->client->playerMarkers[0].time,
-			ent->client->playerMarkers[1].time,
-			ent->client->playerMarkers[2].time,
-			ent->client->playerMarkers[3].time,
-			ent->client->playerMarkers[4].time,
-			ent->client->playerMarkers[5].time,
-			ent->client->playerMarkers[6].time,
-			ent->client->playerMarkers[7].time,
-			ent->client->playerMarkers[8].time,
-			ent->client->playerMarkers[9].time,
-			ent->client->playerMarkers[10].time,
-			ent->client->playerMarkers[11].time,
-			ent->client->playerMarkers[12].time,
-			ent->client->playerMarkers[13].time,
-			ent->client->playerMarkers[14].time,
-			ent->client->playerMarkers[15].time,
-			ent->client->playerMarkers[16].time);
-
-		trap_SendServerCommand( debugger - g_entities, str );
+	num = ent->s.number;
+	if ( !( shiftValid[num >> 5] & ( 1 << ( num & 31 ) ) ) ) {
+		return;
 	}
-*/
 
-	// find two entries in the history whose times sandwich "time"
-	// assumes no two adjacent records have the same timestamp
-	j = k = ent->player->topMarker;
-	do {
-		if ( ent->player->playerMarkers[j].time <= time )
-			break;
+	origin[0] = shiftOrigin[0][num]; origin[1] = shiftOrigin[1][num]; origin[2] = shiftOrigin[2][num];
+	mins[0] = shiftMins[0][num]; mins[1] = shiftMins[1][num]; mins[2] = shiftMins[2][num];
+	maxs[0] = shiftMaxs[0][num]; maxs[1] = shiftMaxs[1][num]; maxs[2] = shiftMaxs[2][num];
 
-		k = j;
-		j--;
-		if ( j < 0 ) {
-			j = MAX_PLAYER_MARKERS - 1;
-		}
+	// players that haven't moved don't need to be relinked
+	if ( VectorCompare( origin, ent->r.currentOrigin ) && VectorCompare( mins, ent->s.mins )
+		&& VectorCompare( maxs, ent->s.maxs ) ) {
+		return;
 	}
-	while ( j != ent->player->topMarker );
-
-	// if we got past the first iteration above, we've sandwiched (or wrapped)
-	if ( j != k ) {
-		// make sure it doesn't get re-saved
-		if ( ent->player->backupMarker.time != level.time ) {
-			// save the current origin and bounding box
-			VectorCopy( ent->s.mins, ent->player->backupMarker.mins );
-			VectorCopy( ent->s.maxs, ent->player->backupMarker.maxs );
-			VectorCopy( ent->r.currentOrigin, ent->player->backupMarker.origin );
-			ent->player->backupMarker.time = level.time;
-		}
 
-		// if we haven't wrapped back to the head, we've sandwiched, so
-		// we shift the client's position back to where he was at "time"
-		if ( j != ent->player->topMarker ) {
-			float	frac = (float)(time - ent->player->playerMarkers[j].time) /
-				(float)(ent->player->playerMarkers[k].time - ent->player->playerMarkers[j].time);
-
-			// interpolate between the two origins to give position at time index "time"
-			TimeShiftLerp( frac,
-				ent->player->playerMarkers[j].origin, ent->player->playerMarkers[k].origin,
-				ent->r.currentOrigin );
-
-			// lerp these too, just for fun (and ducking)
-			TimeShiftLerp( frac,
-				ent->player->playerMarkers[j].mins, ent->player->playerMarkers[k].mins,
-				ent->s.mins );
-
-			TimeShiftLerp( frac,
-				ent->player->playerMarkers[j].maxs, ent->player->playerMarkers[k].maxs,
-				ent->s.maxs );
-
-			if ( debug && debugger != NULL ) {
-				// print some debugging stuff exactly like what the client does
-
-				// it starts with "Rec:" to let you know it backward-reconciled
-				Com_sprintf( msg, sizeof(msg),
-					"print \"^1Rec: time: %d, j: %d, k: %d, origin: %0.2f %0.2f %0.2f\n"
-					"^2frac: %0.4f, origin1: %0.2f %0.2f %0.2f, origin2: %0.2f %0.2f %0.2f\n"
-					"^7level.time: %d, est time: %d, level.time delta: %d, est real ping: %d\n\"",
-					time, ent->player->playerMarkers[j].time, ent->player->playerMarkers[k].time,
-					ent->r.currentOrigin[0], ent->r.currentOrigin[1], ent->r.currentOrigin[2],
-					frac,
-					ent->player->playerMarkers[j].origin[0],
-					ent->player->playerMarkers[j].origin[1],
-					ent->player->playerMarkers[j].origin[2], 
-					ent->player->playerMarkers[k].origin[0],
-					ent->player->playerMarkers[k].origin[1],
-					ent->player->playerMarkers[k].origin[2],
-					level.time, level.time + debugger->player->frameOffset,
-					level.time - time, level.time + debugger->player->frameOffset - time);
-
-				trap_SendServerCommand( debugger - g_entities, msg );
-			}
+	// make sure it doesn't get re-saved
+	if ( ent->player->backupMarker.time != level.time ) {
+		// save the current origin and bounding box
+		VectorCopy( ent->s.mins, ent->player->backupMarker.mins );
+		VectorCopy( ent->s.maxs, ent->player->backupMarker.maxs );
+		VectorCopy( ent->r.currentOrigin, ent->player->backupMarker.origin );
+		ent->player->backupMarker.time = level.time;
+	}
 
-			// this will recalculate absmin and absmax
-			trap_LinkEntity( ent );
-		} else {
-			// we wrapped, so grab the earliest
-			VectorCopy( ent->player->playerMarkers[k].origin, ent->r.currentOrigin );
-			VectorCopy( ent->player->playerMarkers[k].mins, ent->s.mins );
-			VectorCopy( ent->player->playerMarkers[k].maxs, ent->s.maxs );
+	if ( debug && debugger != NULL ) {
+		// print some debugging stuff exactly like what the client does
 
-			// this will recalculate absmin and absmax
-			trap_LinkEntity( ent );
-		}
+		// it starts with "Rec:" to let you know it backward-reconciled
+		Com_sprintf( msg, sizeof(msg),
+			"print \"^1Rec: time: %d, origin: %0.2f %0.2f %0.2f -> %0.2f %0.2f %0.2f\n"
+			"^7level.time: %d, est time: %d, level.time delta: %d, est real ping: %d\n\"",
+			time,
+			ent->r.currentOrigin[0], ent->r.currentOrigin[1], ent->r.currentOrigin[2],
+			origin[0], origin[1], origin[2],
+			level.time, level.time + debugger->player->frameOffset,
+			level.time - time, level.time + debugger->player->frameOffset - time);
+
+		trap_SendServerCommand( debugger - g_entities, msg );
 	}
-	else {
-		// this only happens when the client is using a negative timenudge, because that
-		// number is added to the command time
 
-		// print some debugging stuff exactly like what the client does
+	VectorCopy( origin, ent->r.currentOrigin );
+	VectorCopy( mins, ent->s.mins );
+	VectorCopy( maxs, ent->s.maxs );
 
-		// it starts with "No rec:" to let you know it didn't backward-reconcile
-		if ( debug && debugger != NULL ) {
-			Com_sprintf( msg, sizeof(msg),
-				"print \"^1No rec: time: %d, j: %d, k: %d, origin: %0.2f %0.2f %0.2f\n"
-				"^2frac: %0.4f, origin1: %0.2f %0.2f %0.2f, origin2: %0.2f %0.2f %0.2f\n"
-				"^7level.time: %d, est time: %d, level.time delta: %d, est real ping: %d\n\"",
-				time, level.time, level.time,
-				ent->r.currentOrigin[0], ent->r.currentOrigin[1], ent->r.currentOrigin[2],
-				0.0f,
-				ent->r.currentOrigin[0], ent->r.currentOrigin[1], ent->r.currentOrigin[2], 
-				ent->r.currentOrigin[0], ent->r.currentOrigin[1], ent->r.currentOrigin[2],
-				level.time, level.time + debugger->player->frameOffset,
-				level.time - time, level.time + debugger->player->frameOffset - time);
-
-			trap_SendServerCommand( debugger - g_entities, msg );
-		}
+	// this will recalculate absmin and absmax
+	G_LinkEntity( ent );
+}
+
+
+/*
+=================
+G_BoxNearRay
+
+Conservative test whether a box could be hit by a ray from "start" along
+"dir", or by anything within a cone around it that widens by "slope" units
+per unit of distance
+=================
+*/
+static qboolean G_BoxNearRay( const vec3_t absmin, const vec3_t absmax, const vec3_t start, const vec3_t dir, float length, float slope ) {
+	vec3_t	center, extents, delta, closest;
+	float	radius, t;
+
+	VectorAdd( absmin, absmax, center );
+	VectorScale( center, 0.5f, center );
+	VectorSubtract( absmax, center, extents );
+	radius = VectorLength( extents );
+
+	VectorSubtract( center, start, delta );
+	t = DotProduct( delta, dir );
+	if ( t < 0 ) {
+		t = 0;
+	} else if ( t > length ) {
+		t = length;
 	}
+	VectorMA( start, t, dir, closest );
+
+	return Distance( center, closest ) <= radius + slope * t;
 }
 
 
 /*
 =====================
-G_TimeShiftAllClients
+G_TimeShiftPlayers
 
-Move ALL clients back to where they were at the specified "time",
-except for "skip"
+Move the clients back to where they were at the specified "time", except
+for "skip". With a ray only the clients whose current or shifted box is
+near it are moved, the others can't be hit by the shot anyway.
 =====================
 */
-void G_TimeShiftAllClients( int time, gentity_t *skip ) {
-	int			i;
+static void G_TimeShiftPlayers( int time, gentity_t *skip, const vec3_t start, const vec3_t end, float spread ) {
+	int			i, j;
+	int			older, newer;
+	float		frac, length, slope;
+	vec3_t		dir, absmin, absmax;
 	gentity_t	*ent;
 #if 0 // TODO
 	qboolean debug = ( skip != NULL && skip->player && 
@@ -265,50 +328,131 @@ void G_TimeShiftAllClients( int time, gentity_t *skip ) {
 	qboolean	debug = qfalse;
 #endif
 
+	if ( G_FindHistoryFrames( time, &older, &newer, &frac ) == HISTORY_CURRENT ) {
+		return;
+	}
+
+	G_LerpHistory( &historyFrames[older], &historyFrames[newer], frac );
+
+	length = slope = 0;
+	if ( start ) {
+		VectorSubtract( end, start, dir );
+		length = VectorNormalize( dir );
+		if ( length > 0 ) {
+			slope = spread / length;
+		}
+	}
+
 	// for every client
 	ent = &g_entities[0];
 	for ( i = 0; i < MAX_CLIENTS; i++, ent++ ) {
-		if ( ent->player && ent->inuse && ent->player->sess.sessionTeam < TEAM_SPECTATOR && ent != skip ) {
-			G_TimeShiftClient( ent, time, debug, skip );
+		if ( !ent->player || !ent->inuse || ent->player->sess.sessionTeam >= TEAM_SPECTATOR || ent == skip ) {
+			continue;
 		}
+
+		if ( start && ( shiftValid[i >> 5] & ( 1 << ( i & 31 ) ) ) ) {
+			// the box swept between now and the shifted time
+			for ( j = 0; j < 3; j++ ) {
+				absmin[j] = MIN( ent->r.absmin[j], shiftOrigin[j][i] + shiftMins[j][i] );
+				absmax[j] = MAX( ent->r.absmax[j], shiftOrigin[j][i] + shiftMaxs[j][i] );
+			}
+			if ( !G_BoxNearRay( absmin, absmax, start, dir, length, slope ) ) {
+				continue;
+			}
+		}
+
+		G_TimeShiftClient( ent, time, debug, skip );
 	}
 }
 
 
+/*
+=====================
+G_TimeShiftAllClients
+
+Move ALL clients back to where they were at the specified "time",
+except for "skip"
+=====================
+*/
+void G_TimeShiftAllClients( int time, gentity_t *skip ) {
+	G_TimeShiftPlayers( time, skip, NULL, NULL, 0 );
+}
+
+
 /*
 ================
-G_DoTimeShiftFor
+G_TimeShiftTime
 
-Decide what time to shift everyone back to, and do it
+Decide what time to shift everyone back to for this client
 ================
 */
-void G_DoTimeShiftFor( gentity_t *ent ) {	
-	int time;
-
+static qboolean G_TimeShiftTime( gentity_t *ent, int *time ) {
 	// don't time shift for mistakes or bots
 	if ( !ent->inuse || !ent->player || (ent->r.svFlags & SVF_BOT) ) {
-		return;
+		return qfalse;
 	}
 
 	switch ( ent->player->pers.antiLag ) {
 		case 1:
 			// do just 50ms
-			time = level.previousTime + ent->player->frameOffset;
-			break;
+			*time = level.previousTime + ent->player->frameOffset;
+			return qtrue;
 
 		case 2:
 			// do the full lag compensation, except what the client nudges
-			time = ent->player->lastCmdServerTime;// TODO + ent->player->pers.cmdTimeNudge;
-			break;
+			*time = ent->player->lastCmdServerTime;// TODO + ent->player->pers.cmdTimeNudge;
+			return qtrue;
 
 		default:
-			return;
+			return qfalse;
+	}
+}
+
+
+/*
+================
+G_DoTimeShiftFor
+
+Decide what time to shift everyone back to, and do it
+================
+*/
+void G_DoTimeShiftFor( gentity_t *ent ) {
+	int time;
+
+	if ( !G_TimeShiftTime( ent, &time ) ) {
+		return;
 	}
 
 	G_TimeShiftAllClients( time, ent );
 }
 
 
+/*
+================
+G_DoTimeShiftForRay
+
+Like G_DoTimeShiftFor, but with g_unlaggedRayFilter only the clients near
+the shot are moved. "spread" is how far the shot may stray from the ray at
+"end", for the shotgun cone. Calling it again before G_UndoTimeShiftFor
+adds the clients near another ray, for shots that bounce.
+================
+*/
+void G_DoTimeShiftForRay( gentity_t *ent, const vec3_t start, const vec3_t end, float spread ) {
+	int time;
+
+	if ( !G_TimeShiftTime( ent, &time ) ) {
+		return;
+	}
+
+	if ( !g_unlaggedRayFilter.integer ) {
+		G_TimeShiftAllClients( time, ent );
+		return;
+	}
+
+	G_TimeShiftPlayers( time, ent, start, end, spread );
+}
+
+
 /*
 ===================
 G_UnTimeShiftClient
@@ -326,7 +470,7 @@ void G_UnTimeShiftClient( gentity_t *ent ) {
 		ent->player->backupMarker.time = 0;
 
 		// this will recalculate absmin and absmax
-		trap_LinkEntity( ent );
+		G_LinkEntity( ent );
 	}
 }
 
@@ -441,7 +585,7 @@ qboolean G_PredictPlayerSlideMove( gentity_t *ent, float frametime ) {
 		VectorMA( origin, time_left, velocity, end );
 
 		// see if we can make it there
-		trap_Trace( &trace, origin, ent->s.mins, ent->s.maxs, end, ent->s.number, ent->clipmask );
+		G_Trace( TRACE_UNLAGGED, &trace, origin, ent->s.mins, ent->s.maxs, end, ent->s.number, ent->clipmask );
 
 		if (trace.allsolid) {
 			// entity is completely trapped in another solid
@@ -596,7 +740,7 @@ void G_PredictPlayerStepSlideMove( gentity_t *ent, float frametime ) {
 	up[2] += STEPSIZE;
 
 	// test the player position if they were a stepheight higher
-	trap_Trace( &trace, start_o, ent->s.mins, ent->s.maxs, up, ent->s.number, ent->clipmask );
+	G_Trace( TRACE_UNLAGGED, &trace, start_o, ent->s.mins, ent->s.maxs, up, ent->s.number, ent->clipmask );
 	if ( trace.allsolid ) {
 		return;		// can't step up
 	}
@@ -612,7 +756,7 @@ void G_PredictPlayerStepSlideMove( gentity_t *ent, float frametime ) {
 	// push down the final amount
 	VectorCopy( ent->s.pos.trBase, down );
 	down[2] -= stepSize;
-	trap_Trace( &trace, ent->s.pos.trBase, ent->s.mins, ent->s.maxs, down, ent->s.number, ent->clipmask );
+	G_Trace( TRACE_UNLAGGED, &trace, ent->s.pos.trBase, ent->s.mins, ent->s.maxs, down, ent->s.number, ent->clipmask );
 	if ( !trace.allsolid ) {
 		VectorCopy( trace.endpos, ent->s.pos.trBase );
 	}
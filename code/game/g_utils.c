@@ -83,6 +83,133 @@ model / sound configstring indexes
 =========================================================================
 */
 
+/*
+Every configstring range G_FindConfigstringIndex is used with is read from
+the server once and then mirrored in a hash table, so looking up an index
+doesn't need any trap calls. G_FindConfigstringIndex is the only place the
+game sets these configstrings, which keeps the mirror in sync.
+*/
+
+#define MAX_CONFIGSTRING_RANGES		8
+#define CONFIGSTRING_HASH_SIZE		1024
+#define CONFIGSTRING_POOL_SIZE		0x10000
+
+typedef struct {
+	int			start, max;
+	int			count;			// first unused index
+	qboolean	overflowed;		// out of pool space, searched linearly
+} configstringRange_t;
+
+static configstringRange_t	configstringRanges[MAX_CONFIGSTRING_RANGES];
+static int					numConfigstringRanges;
+
+static int					configstringHash[CONFIGSTRING_HASH_SIZE];	// -1 ends the chain
+static int					configstringHashNext[MAX_CONFIGSTRINGS];
+static char					*configstringNames[MAX_CONFIGSTRINGS];
+
+static char					configstringPool[CONFIGSTRING_POOL_SIZE];
+static int					configstringPoolUsed;
+
+/*
+================
+G_InitConfigstringIndexes
+================
+*/
+void G_InitConfigstringIndexes( void ) {
+	int		i;
+
+	numConfigstringRanges = 0;
+	configstringPoolUsed = 0;
+	for ( i = 0; i < CONFIGSTRING_HASH_SIZE; i++ ) {
+		configstringHash[i] = -1;
+	}
+}
+
+/*
+================
+G_ConfigstringHash
+================
+*/
+static int G_ConfigstringHash( const char *name, int start ) {
+	unsigned	hash;
+
+	hash = 2166136261u;
+	for ( ; *name; name++ ) {
+		hash = ( hash ^ *name ) * 16777619u;
+	}
+	hash ^= start * 2654435761u;
+	return ( hash ^ ( hash >> 16 ) ) & ( CONFIGSTRING_HASH_SIZE - 1 );
+}
+
+/*
+================
+G_AddConfigstringName
+
+Returns qfalse if the pool is full
+================
+*/
+static qboolean G_AddConfigstringName( configstringRange_t *range, int index, const char *name ) {
+	int		num, l, h;
+
+	l = strlen( name ) + 1;
+	if ( configstringPoolUsed + l > CONFIGSTRING_POOL_SIZE ) {
+		range->overflowed = qtrue;
+		return qfalse;
+	}
+
+	num = range->start + index;
+	configstringNames[num] = configstringPool + configstringPoolUsed;
+	memcpy( configstringNames[num], name, l );
+	configstringPoolUsed += l;
+
+	h = G_ConfigstringHash( name, range->start );
+	configstringHashNext[num] = configstringHash[h];
+	configstringHash[h] = num;
+	return qtrue;
+}
+
+/*
+================
+G_ConfigstringRange
+
+Finds or loads the mirror of a range, NULL if there are too many ranges
+================
+*/
+static configstringRange_t *G_ConfigstringRange( int start, int max ) {
+	configstringRange_t	*range;
+	char				s[MAX_STRING_CHARS];
+	int					i;
+
+	for ( i = 0; i < numConfigstringRanges; i++ ) {
+		if ( configstringRanges[i].start == start ) {
+			return &configstringRanges[i];
+		}
+	}
+
+	if ( numConfigstringRanges == MAX_CONFIGSTRING_RANGES || start + max > MAX_CONFIGSTRINGS ) {
+		return NULL;
+	}
+
+	range = &configstringRanges[numConfigstringRanges++];
+	range->start = start;
+	range->max = max;
+	range->overflowed = qfalse;
+
+	// pick up what is already set, after a map_restart for example
+	for ( i = 1; i < max; i++ ) {
+		trap_GetConfigstring( start + i, s, sizeof( s ) );
+		if ( !s[0] ) {
+			break;
+		}
+		if ( !G_AddConfigstringName( range, i, s ) ) {
+			break;
+		}
+	}
+	range->count = i;
+
+	return range;
+}
+
 /*
 ================
 G_FindConfigstringIndex
@@ -90,13 +217,38 @@ G_FindConfigstringIndex
 ================
 */
 int G_FindConfigstringIndex( char *name, int start, int max, qboolean create ) {
-	int		i;
+	configstringRange_t	*range;
+	int		i, num;
 	char	s[MAX_STRING_CHARS];
 
 	if ( !name || !name[0] ) {
 		return 0;
 	}
 
+	range = G_ConfigstringRange( start, max );
+	if ( range && !range->overflowed ) {
+		for ( num = configstringHash[G_ConfigstringHash( name, start )]; num != -1; num = configstringHashNext[num] ) {
+			if ( num > start && num < start + range->count && !strcmp( configstringNames[num], name ) ) {
+				return num - start;
+			}
+		}
+
+		if ( !create ) {
+			return 0;
+		}
+
+		i = range->count;
+		if ( i >= max ) {
+			G_Error( "G_FindConfigstringIndex: overflow" );
+		}
+
+		trap_SetConfigstring( start + i, name );
+		range->count++;
+		G_AddConfigstringName( range, i, name );
+
+		return i;
+	}
+
 	for ( i=1 ; i<max ; i++ ) {
 		trap_GetConfigstring( start + i, s, sizeof( s ) );
 		if ( !s[0] ) {
@@ -186,6 +338,247 @@ void G_TeamCommand( team_t team, char *cmd ) {
 }
 
 
+/*
+=============================================================================
+
+ENTITY NAME INDEX
+
+Entities are hashed by classname and targetname so G_Find doesn't have to
+compare the strings of every entity. The names are usually set after
+G_Spawn returns, so the entities allocated this frame are checked again
+before every lookup and all entities are checked once per frame.
+
+=============================================================================
+*/
+
+#define ENTITY_NAME_HASH_SIZE	512
+
+enum {
+	ENTITY_NAME_CLASSNAME,
+	ENTITY_NAME_TARGETNAME,
+
+	ENTITY_NAME_FIELDS
+};
+
+typedef struct {
+	const char	*name;			// field value the entity is hashed by
+	int			bucket;			// -1 if not hashed
+	int			prev, next;		// entity numbers in the bucket, -1 ends the list
+} entityNameLink_t;
+
+static int				entityNameHash[ENTITY_NAME_FIELDS][ENTITY_NAME_HASH_SIZE];
+static entityNameLink_t	entityNameLinks[ENTITY_NAME_FIELDS][MAX_GENTITIES];
+
+// entities allocated this frame
+static int				newEntities[MAX_GENTITIES];
+static int				numNewEntities;
+static qboolean			entityIsNew[MAX_GENTITIES];
+
+/*
+=============
+G_EntityNameField
+=============
+*/
+static int G_EntityNameField( int fieldofs ) {
+	if ( fieldofs == FOFS(classname) ) {
+		return ENTITY_NAME_CLASSNAME;
+	}
+	if ( fieldofs == FOFS(targetname) ) {
+		return ENTITY_NAME_TARGETNAME;
+	}
+	return -1;
+}
+
+/*
+=============
+G_EntityNameHash
+=============
+*/
+static int G_EntityNameHash( const char *name ) {
+	int		hash, c;
+
+	hash = 0;
+	while ( *name ) {
+		c = *name++;
+		// same case folding as Q_stricmp
+		if ( c >= 'A' && c <= 'Z' ) {
+			c += 'a' - 'A';
+		}
+		hash = hash * 31 + c;
+	}
+	return hash & ( ENTITY_NAME_HASH_SIZE - 1 );
+}
+
+/*
+=============
+G_HashEntityName
+
+Keeps each bucket sorted by entity number, so G_Find returns
+the entities in the same order as a linear search
+=============
+*/
+static void G_HashEntityName( int field, gentity_t *ent ) {
+	entityNameLink_t	*links, *link;
+	const char			*name;
+	int					num, prev, next;
+
+	links = entityNameLinks[field];
+	num = ent - g_entities;
+	link = &links[num];
+
+	name = NULL;
+	if ( ent->inuse ) {
+		name = field == ENTITY_NAME_CLASSNAME ? ent->classname : ent->targetname;
+	}
+	if ( name == link->name ) {
+		return;
+	}
+
+	// remove from the old bucket
+	if ( link->bucket != -1 ) {
+		if ( link->prev != -1 ) {
+			links[link->prev].next = link->next;
+		} else {
+			entityNameHash[field][link->bucket] = link->next;
+		}
+		if ( link->next != -1 ) {
+			links[link->next].prev = link->prev;
+		}
+		link->bucket = -1;
+	}
+
+	link->name = name;
+	if ( !name ) {
+		return;
+	}
+
+	link->bucket = G_EntityNameHash( name );
+	prev = -1;
+	for ( next = entityNameHash[field][link->bucket]; next != -1 && next < num; next = links[next].next ) {
+		prev = next;
+	}
+	link->prev = prev;
+	link->next = next;
+	if ( prev != -1 ) {
+		links[prev].next = num;
+	} else {
+		entityNameHash[field][link->bucket] = num;
+	}
+	if ( next != -1 ) {
+		links[next].prev = num;
+	}
+}
+
+/*
+=============
+G_HashEntityNames
+=============
+*/
+static void G_HashEntityNames( gentity_t *ent ) {
+	int		field;
+
+	for ( field = 0; field < ENTITY_NAME_FIELDS; field++ ) {
+		G_HashEntityName( field, ent );
+	}
+}
+
+/*
+=============
+G_HashNewEntityNames
+=============
+*/
+static void G_HashNewEntityNames( void ) {
+	int		i;
+
+	for ( i = 0; i < numNewEntities; i++ ) {
+		G_HashEntityNames( &g_entities[newEntities[i]] );
+	}
+}
+
+/*
+=============
+G_InitEntityNameIndex
+=============
+*/
+void G_InitEntityNameIndex( void ) {
+	int		field, i;
+
+	for ( field = 0; field < ENTITY_NAME_FIELDS; field++ ) {
+		for ( i = 0; i < ENTITY_NAME_HASH_SIZE; i++ ) {
+			entityNameHash[field][i] = -1;
+		}
+		for ( i = 0; i < MAX_GENTITIES; i++ ) {
+			entityNameLinks[field][i].name = NULL;
+			entityNameLinks[field][i].bucket = -1;
+		}
+	}
+	numNewEntities = 0;
+	memset( entityIsNew, 0, sizeof( entityIsNew ) );
+}
+
+/*
+=============
+G_UpdateEntityNameIndex
+
+Picks up names that were changed outside of G_Spawn / G_FreeEntity
+=============
+*/
+void G_UpdateEntityNameIndex( void ) {
+	int		i;
+
+	for ( i = 0; i < level.num_entities; i++ ) {
+		G_HashEntityNames( &g_entities[i] );
+	}
+
+	for ( i = 0; i < numNewEntities; i++ ) {
+		entityIsNew[newEntities[i]] = qfalse;
+	}
+	numNewEntities = 0;
+}
+
+/*
+=============
+G_FindHashed
+=============
+*/
+static gentity_t *G_FindHashed( gentity_t *from, int field, const char *match ) {
+	entityNameLink_t	*links;
+	gentity_t			*ent;
+	const char			*s;
+	int					bucket, num;
+
+	G_HashNewEntityNames();
+
+	links = entityNameLinks[field];
+	bucket = G_EntityNameHash( match );
+
+	if ( !from ) {
+		num = entityNameHash[field][bucket];
+	} else if ( links[from - g_entities].bucket == bucket ) {
+		num = links[from - g_entities].next;
+	} else {
+		// from was freed or renamed, continue after its entity number
+		for ( num = entityNameHash[field][bucket]; num != -1 && num <= from - g_entities; num = links[num].next ) {
+		}
+	}
+
+	for ( ; num != -1; num = links[num].next ) {
+		ent = &g_entities[num];
+		if ( !ent->inuse ) {
+			continue;
+		}
+		s = field == ENTITY_NAME_CLASSNAME ? ent->classname : ent->targetname;
+		if ( !s ) {
+			continue;
+		}
+		if ( !Q_stricmp( s, match ) ) {
+			return ent;
+		}
+	}
+
+	return NULL;
+}
+
 /*
 =============
 G_Find
@@ -196,11 +589,18 @@ the matching string at fieldofs (use the FOFS() macro) in the structure.
 Searches beginning at the entity after from, or the beginning if NULL
 NULL will be returned if the end of the list is reached.
 
+classname and targetname are looked up in the entity name index.
 =============
 */
 gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match)
 {
 	char	*s;
+	int		field;
+
+	field = G_EntityNameField( fieldofs );
+	if ( field != -1 ) {
+		return G_FindHashed( from, field, match );
+	}
 
 	if (!from)
 		from = g_entities;
@@ -298,6 +698,7 @@ void G_UseTargets( gentity_t *ent, gentity_t *activator ) {
 		} else {
 			if ( t->use ) {
 				t->use (t, ent, activator);
+				G_WakeEntity( t );
 			}
 		}
 		if ( !ent->inuse ) {
@@ -383,7 +784,7 @@ void G_SetBrushModel( gentity_t *ent, const char *name ) {
 
 	ent->s.contents = -1;		// we don't know exactly what is in the brushes
 
-	trap_LinkEntity( ent );		// FIXME: remove
+	G_LinkEntity( ent );		// FIXME: remove
 }
 
 
@@ -441,6 +842,93 @@ void G_InitGentity( gentity_t *e ) {
 	e->classname = "noclass";
 	e->s.number = e - g_entities;
 	e->r.ownerNum = ENTITYNUM_NONE;
+
+	G_WakeEntity( e );
+
+	// the names are checked by G_Find until the end of the frame
+	if ( !entityIsNew[e->s.number] ) {
+		entityIsNew[e->s.number] = qtrue;
+		newEntities[numNewEntities++] = e->s.number;
+	}
+	G_HashEntityNames( e );
+}
+
+/*
+=================
+Entity free queue
+
+Freed slots are queued in the order they were freed, so the oldest
+slot is always at the head and is the only one that has to be checked
+against the reuse delay.
+=================
+*/
+static int			freeEntities[MAX_GENTITIES];
+static int			freeEntitiesHead;
+static int			numFreeEntities;
+static qboolean		entityIsQueued[MAX_GENTITIES];
+
+/*
+=================
+G_InitEntityFreeQueue
+=================
+*/
+void G_InitEntityFreeQueue( void ) {
+	freeEntitiesHead = 0;
+	numFreeEntities = 0;
+	memset( entityIsQueued, 0, sizeof( entityIsQueued ) );
+}
+
+/*
+=================
+G_QueueFreeEntity
+=================
+*/
+static void G_QueueFreeEntity( int num ) {
+	// player slots are never handed out by G_Spawn
+	if ( num < MAX_CLIENTS || num >= ENTITYNUM_MAX_NORMAL ) {
+		return;
+	}
+	// freeing an entity twice keeps its place in the queue
+	if ( entityIsQueued[num] ) {
+		return;
+	}
+	entityIsQueued[num] = qtrue;
+	freeEntities[( freeEntitiesHead + numFreeEntities ) % MAX_GENTITIES] = num;
+	numFreeEntities++;
+}
+
+/*
+=================
+G_DequeueFreeEntity
+
+Returns the oldest free slot, or NULL if there is none or,
+unless forced, it was freed too recently
+=================
+*/
+static gentity_t *G_DequeueFreeEntity( qboolean force ) {
+	gentity_t	*e;
+
+	while ( numFreeEntities > 0 ) {
+		e = &g_entities[freeEntities[freeEntitiesHead]];
+
+		// skip slots that were taken without G_Spawn
+		if ( !e->inuse ) {
+			// the first couple seconds of server time can involve a lot of
+			// freeing and allocating, so relax the replacement policy
+			if ( !force && e->freetime > level.startTime + 2000 && level.time - e->freetime < 1000 ) {
+				return NULL;
+			}
+		}
+
+		entityIsQueued[e - g_entities] = qfalse;
+		freeEntitiesHead = ( freeEntitiesHead + 1 ) % MAX_GENTITIES;
+		numFreeEntities--;
+
+		if ( !e->inuse ) {
+			return e;
+		}
+	}
+	return NULL;
 }
 
 /*
@@ -459,33 +947,21 @@ angles and bad trails.
 =================
 */
 gentity_t *G_Spawn( void ) {
-	int			i, force;
+	int			i;
 	gentity_t	*e;
 
-	e = NULL;	// shut up warning
-	for ( force = 0 ; force < 2 ; force++ ) {
-		// if we go through all entities and can't find one to free,
-		// override the normal minimum times before use
-		e = &g_entities[MAX_CLIENTS];
-		for ( i = MAX_CLIENTS ; i<level.num_entities ; i++, e++) {
-			if ( e->inuse ) {
-				continue;
-			}
-
-			// the first couple seconds of server time can involve a lot of
-			// freeing and allocating, so relax the replacement policy
-			if ( !force && e->freetime > level.startTime + 2000 && level.time - e->freetime < 1000 ) {
-				continue;
-			}
-
-			// reuse this slot
-			G_InitGentity( e );
-			return e;
-		}
-		if ( level.num_entities < ENTITYNUM_MAX_NORMAL ) {
-			break;
-		}
+	e = G_DequeueFreeEntity( qfalse );
+	if ( !e && level.num_entities == ENTITYNUM_MAX_NORMAL ) {
+		// can't open a new slot, override the normal minimum
+		// times before use
+		e = G_DequeueFreeEntity( qtrue );
 	}
+	if ( e ) {
+		// reuse this slot
+		G_InitGentity( e );
+		return e;
+	}
+
 	if ( level.num_entities == ENTITYNUM_MAX_NORMAL ) {
 		for (i = 0; i < MAX_GENTITIES; i++) {
 			G_Printf("%4i: %s\n", i, g_entities[i].classname);
@@ -494,6 +970,7 @@ gentity_t *G_Spawn( void ) {
 	}
 	
 	// open up a new slot
+	e = &g_entities[level.num_entities];
 	level.num_entities++;
 
 	// let the server system know that there are more entities
@@ -511,16 +988,14 @@ G_EntitiesFree
 */
 qboolean G_EntitiesFree( void ) {
 	int			i;
-	gentity_t	*e;
 
 	if ( level.num_entities < ENTITYNUM_MAX_NORMAL ) {
 		// can open a new slot if needed
 		return qtrue;
 	}
 
-	e = &g_entities[MAX_CLIENTS];
-	for ( i = MAX_CLIENTS; i < level.num_entities; i++, e++) {
-		if ( e->inuse ) {
+	for ( i = 0; i < numFreeEntities; i++ ) {
+		if ( g_entities[freeEntities[( freeEntitiesHead + i ) % MAX_GENTITIES]].inuse ) {
 			continue;
 		}
 		// slot available
@@ -538,7 +1013,7 @@ Marks the entity as free
 =================
 */
 void G_FreeEntity( gentity_t *ed ) {
-	trap_UnlinkEntity (ed);		// unlink from world
+	G_UnlinkEntity (ed);		// unlink from world
 
 	if ( ed->neverFree ) {
 		return;
@@ -548,6 +1023,11 @@ void G_FreeEntity( gentity_t *ed ) {
 	ed->classname = "freed";
 	ed->freetime = level.time;
 	ed->inuse = qfalse;
+
+	G_QueueFreeEntity( ed - g_entities );
+	G_WakeEntity( ed );
+
+	G_HashEntityNames( ed );
 }
 
 /*
@@ -575,7 +1055,7 @@ gentity_t *G_TempEntity( vec3_t origin, int event ) {
 	G_SetOrigin( e, snapped );
 
 	// find cluster for PVS
-	trap_LinkEntity( e );
+	G_LinkEntity( e );
 
 	return e;
 }
@@ -667,6 +1147,7 @@ void G_AddEvent( gentity_t *ent, int event, int eventParm ) {
 		ent->s.eventParm = eventParm;
 	}
 	ent->eventTime = level.time;
+	G_WakeEntity( ent );
 }
 
 
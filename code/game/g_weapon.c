@@ -88,7 +88,7 @@ qboolean CheckGauntletAttack( gentity_t *ent ) {
 
 	VectorMA (muzzle, 32, forward, end);
 
-	trap_Trace (&tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT);
+	G_Trace (TRACE_GAUNTLET, &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT);
 	if ( tr.surfaceFlags & SURF_NOIMPACT ) {
 		return qfalse;
 	}
@@ -177,9 +177,9 @@ void Bullet_Fire (gentity_t *ent, float spread, int damage, int mod ) {
 	for (i = 0; i < 10; i++) {
 
 		// backward-reconcile the other clients
-		G_DoTimeShiftFor( ent );
+		G_DoTimeShiftForRay( ent, muzzle, end, 0 );
 
-		trap_Trace (&tr, muzzle, NULL, NULL, end, passent, MASK_SHOT);
+		G_Trace (TRACE_BULLET_FIRE, &tr, muzzle, NULL, NULL, end, passent, MASK_SHOT);
 
 		// put them back
 		G_UndoTimeShiftFor( ent );
@@ -279,7 +279,7 @@ qboolean ShotgunPellet( vec3_t start, vec3_t end, gentity_t *ent ) {
 	VectorCopy( start, tr_start );
 	VectorCopy( end, tr_end );
 	for (i = 0; i < 10; i++) {
-		trap_Trace (&tr, tr_start, NULL, NULL, tr_end, passent, MASK_SHOT);
+		G_Trace (TRACE_SHOTGUN, &tr, tr_start, NULL, NULL, tr_end, passent, MASK_SHOT);
 		traceEnt = &g_entities[ tr.entityNum ];
 
 		// send bullet impact
@@ -294,6 +294,8 @@ qboolean ShotgunPellet( vec3_t start, vec3_t end, gentity_t *ent ) {
 				if (G_InvulnerabilityEffect( traceEnt, forward, tr.endpos, impactpoint, bouncedir )) {
 					G_BounceProjectile( tr_start, impactpoint, bouncedir, tr_end );
 					VectorCopy( impactpoint, tr_start );
+					// the bounced pellet leaves the spread pattern
+					G_DoTimeShiftForRay( ent, tr_start, tr_end, 0 );
 					// the player can hit him/herself with the bounced rail
 					passent = ENTITYNUM_NONE;
 				}
@@ -329,8 +331,9 @@ void ShotgunPattern( vec3_t origin, vec3_t origin2, int seed, gentity_t *ent ) {
 	PerpendicularVector( right, forward );
 	CrossProduct( forward, right, up );
 
-	// backward-reconcile the other clients
-	G_DoTimeShiftFor( ent );
+	// backward-reconcile the other clients near the spread pattern
+	VectorMA( origin, 8192 * 16, forward, end );
+	G_DoTimeShiftForRay( ent, origin, end, DEFAULT_SHOTGUN_SPREAD * 16 * 1.4143f );
 
 	// generate the "random" spread pattern
 	for ( i = 0 ; i < DEFAULT_SHOTGUN_COUNT ; i++ ) {
@@ -458,14 +461,14 @@ void weapon_railgun_fire (gentity_t *ent) {
 	VectorMA (muzzle, 8192, forward, end);
 
 	// backward-reconcile the other clients
-	G_DoTimeShiftFor( ent );
+	G_DoTimeShiftForRay( ent, muzzle, end, 0 );
 
 	// trace only against the solids, so the railgun will go through people
 	unlinked = 0;
 	hits = 0;
 	passent = ent->s.number;
 	do {
-		trap_Trace (&trace, muzzle, NULL, NULL, end, passent, MASK_SHOT );
+		G_Trace (TRACE_RAILGUN, &trace, muzzle, NULL, NULL, end, passent, MASK_SHOT );
 		if ( trace.entityNum >= ENTITYNUM_MAX_NORMAL ) {
 			break;
 		}
@@ -488,6 +491,8 @@ void weapon_railgun_fire (gentity_t *ent) {
 					tent->s.eventParm = 255;	// don't make the explosion at the end
 					//
 					VectorCopy( impactpoint, muzzle );
+					// the bounced rail leaves the reconciled ray
+					G_DoTimeShiftForRay( ent, muzzle, end, 0 );
 					// the player can hit him/herself with the bounced rail
 					passent = ENTITYNUM_NONE;
 				}
@@ -509,7 +514,7 @@ void weapon_railgun_fire (gentity_t *ent) {
 			break;		// we hit something solid enough to stop the beam
 		}
 		// unlink this entity, so the next trace will go past it
-		trap_UnlinkEntity( traceEnt );
+		G_UnlinkEntity( traceEnt );
 		unlinkedEntities[unlinked] = traceEnt;
 		unlinked++;
 	} while ( unlinked < MAX_RAIL_HITS );
@@ -519,7 +524,7 @@ void weapon_railgun_fire (gentity_t *ent) {
 
 	// link back in any entities we unlinked
 	for ( i = 0 ; i < unlinked ; i++ ) {
-		trap_LinkEntity( unlinkedEntities[i] );
+		G_LinkEntity( unlinkedEntities[i] );
 	}
 
 	// the final trace endpos will be the terminal point of the rail trail
@@ -638,9 +643,9 @@ void Weapon_LightningFire( gentity_t *ent ) {
 		VectorMA( muzzle, LIGHTNING_RANGE, forward, end );
 
 		// backward-reconcile the other clients
-		G_DoTimeShiftFor( ent );
+		G_DoTimeShiftForRay( ent, muzzle, end, 0 );
 
-		trap_Trace( &tr, muzzle, NULL, NULL, end, passent, MASK_SHOT );
+		G_Trace( TRACE_LIGHTNING, &tr, muzzle, NULL, NULL, end, passent, MASK_SHOT );
 
 		// put them back
 		G_UndoTimeShiftFor( ent );
@@ -1133,7 +1138,7 @@ void G_StartKamikaze( gentity_t *ent ) {
 	explosion->count = 0;
 	VectorClear(explosion->movedir);
 
-	trap_LinkEntity( explosion );
+	G_LinkEntity( explosion );
 
 	if (ent->player) {
 		//
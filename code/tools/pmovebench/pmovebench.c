@@ -0,0 +1,328 @@
+/*
+===========================================================================
+Copyright (C) 1999-2010 id Software LLC, a ZeniMax Media company.
+
+This file is part of Spearmint Source Code.
+
+Spearmint Source Code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 3 of the License,
+or (at your option) any later version.
+
+Spearmint Source Code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Spearmint Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, Spearmint Source Code is also subject to certain additional terms.
+You should have received a copy of these additional terms immediately following
+the terms and conditions of the GNU General Public License.  If not, please
+request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional
+terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+Suite 120, Rockville, Maryland 20850 USA.
+===========================================================================
+*/
+//
+// pmovebench.c -- standalone deterministic Pmove benchmark and replay
+//
+// Links the bg_ movement code against the stub world of bg_pmovebench.c,
+// so Pmove can be run, timed and checked without the engine or a map.
+// A recorded stream holds the usercmds together with a checksum of the
+// whole playerState after every move. Replaying it reports the first move
+// whose playerState differs, which catches movement changes that would
+// break prediction. Every run also reports the moves per second.
+//
+// pmovebench [moves] [seed]
+// pmovebench record <file> [moves] [seed]
+// pmovebench replay <file>
+// pmovebench check
+//
+// All of them but the first exit with 1 when something doesn't match.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+#include "../../qcommon/q_shared.h"
+#include "../../game/bg_public.h"
+
+static usercmd_t	benchCmds[MAX_BENCH_MOVES];
+static int			benchChecksums[MAX_BENCH_MOVES];
+static int			runChecksums[MAX_BENCH_MOVES];
+static int			numBenchCmds;
+
+/*
+===============================================================================
+
+ENGINE STUBS
+
+===============================================================================
+*/
+
+void QDECL Com_Error( int level, const char *fmt, ... ) {
+	va_list		argptr;
+
+	va_start( argptr, fmt );
+	vfprintf( stderr, fmt, argptr );
+	va_end( argptr );
+	fprintf( stderr, "\n" );
+	exit( 1 );
+}
+
+void QDECL Com_Printf( const char *fmt, ... ) {
+	va_list		argptr;
+
+	va_start( argptr, fmt );
+	vprintf( fmt, argptr );
+	va_end( argptr );
+}
+
+// same rounding as the engine's SSE snapping
+void trap_SnapVector( float *v ) {
+	v[0] = rintf( v[0] );
+	v[1] = rintf( v[1] );
+	v[2] = rintf( v[2] );
+}
+
+// bg_misc.c parses item and animation files, which the benchmark never does
+int trap_PC_ReadToken( int handle, pc_token_t *pc_token ) {
+	return 0;
+}
+
+void trap_PC_UnreadToken( int handle ) {
+}
+
+int trap_PC_SourceFileAndLine( int handle, char *filename, int *line ) {
+	return 0;
+}
+
+/*
+===============================================================================
+
+BENCHMARK
+
+===============================================================================
+*/
+
+/*
+================
+Bench_Report
+
+Times a run without checksums
+================
+*/
+static void Bench_Report( void ) {
+	clock_t		start;
+	int			msec;
+
+	start = clock();
+	BG_BenchRun( benchCmds, numBenchCmds, NULL );
+	msec = (int)( ( clock() - start ) * 1000 / CLOCKS_PER_SEC );
+	if ( msec <= 0 ) {
+		msec = 1;
+	}
+	printf( "%d moves in %d msec, %d moves per second\n", numBenchCmds, msec,
+				(int)( numBenchCmds * 1000.0 / msec ) );
+}
+
+/*
+================
+Bench_Compare
+
+Returns the number of moves whose checksum differs from the recorded one
+================
+*/
+static int Bench_Compare( const int *checksums, const char *what ) {
+	int		i, mismatches;
+
+	mismatches = 0;
+	for ( i = 0; i < numBenchCmds; i++ ) {
+		if ( checksums[i] == benchChecksums[i] ) {
+			continue;
+		}
+		if ( !mismatches ) {
+			printf( "First mismatch at move %d of %d\n", i, numBenchCmds );
+		}
+		mismatches++;
+	}
+
+	if ( mismatches ) {
+		printf( "%d of %d moves don't match %s\n", mismatches, numBenchCmds, what );
+	} else {
+		printf( "All %d moves match %s\n", numBenchCmds, what );
+	}
+	return mismatches;
+}
+
+/*
+================
+Bench_WriteFile
+================
+*/
+static qboolean Bench_WriteFile( const char *filename ) {
+	benchFileHeader_t	header;
+	FILE				*f;
+
+	BG_BenchRun( benchCmds, numBenchCmds, benchChecksums );
+
+	f = fopen( filename, "wb" );
+	if ( !f ) {
+		printf( "Couldn't write %s\n", filename );
+		return qfalse;
+	}
+
+	header.ident = BENCH_FILE_ID;
+	header.version = BENCH_FILE_VERSION;
+	header.numMoves = numBenchCmds;
+	header.playerStateSize = sizeof( playerState_t );
+
+	fwrite( &header, sizeof( header ), 1, f );
+	fwrite( benchCmds, sizeof( benchCmds[0] ), numBenchCmds, f );
+	fwrite( benchChecksums, sizeof( benchChecksums[0] ), numBenchCmds, f );
+	fclose( f );
+
+	printf( "Wrote %d moves to %s\n", numBenchCmds, filename );
+	return qtrue;
+}
+
+/*
+================
+Bench_ReadFile
+================
+*/
+static qboolean Bench_ReadFile( const char *filename ) {
+	benchFileHeader_t	header;
+	FILE				*f;
+	long				len;
+
+	f = fopen( filename, "rb" );
+	if ( !f ) {
+		printf( "Couldn't open %s\n", filename );
+		return qfalse;
+	}
+	fseek( f, 0, SEEK_END );
+	len = ftell( f );
+	fseek( f, 0, SEEK_SET );
+
+	if ( len < (long)sizeof( header ) || fread( &header, sizeof( header ), 1, f ) != 1
+		|| !BG_BenchCheckHeader( &header, (int)len ) ) {
+		printf( "%s isn't a pmovebench file\n", filename );
+		fclose( f );
+		return qfalse;
+	}
+	if ( header.playerStateSize != sizeof( playerState_t ) ) {
+		printf( "WARNING: %s was recorded with a different playerState_t, the checksums won't match\n", filename );
+	}
+
+	numBenchCmds = header.numMoves;
+	if ( fread( benchCmds, sizeof( benchCmds[0] ), numBenchCmds, f ) != (size_t)numBenchCmds
+		|| fread( benchChecksums, sizeof( benchChecksums[0] ), numBenchCmds, f ) != (size_t)numBenchCmds ) {
+		printf( "Couldn't read %s\n", filename );
+		fclose( f );
+		return qfalse;
+	}
+	fclose( f );
+	return qtrue;
+}
+
+/*
+================
+Bench_Moves
+================
+*/
+static int Bench_Moves( int argc, char **argv, int arg ) {
+	int		moves;
+
+	moves = arg < argc ? atoi( argv[arg] ) : DEFAULT_BENCH_MOVES;
+	if ( moves < 1 ) {
+		moves = 1;
+	} else if ( moves > MAX_BENCH_MOVES ) {
+		moves = MAX_BENCH_MOVES;
+	}
+	return moves;
+}
+
+/*
+================
+Bench_Check
+
+Runs the default stream twice, a rerun has to give the same playerStates
+================
+*/
+static int Bench_Check( void ) {
+	int		mismatches;
+
+	numBenchCmds = DEFAULT_BENCH_MOVES;
+	BG_BenchGenerateCmds( benchCmds, numBenchCmds, 0 );
+	BG_BenchRun( benchCmds, numBenchCmds, benchChecksums );
+
+	BG_BenchRun( benchCmds, numBenchCmds, runChecksums );
+	mismatches = Bench_Compare( runChecksums, "a second run" );
+
+	return mismatches ? 1 : 0;
+}
+
+/*
+================
+main
+================
+*/
+int main( int argc, char **argv ) {
+	const char	*cmd;
+
+	cmd = argc > 1 ? argv[1] : "";
+
+	BG_BenchBuildWorld();
+
+	if ( !Q_stricmp( cmd, "record" ) ) {
+		if ( argc < 3 ) {
+			printf( "usage: pmovebench record <file> [moves] [seed]\n" );
+			return 1;
+		}
+		numBenchCmds = Bench_Moves( argc, argv, 3 );
+		BG_BenchGenerateCmds( benchCmds, numBenchCmds, argc > 4 ? atoi( argv[4] ) : 0 );
+		if ( !Bench_WriteFile( argv[2] ) ) {
+			return 1;
+		}
+		Bench_Report();
+		return 0;
+	}
+
+	if ( !Q_stricmp( cmd, "replay" ) ) {
+		if ( argc < 3 ) {
+			printf( "usage: pmovebench replay <file>\n" );
+			return 1;
+		}
+		if ( !Bench_ReadFile( argv[2] ) ) {
+			return 1;
+		}
+		BG_BenchRun( benchCmds, numBenchCmds, runChecksums );
+		if ( Bench_Compare( runChecksums, argv[2] ) ) {
+			return 1;
+		}
+		Bench_Report();
+		return 0;
+	}
+
+	if ( !Q_stricmp( cmd, "check" ) ) {
+		return Bench_Check();
+	}
+
+	if ( !cmd[0] || ( cmd[0] >= '0' && cmd[0] <= '9' ) ) {
+		numBenchCmds = Bench_Moves( argc, argv, 1 );
+		BG_BenchGenerateCmds( benchCmds, numBenchCmds, argc > 2 ? atoi( argv[2] ) : 0 );
+		BG_BenchRun( benchCmds, numBenchCmds, runChecksums );
+		printf( "Checksum %08x\n", runChecksums[numBenchCmds - 1] );
+		Bench_Report();
+		return 0;
+	}
+
+	printf( "usage: pmovebench [moves] [seed] | record <file> [moves] [seed] | replay <file> | check\n" );
+	return 1;
+}